@@ -0,0 +1,116 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <type_traits>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+#include "simple_vector.h"
+
+// Размер большой страницы x86-64 и AArch64 с 4-килобайтными обычными страницами
+inline constexpr size_t kHugePageSize = size_t{2} << 20;
+
+// Аллокатор, выравнивающий каждый буфер по Alignment байтам (например, по кеш-линии,
+// чтобы векторные циклы над SimpleVector<float> могли читать выровненными загрузками).
+//
+// Буферы от HugePageThreshold байтов выравниваются и округляются до большой страницы,
+// а на Linux помечаются madvise(MADV_HUGEPAGE): прозрачные большие страницы сокращают
+// промахи TLB на многогигабайтных векторах. HugePageThreshold = SIZE_MAX это отключает.
+//
+// Сам аллокатор память не трогает: страница достаётся тому узлу NUMA, поток которого
+// первым в неё пишет. Чтобы страницы легли рядом с потоками, которые будут их
+// обрабатывать, элементы стоит создавать параллельно - ParallelAssign или ParallelResize
+template <typename T, size_t Alignment = 64, size_t HugePageThreshold = 4 * kHugePageSize>
+class AlignedAllocator {
+    static_assert(Alignment != 0 && (Alignment & (Alignment - 1)) == 0, "Alignment must be a power of two");
+    static_assert(Alignment >= alignof(T), "Alignment must not be weaker than the type's own");
+
+public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+
+    // Выравнивание при перепривязке не меняется, иначе обратная перепривязка дала бы
+    // другой аллокатор. Для типа с более строгим выравниванием сработает static_assert выше
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment, HugePageThreshold>;
+    };
+
+    static constexpr size_t kAlignment = Alignment;
+
+    AlignedAllocator() noexcept = default;
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment, HugePageThreshold>&) noexcept
+    {}
+
+    T* allocate(size_t count)
+    {
+        if(count > (std::numeric_limits<size_t>::max() - kHugePageSize) / sizeof(T))
+        {
+            throw std::bad_array_new_length();
+        }
+        const size_t bytes = BytesFor(count);
+        void* memory = ::operator new(bytes, std::align_val_t(AlignmentFor(count)));
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+        if(IsHuge(count))
+        {
+            // Подсказка: если большие страницы недоступны, память останется обычной
+            ::madvise(memory, bytes, MADV_HUGEPAGE);
+        }
+#endif
+        return static_cast<T*>(memory);
+    }
+
+    void deallocate(T* p, size_t count) noexcept
+    {
+        ::operator delete(p, BytesFor(count), std::align_val_t(AlignmentFor(count)));
+    }
+
+private:
+    static bool IsHuge(size_t count) noexcept
+    {
+        return count * sizeof(T) >= HugePageThreshold;
+    }
+
+    static size_t AlignmentFor(size_t count) noexcept
+    {
+        return IsHuge(count) ? std::max(Alignment, kHugePageSize) : Alignment;
+    }
+
+    // Буфер из больших страниц занимает их целое число
+    static size_t BytesFor(size_t count) noexcept
+    {
+        const size_t bytes = count * sizeof(T);
+        if(!IsHuge(count))
+        {
+            return bytes;
+        }
+        return (bytes + kHugePageSize - 1) / kHugePageSize * kHugePageSize;
+    }
+};
+
+// Память, выделенная одним аллокатором, освобождается другим, только если у них
+// одно выравнивание: deallocate передаёт его в operator delete
+template <typename T, size_t A, typename U, size_t B, size_t Threshold>
+bool operator==(const AlignedAllocator<T, A, Threshold>&, const AlignedAllocator<U, B, Threshold>&) noexcept
+{
+    return A == B;
+}
+
+template <typename T, size_t A, typename U, size_t B, size_t Threshold>
+bool operator!=(const AlignedAllocator<T, A, Threshold>&, const AlignedAllocator<U, B, Threshold>&) noexcept
+{
+    return A != B;
+}
+
+// SimpleVector, буфер которого выровнен по кеш-линии, а большие буферы лежат в больших страницах
+template <typename T, size_t Alignment = 64>
+using AlignedSimpleVector = SimpleVector<T, AlignedAllocator<T, Alignment>>;
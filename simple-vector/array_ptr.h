@@ -1,78 +1,159 @@
 #pragma once
 
+#include <cassert>
+#include <cstddef>
+#include <memory>
 #include <stdexcept>
 #include <algorithm>
+#include <type_traits>
 #include <utility>
+#include "constexpr_support.h"
 
-template <typename T>
+// Владеет неинициализированным буфером на size ячеек типа T, выделенным через Allocator.
+// Сам ArrayPtr элементы не создаёт и не разрушает: этим занимается владелец
+// буфера (SimpleVector), который конструирует только "живые" элементы
+template <typename T, typename Allocator = std::allocator<T>>
 class ArrayPtr
 {
+    using AllocTraits = std::allocator_traits<Allocator>;
+    static_assert(std::is_same_v<typename AllocTraits::value_type, T>, "Allocator::value_type must be T");
+    static_assert(std::is_same_v<typename AllocTraits::pointer, T*>, "Fancy pointers are not supported");
+
     public:
     ArrayPtr() = default;
 
-    ArrayPtr(const ArrayPtr&) = delete;
-    ArrayPtr& operator=(ArrayPtr&) = delete;
-    
-    explicit ArrayPtr(T* raw_ptr) noexcept
-        : ptr_(raw_ptr) {
+    SIMPLE_VECTOR_CONSTEXPR explicit ArrayPtr(const Allocator& alloc) noexcept
+        : alloc_(alloc) {
 
     }
 
-    ArrayPtr(ArrayPtr&& other)
+    ArrayPtr(const ArrayPtr&) = delete;
+    ArrayPtr& operator=(const ArrayPtr&) = delete;
+
+    // Выделяет память под size элементов, не вызывая их конструкторы
+    SIMPLE_VECTOR_CONSTEXPR explicit ArrayPtr(size_t size, const Allocator& alloc = Allocator())
+        : alloc_(alloc)
     {
-        std::swap(this->ptr_, other.ptr_);
+        if(size == 0)
+        {
+            return;
+        }
+        ptr_ = AllocTraits::allocate(alloc_, size);
+        size_ = size;
+    }
+
+    // Принимает во владение буфер на size ячеек, выделенный через alloc
+    SIMPLE_VECTOR_CONSTEXPR ArrayPtr(T* raw_ptr, size_t size, const Allocator& alloc = Allocator()) noexcept
+        : ptr_(raw_ptr)
+        , size_(size)
+        , alloc_(alloc) {
+
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR ArrayPtr(ArrayPtr&& other) noexcept
+        : ptr_(std::exchange(other.ptr_, nullptr))
+        , size_(std::exchange(other.size_, 0))
+        , alloc_(std::move(other.alloc_)) {
+
     }
 
-    ~ArrayPtr()
+    SIMPLE_VECTOR_CONSTEXPR ~ArrayPtr()
     {
-        delete[] ptr_;
+        if(ptr_ != nullptr)
+        {
+            AllocTraits::deallocate(alloc_, ptr_, size_);
+        }
     }
 
-    ArrayPtr& operator=(ArrayPtr&& rhs)
+    // Буфер rhs можно забрать, только если его сможет освободить наш аллокатор:
+    // либо аллокатор переезжает вместе с буфером, либо аллокаторы равны
+    SIMPLE_VECTOR_CONSTEXPR ArrayPtr& operator=(ArrayPtr&& rhs) noexcept
     {
-        if(this->ptr_ == rhs.ptr_)
+        if(this == &rhs)
         {
             return *this;
         }
 
-        std::swap(this->ptr_, rhs.ptr_);
+        if constexpr (AllocTraits::propagate_on_container_move_assignment::value)
+        {
+            // Старый буфер освобождается старым аллокатором
+            ArrayPtr old(std::move(*this));
+            alloc_ = std::move(rhs.alloc_);
+        }
+        else
+        {
+            assert(alloc_ == rhs.alloc_);
+        }
+        std::swap(ptr_, rhs.ptr_);
+        std::swap(size_, rhs.size_);
         return *this;
     }
 
-    T* GetRawPtr() const noexcept
+    SIMPLE_VECTOR_CONSTEXPR T* GetRawPtr() const noexcept
     {
         return ptr_;
     }
 
-    T* Release() noexcept
+    // Возвращает количество ячеек в буфере
+    SIMPLE_VECTOR_CONSTEXPR size_t GetSize() const noexcept
+    {
+        return size_;
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR Allocator& GetAllocator() noexcept
+    {
+        return alloc_;
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR const Allocator& GetAllocator() const noexcept
+    {
+        return alloc_;
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR T* Release() noexcept
     {
         T* p = ptr_;
         ptr_ = nullptr;
+        size_ = 0;
         return p;
     }
 
-    explicit operator bool() const
+    SIMPLE_VECTOR_CONSTEXPR explicit operator bool() const
     {
         return ptr_ != nullptr;
     }
 
 
 
-    void swap(ArrayPtr& rhs)
+    // Обменивает буферы. Аллокаторы обмениваются, если это разрешает
+    // propagate_on_container_swap, иначе они обязаны быть равны
+    SIMPLE_VECTOR_CONSTEXPR void swap(ArrayPtr& rhs) noexcept
     {
+        if constexpr (AllocTraits::propagate_on_container_swap::value)
+        {
+            using std::swap;
+            swap(alloc_, rhs.alloc_);
+        }
+        else
+        {
+            assert(alloc_ == rhs.alloc_);
+        }
         std::swap(ptr_, rhs.ptr_);
+        std::swap(size_, rhs.size_);
     }
 
-    T* operator->() const noexcept
+    SIMPLE_VECTOR_CONSTEXPR T* operator->() const noexcept
     {
         return ptr_;
     }
 
-    T& operator*() const noexcept
+    SIMPLE_VECTOR_CONSTEXPR T& operator*() const noexcept
     {
         return *ptr_;
     }
 
     private:
     T* ptr_ = nullptr;
-};
\ No newline at end of file
+    size_t size_ = 0;
+    [[no_unique_address]] Allocator alloc_;
+};
@@ -0,0 +1,983 @@
+#include "simple_vector.h"
+#include "concurrent_simple_vector.h"
+#include "parallel_algorithms.h"
+#include "mapped_simple_vector.h"
+#include "simple_vector_io.h"
+#include "aligned_allocator.h"
+#include "shared_simple_vector.h"
+#include "simple_vector_stats.h"
+#include "segmented_simple_vector.h"
+#include "soa_simple_vector.h"
+#include "flat_containers.h"
+#include "bit_simple_vector.h"
+#include "gap_simple_vector.h"
+#include "packed_int_vector.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Микробенчмарки SimpleVector. Каждый сценарий запускается и для std::vector,
+// который служит точкой отсчёта. Пример запуска одного сценария:
+//     simple_vector_bench --benchmark_filter='BM_PushBack<SimpleVector, int>'
+
+// Элемент со включённой статистикой SimpleVector: показывает цену счётчиков
+struct StatsInt {
+    int value = 0;
+};
+
+template <>
+struct EnableSimpleVectorStats<StatsInt> : std::true_type {};
+
+namespace {
+
+// 64-байтная POD-структура: тривиально копируемая запись фиксированного размера
+struct Pod64 {
+    std::uint64_t words[8];
+};
+
+bool operator==(const Pod64& lhs, const Pod64& rhs) {
+    for (int i = 0; i < 8; ++i) {
+        if (lhs.words[i] != rhs.words[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool operator<(const Pod64& lhs, const Pod64& rhs) {
+    for (int i = 0; i < 8; ++i) {
+        if (lhs.words[i] != rhs.words[i]) {
+            return lhs.words[i] < rhs.words[i];
+        }
+    }
+    return false;
+}
+
+static_assert(sizeof(Pod64) == 64);
+
+template <typename T>
+T MakeValue(std::int64_t i);
+
+template <>
+int MakeValue<int>(std::int64_t i) {
+    return static_cast<int>(i);
+}
+
+template <>
+std::string MakeValue<std::string>(std::int64_t i) {
+    return "item_" + std::to_string(i);
+}
+
+template <>
+Pod64 MakeValue<Pod64>(std::int64_t i) {
+    Pod64 pod{};
+    for (auto& word : pod.words) {
+        word = static_cast<std::uint64_t>(i);
+    }
+    return pod;
+}
+
+// Единый интерфейс к SimpleVector и std::vector
+
+template <typename T>
+void Append(SimpleVector<T>& v, const T& value) {
+    v.PushBack(value);
+}
+
+template <typename T>
+void Append(std::vector<T>& v, const T& value) {
+    v.push_back(value);
+}
+
+template <typename T>
+void InsertAt(SimpleVector<T>& v, size_t index, const T& value) {
+    v.Insert(v.begin() + index, value);
+}
+
+template <typename T>
+void InsertAt(std::vector<T>& v, size_t index, const T& value) {
+    v.insert(v.begin() + index, value);
+}
+
+template <typename T>
+void EraseAt(SimpleVector<T>& v, size_t index) {
+    v.Erase(v.begin() + index);
+}
+
+template <typename T>
+void EraseAt(std::vector<T>& v, size_t index) {
+    v.erase(v.begin() + index);
+}
+
+template <typename T, typename It>
+void InsertRangeAt(SimpleVector<T>& v, size_t index, It first, It last) {
+    v.Insert(v.begin() + index, first, last);
+}
+
+template <typename T, typename It>
+void InsertRangeAt(std::vector<T>& v, size_t index, It first, It last) {
+    v.insert(v.begin() + index, first, last);
+}
+
+template <typename T>
+void EraseRangeAt(SimpleVector<T>& v, size_t index, size_t count) {
+    v.Erase(v.begin() + index, v.begin() + index + count);
+}
+
+template <typename T>
+void EraseRangeAt(std::vector<T>& v, size_t index, size_t count) {
+    v.erase(v.begin() + index, v.begin() + index + count);
+}
+
+template <typename T>
+void ReserveTo(SimpleVector<T>& v, size_t capacity) {
+    v.Reserve(capacity);
+}
+
+template <typename T>
+void ReserveTo(std::vector<T>& v, size_t capacity) {
+    v.reserve(capacity);
+}
+
+template <typename T>
+auto FindIn(const SimpleVector<T>& v, const T& value) {
+    return v.Find(value);
+}
+
+template <typename T>
+auto FindIn(const std::vector<T>& v, const T& value) {
+    return std::find(v.begin(), v.end(), value);
+}
+
+template <typename T>
+size_t CountIn(const SimpleVector<T>& v, const T& value) {
+    return v.Count(value);
+}
+
+template <typename T>
+size_t CountIn(const std::vector<T>& v, const T& value) {
+    return static_cast<size_t>(std::count(v.begin(), v.end(), value));
+}
+
+template <typename T>
+auto MinElementIn(const SimpleVector<T>& v) {
+    return v.MinElement();
+}
+
+template <typename T>
+auto MinElementIn(const std::vector<T>& v) {
+    return std::min_element(v.begin(), v.end());
+}
+
+template <template <typename...> class Vector, typename T>
+Vector<T> MakeFilled(std::int64_t size) {
+    Vector<T> v;
+    ReserveTo(v, static_cast<size_t>(size));
+    for (std::int64_t i = 0; i < size; ++i) {
+        Append(v, MakeValue<T>(i));
+    }
+    return v;
+}
+
+enum class Position { Front, Middle, Back };
+
+size_t IndexAt(Position position, size_t size) {
+    switch (position) {
+        case Position::Front:
+            return 0;
+        case Position::Middle:
+            return size / 2;
+        case Position::Back:
+            return size;
+    }
+    return 0;
+}
+
+// Заполнение пустого вектора без предварительного Reserve
+template <template <typename...> class Vector, typename T>
+void BM_PushBack(benchmark::State& state) {
+    const std::int64_t size = state.range(0);
+    const T value = MakeValue<T>(42);
+    for (auto _ : state) {
+        Vector<T> v;
+        for (std::int64_t i = 0; i < size; ++i) {
+            Append(v, value);
+        }
+        benchmark::DoNotOptimize(&v[0]);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * size);
+}
+
+// Вставка и удаление одного элемента: размер вектора между итерациями не меняется
+template <template <typename...> class Vector, typename T, Position position>
+void BM_InsertErase(benchmark::State& state) {
+    auto v = MakeFilled<Vector, T>(state.range(0));
+    const size_t index = IndexAt(position, static_cast<size_t>(state.range(0)));
+    const T value = MakeValue<T>(-1);
+    for (auto _ : state) {
+        InsertAt(v, index, value);
+        EraseAt(v, index);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * 2);
+}
+
+// Вставка пачки из 10k элементов в середину и её удаление
+template <template <typename...> class Vector, typename T>
+void BM_InsertEraseRange(benchmark::State& state) {
+    constexpr size_t kBatch = 10'000;
+    auto v = MakeFilled<Vector, T>(state.range(0));
+    const auto batch = MakeFilled<std::vector, T>(kBatch);
+    const size_t index = static_cast<size_t>(state.range(0)) / 2;
+    for (auto _ : state) {
+        InsertRangeAt(v, index, batch.begin(), batch.end());
+        EraseRangeAt(v, index, kBatch);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(kBatch) * 2);
+}
+
+// Переезд заполненного вектора в буфер вдвое большей вместимости
+template <template <typename...> class Vector, typename T>
+void BM_ReserveGrowth(benchmark::State& state) {
+    const std::int64_t size = state.range(0);
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto v = MakeFilled<Vector, T>(size);
+        state.ResumeTiming();
+        ReserveTo(v, static_cast<size_t>(size) * 2);
+        benchmark::ClobberMemory();
+        state.PauseTiming();
+        {
+            auto destroyed = std::move(v);
+        }
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * size);
+}
+
+template <template <typename...> class Vector, typename T>
+void BM_CopyConstruct(benchmark::State& state) {
+    const auto source = MakeFilled<Vector, T>(state.range(0));
+    for (auto _ : state) {
+        Vector<T> copy(source);
+        benchmark::DoNotOptimize(&copy[0]);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// Перемещающий конструктор и перемещающее присваивание обратно
+template <template <typename...> class Vector, typename T>
+void BM_MoveConstruct(benchmark::State& state) {
+    auto source = MakeFilled<Vector, T>(state.range(0));
+    for (auto _ : state) {
+        Vector<T> moved(std::move(source));
+        benchmark::DoNotOptimize(&moved);
+        source = std::move(moved);
+    }
+}
+
+// Сравнения равных векторов проходят их целиком
+template <template <typename...> class Vector, typename T>
+void BM_Equal(benchmark::State& state) {
+    const auto lhs = MakeFilled<Vector, T>(state.range(0));
+    const auto rhs = MakeFilled<Vector, T>(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(lhs == rhs);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <template <typename...> class Vector, typename T>
+void BM_Less(benchmark::State& state) {
+    const auto lhs = MakeFilled<Vector, T>(state.range(0));
+    const auto rhs = MakeFilled<Vector, T>(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(lhs < rhs);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <template <typename...> class Vector, typename T>
+void BM_LessEqual(benchmark::State& state) {
+    const auto lhs = MakeFilled<Vector, T>(state.range(0));
+    const auto rhs = MakeFilled<Vector, T>(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(lhs <= rhs);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// Поиск отсутствующего значения проходит вектор целиком
+template <template <typename...> class Vector, typename T>
+void BM_Find(benchmark::State& state) {
+    const auto v = MakeFilled<Vector, T>(state.range(0));
+    const T missing = MakeValue<T>(-1);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(FindIn(v, missing));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <template <typename...> class Vector, typename T>
+void BM_Count(benchmark::State& state) {
+    const auto v = MakeFilled<Vector, T>(state.range(0));
+    const T value = MakeValue<T>(state.range(0) / 2);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(CountIn(v, value));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <template <typename...> class Vector, typename T>
+void BM_MinElement(benchmark::State& state) {
+    const auto v = MakeFilled<Vector, T>(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(MinElementIn(v));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// Открытие файла записей: отображение в память против чтения в SimpleVector.
+// Отображение не зависит от размера файла, чтение пропорционально ему
+std::string MakeRecordFile(std::int64_t size) {
+    const std::string path = (std::filesystem::temp_directory_path() / "simple_vector_bench.bin").string();
+    MappedSimpleVector<Pod64> file(path);
+    file.Clear();
+    file.Resize(static_cast<size_t>(size));
+    return path;
+}
+
+void BM_MappedOpen(benchmark::State& state) {
+    const std::string path = MakeRecordFile(state.range(0));
+    for (auto _ : state) {
+        const MappedSimpleVector<Pod64> v(path, MapMode::kReadOnly);
+        benchmark::DoNotOptimize(v[v.GetSize() / 2].words[0]);
+    }
+    std::filesystem::remove(path);
+}
+
+void BM_ReadFile(benchmark::State& state) {
+    const std::string path = MakeRecordFile(state.range(0));
+    for (auto _ : state) {
+        SimpleVector<Pod64> v(static_cast<size_t>(state.range(0)));
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        benchmark::DoNotOptimize(std::fread(v.Data(), sizeof(Pod64), v.GetSize(), file));
+        std::fclose(file);
+        benchmark::DoNotOptimize(v[v.GetSize() / 2].words[0]);
+    }
+    std::filesystem::remove(path);
+}
+
+// Стресс-тест одновременной записи: все потоки добавляют в один общий вектор.
+// Число итераций на поток фиксировано, чтобы вектор не съел всю память
+constexpr std::int64_t kConcurrentPushesPerThread = 1 << 20;
+
+void BM_ConcurrentPushBack(benchmark::State& state) {
+    static ConcurrentSimpleVector<std::int64_t>* shared = nullptr;
+    if (state.thread_index() == 0) {
+        shared = new ConcurrentSimpleVector<std::int64_t>();
+    }
+    std::int64_t value = state.thread_index();
+    for (auto _ : state) {
+        shared->PushBack(value++);
+    }
+    if (state.thread_index() == 0) {
+        delete shared;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Точка отсчёта: SimpleVector под общим мьютексом
+void BM_MutexPushBack(benchmark::State& state) {
+    static SimpleVector<std::int64_t>* shared = nullptr;
+    static std::mutex mutex;
+    if (state.thread_index() == 0) {
+        shared = new SimpleVector<std::int64_t>();
+    }
+    std::int64_t value = state.thread_index();
+    for (auto _ : state) {
+        std::lock_guard guard(mutex);
+        shared->PushBack(value++);
+    }
+    if (state.thread_index() == 0) {
+        delete shared;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Заполнение нового вектора одним значением: конструктор против ParallelAssign
+void BM_FillConstruct(benchmark::State& state) {
+    const auto size = static_cast<size_t>(state.range(0));
+    for (auto _ : state) {
+        SimpleVector<std::int64_t> v(size, 42);
+        benchmark::DoNotOptimize(v.begin());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_ParallelAssign(benchmark::State& state) {
+    const auto size = static_cast<size_t>(state.range(0));
+    for (auto _ : state) {
+        SimpleVector<std::int64_t> v;
+        ParallelAssign(v, size, std::int64_t{42});
+        benchmark::DoNotOptimize(v.begin());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// Сортировка перемешанных чисел: std::sort против ParallelSort
+SimpleVector<std::int64_t> MakeShuffled(size_t size) {
+    SimpleVector<std::int64_t> v(size);
+    std::uint64_t state = 88172645463325252ULL;
+    for (auto& x : v) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        x = static_cast<std::int64_t>(state);
+    }
+    return v;
+}
+
+void BM_Sort(benchmark::State& state) {
+    const SimpleVector<std::int64_t> source = MakeShuffled(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        state.PauseTiming();
+        SimpleVector<std::int64_t> v(source);
+        state.ResumeTiming();
+        std::sort(v.begin(), v.end());
+        benchmark::DoNotOptimize(v.begin());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_ParallelSort(benchmark::State& state) {
+    const SimpleVector<std::int64_t> source = MakeShuffled(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        state.PauseTiming();
+        SimpleVector<std::int64_t> v(source);
+        state.ResumeTiming();
+        ParallelSort(v);
+        benchmark::DoNotOptimize(v.begin());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// Сохранение и загрузка вектора в двоичном формате: пропускная способность в байтах
+void BM_SaveLoad(benchmark::State& state) {
+    const std::string path = (std::filesystem::temp_directory_path() / "simple_vector_bench.svec").string();
+    const SimpleVector<std::int64_t> source = MakeShuffled(static_cast<size_t>(state.range(0)));
+    SimpleVector<std::int64_t> loaded;
+    for (auto _ : state) {
+        SaveSimpleVector(path, source);
+        LoadSimpleVector(path, loaded);
+        benchmark::DoNotOptimize(loaded.begin());
+    }
+    std::filesystem::remove(path);
+    state.SetBytesProcessed(state.iterations() * state.range(0) * 2 * static_cast<std::int64_t>(sizeof(std::int64_t)));
+}
+
+// Контрольная сумма отдельно от ввода-вывода
+void BM_Checksum(benchmark::State& state) {
+    const SimpleVector<std::int64_t> source = MakeShuffled(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        Checksum64 checksum;
+        checksum.Update(source.Data(), source.GetSize() * sizeof(std::int64_t));
+        benchmark::DoNotOptimize(checksum.Finish());
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0) * static_cast<std::int64_t>(sizeof(std::int64_t)));
+}
+
+// Чтение в случайном порядке упирается в промахи TLB, которые сокращают большие страницы
+template <typename Allocator>
+void BM_RandomRead(benchmark::State& state) {
+    const auto size = static_cast<size_t>(state.range(0));
+    SimpleVector<float, Allocator> v;
+    ParallelResize(v, size);
+    SimpleVector<std::uint32_t> order(1 << 16);
+    std::uint64_t seed = 88172645463325252ULL;
+    for (auto& index : order) {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        index = static_cast<std::uint32_t>(seed % size);
+    }
+    for (auto _ : state) {
+        float sum = 0;
+        for (std::uint32_t index : order) {
+            sum += v[index];
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(order.GetSize()));
+}
+
+// Снимок для читателя: SimpleVector копирует элементы, SharedSimpleVector - только счётчик
+template <typename Vector>
+void BM_Snapshot(benchmark::State& state) {
+    const Vector source(SimpleVector<int>(static_cast<size_t>(state.range(0)), 1));
+    for (auto _ : state) {
+        const Vector snapshot(source);
+        benchmark::DoNotOptimize(snapshot.cbegin());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Снимки одного вектора из многих потоков: все они меняют один атомарный счётчик
+void BM_SharedSnapshotThreads(benchmark::State& state) {
+    static const SharedSimpleVector<int> source(SimpleVector<int>(1000, 1));
+    for (auto _ : state) {
+        const SharedSimpleVector<int> snapshot(source);
+        benchmark::DoNotOptimize(snapshot[0]);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Переносит счётчики в вывод бенчмарка как средние на итерацию
+void ReportStats(benchmark::State& state, const SimpleVectorStats& stats) {
+    const SimpleVectorStatsSnapshot snapshot = stats.GetSnapshot();
+    const auto per_iteration = benchmark::Counter::kAvgIterations;
+    state.counters["allocations"] = benchmark::Counter(static_cast<double>(snapshot.allocations), per_iteration);
+    state.counters["bytes"] = benchmark::Counter(static_cast<double>(snapshot.bytes_allocated), per_iteration);
+    state.counters["relocated"] = benchmark::Counter(static_cast<double>(snapshot.elements_relocated), per_iteration);
+    state.counters["peak_capacity"] = static_cast<double>(snapshot.peak_capacity);
+}
+
+// Тот же PushBack, что и BM_PushBack<SimpleVector, int>, но со счётчиками
+void BM_PushBackStats(benchmark::State& state) {
+    const std::int64_t size = state.range(0);
+    SimpleVectorStats stats;
+    for (auto _ : state) {
+        SimpleVector<StatsInt> v;
+        v.SetStats(stats);
+        for (std::int64_t i = 0; i < size; ++i) {
+            v.PushBack(StatsInt{static_cast<int>(i)});
+        }
+        benchmark::DoNotOptimize(&v[0]);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * size);
+    ReportStats(state, stats);
+}
+
+// Цена политики роста: время добавления и запас вместимости в конце
+template <typename Growth>
+void BM_PushBackGrowth(benchmark::State& state) {
+    const auto size = static_cast<size_t>(state.range(0));
+    size_t capacity = 0;
+    for (auto _ : state) {
+        SimpleVector<int, std::allocator<int>, Growth> v;
+        for (size_t i = 0; i < size; ++i) {
+            v.PushBack(static_cast<int>(i));
+        }
+        capacity = v.GetCapacity();
+        benchmark::DoNotOptimize(&v[0]);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["slack"] = static_cast<double>(capacity - size) / static_cast<double>(size);
+}
+
+// Хвостовая задержка добавления: самый долгий одиночный PushBack за заполнение.
+// SimpleVector платит за перенос всех элементов на каждом росте, сегментированный
+// вектор - только за выделение блока и, изредка, за перенос таблицы указателей
+template <typename Vector>
+void BM_PushBackTailLatency(benchmark::State& state) {
+    using Clock = std::chrono::steady_clock;
+    const std::int64_t size = state.range(0);
+    const Pod64 value = MakeValue<Pod64>(42);
+    Clock::duration worst{};
+    for (auto _ : state) {
+        Vector v;
+        for (std::int64_t i = 0; i < size; ++i) {
+            const auto start = Clock::now();
+            v.PushBack(value);
+            worst = std::max(worst, Clock::now() - start);
+        }
+        benchmark::DoNotOptimize(&v[0]);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * size);
+    state.counters["max_ns"] = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(worst).count());
+}
+
+// Запись из восьми полей, из которых горячий цикл читает одно
+struct Record {
+    double price;
+    double volume;
+    double bid;
+    double ask;
+    std::int64_t id;
+    std::int64_t time;
+    std::int64_t flags;
+    std::int64_t venue;
+};
+
+using RecordColumns = SoASimpleVector<double, double, double, double, std::int64_t, std::int64_t, std::int64_t, std::int64_t>;
+
+// Сумма одного поля: по массиву записей и по столбцу SoASimpleVector
+void BM_FieldScanRows(benchmark::State& state) {
+    const auto size = static_cast<size_t>(state.range(0));
+    SimpleVector<Record> rows(size);
+    for (size_t i = 0; i < size; ++i) {
+        rows[i].price = static_cast<double>(i);
+    }
+    for (auto _ : state) {
+        double sum = 0.0;
+        for (const Record& row : rows) {
+            sum += row.price;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0) * static_cast<std::int64_t>(sizeof(double)));
+}
+
+void BM_FieldScanColumns(benchmark::State& state) {
+    const auto size = static_cast<size_t>(state.range(0));
+    RecordColumns columns(size);
+    double* prices = columns.ColumnData<0>();
+    for (size_t i = 0; i < size; ++i) {
+        prices[i] = static_cast<double>(i);
+    }
+    for (auto _ : state) {
+        double sum = 0.0;
+        for (double price : columns.Column<0>()) {
+            sum += price;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0) * static_cast<std::int64_t>(sizeof(double)));
+}
+
+// Буфер 100 МБ, из которого разбор раздаёт участки
+const SimpleVector<char>& ParserBuffer() {
+    static const SimpleVector<char> buffer = [] {
+        SimpleVector<char> result(100 << 20);
+        for (size_t i = 0; i < result.GetSize(); ++i) {
+            result[i] = i % 61 == 0 ? '\n' : static_cast<char>('a' + i % 26);
+        }
+        return result;
+    }();
+    return buffer;
+}
+
+// Участок длиной range(0) по случайному смещению: копия в новый SimpleVector
+// против вида Slice. Над участком считаются переводы строк
+template <bool kUseView>
+void BM_Subrange(benchmark::State& state) {
+    const SimpleVector<char>& buffer = ParserBuffer();
+    const auto length = static_cast<size_t>(state.range(0));
+    std::uint64_t seed = 1;
+    for (auto _ : state) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        const size_t first = static_cast<size_t>(seed >> 33) % (buffer.GetSize() - length);
+        if constexpr (kUseView) {
+            benchmark::DoNotOptimize(buffer.Slice(first, length).Count('\n'));
+        } else {
+            const SimpleVector<char> copy(buffer.begin() + first, buffer.begin() + first + length);
+            benchmark::DoNotOptimize(copy.Count('\n'));
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Аллокатор, считающий занятые байты, - чтобы сравнить память таблиц
+inline std::int64_t counted_bytes = 0;
+
+template <typename T>
+struct CountingAllocator {
+    using value_type = T;
+
+    CountingAllocator() = default;
+
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>&) noexcept {}
+
+    T* allocate(size_t count) {
+        counted_bytes += static_cast<std::int64_t>(count * sizeof(T));
+        return std::allocator<T>().allocate(count);
+    }
+
+    void deallocate(T* p, size_t count) noexcept {
+        counted_bytes -= static_cast<std::int64_t>(count * sizeof(T));
+        std::allocator<T>().deallocate(p, count);
+    }
+
+    friend bool operator==(const CountingAllocator&, const CountingAllocator&) { return true; }
+    friend bool operator!=(const CountingAllocator&, const CountingAllocator&) { return false; }
+};
+
+using CountedStdMap = std::map<std::int64_t, std::int64_t, std::less<>, CountingAllocator<std::pair<const std::int64_t, std::int64_t>>>;
+using CountedFlatMap = FlatMap<std::int64_t, std::int64_t, std::less<>, CountingAllocator<std::int64_t>, CountingAllocator<std::int64_t>>;
+
+template <typename Map>
+void Put(Map& map, std::int64_t key, std::int64_t value) {
+    if constexpr (std::is_same_v<Map, CountedStdMap>) {
+        map.emplace(key, value);
+    } else {
+        map.Insert(key, value);
+    }
+}
+
+template <typename Map>
+bool Has(const Map& map, std::int64_t key) {
+    if constexpr (std::is_same_v<Map, CountedStdMap>) {
+        return map.find(key) != map.end();
+    } else {
+        return map.Contains(key);
+    }
+}
+
+// Поиск случайных ключей (половина отсутствует) в таблице из range(0) записей
+template <typename Map>
+void BM_MapLookup(benchmark::State& state) {
+    const std::int64_t size = state.range(0);
+    const std::int64_t bytes_before = counted_bytes;
+    std::int64_t table_bytes = 0;
+    {
+        Map map;
+        for (std::int64_t i = 0; i < size; ++i) {
+            Put(map, i * 2, i);
+        }
+        table_bytes = counted_bytes - bytes_before;
+        std::uint64_t seed = 1;
+        for (auto _ : state) {
+            seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+            const auto key = static_cast<std::int64_t>((seed >> 33) % static_cast<std::uint64_t>(size * 2));
+            benchmark::DoNotOptimize(Has(map, key));
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["bytes_per_entry"] = static_cast<double>(table_bytes) / static_cast<double>(size);
+}
+
+// Пересечение битовых карт на месте и подсчёт общих флагов
+size_t AndCount(SimpleVector<bool>& lhs, const SimpleVector<bool>& rhs) {
+    for (size_t i = 0; i < lhs.GetSize(); ++i) {
+        lhs[i] = lhs[i] && rhs[i];
+    }
+    return lhs.Count(true);
+}
+
+size_t AndCount(BitSimpleVector<>& lhs, const BitSimpleVector<>& rhs) {
+    lhs &= rhs;
+    return lhs.Count();
+}
+
+// Байт на флаг в SimpleVector<bool> против 64 флагов в слове у BitSimpleVector
+template <typename Bits>
+void BM_BitmapAndCount(benchmark::State& state) {
+    const auto size = static_cast<size_t>(state.range(0));
+    Bits lhs(size);
+    Bits rhs(size);
+    std::uint64_t seed = 1;
+    for (size_t i = 0; i < size; ++i) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        lhs[i] = (seed >> 62) != 0;
+        rhs[i] = (seed >> 61) % 4 != 0;
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(AndCount(lhs, rhs));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["bits_per_flag"] = std::is_same_v<Bits, SimpleVector<bool>> ? 8.0 : 1.0;
+}
+
+void InsertAt(SimpleVector<char>& text, size_t index, char c) {
+    text.Insert(text.begin() + index, c);
+}
+
+void InsertAt(GapSimpleVector<char>& text, size_t index, char c) {
+    text.Insert(index, c);
+}
+
+void EraseAt(SimpleVector<char>& text, size_t index) {
+    text.Erase(text.begin() + index);
+}
+
+void EraseAt(GapSimpleVector<char>& text, size_t index) {
+    text.Erase(index);
+}
+
+// Правки текста длиной range(0) как в редакторе: курсор блуждает по середине на
+// несколько символов, в нём вставляется и удаляется символ. SimpleVector сдвигает
+// весь хвост, GapSimpleVector - только символы, через которые прошёл курсор
+template <typename Text>
+void BM_CursorEdits(benchmark::State& state) {
+    const auto size = static_cast<size_t>(state.range(0));
+    Text text(size, 'x');
+    size_t cursor = size / 2;
+    std::uint64_t seed = 1;
+    for (auto _ : state) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        const size_t step = (seed >> 60) % 8;
+        cursor = (seed >> 59) % 2 == 0 ? std::min(cursor + step, size - 1) : cursor - std::min(cursor, step);
+        InsertAt(text, cursor, 'y');
+        EraseAt(text, cursor + 1);
+        benchmark::DoNotOptimize(text[cursor]);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+std::uint64_t SumIds(const SimpleVector<std::uint64_t>& ids) {
+    std::uint64_t sum = 0;
+    for (std::uint64_t id : ids) {
+        sum += id;
+    }
+    return sum;
+}
+
+std::uint64_t SumIds(const PackedIntVector& ids) {
+    std::uint64_t sum = 0;
+    ids.ForEachBlock([&sum](const std::uint64_t* data, size_t count) {
+        std::uint64_t block_sum = 0;
+        for (size_t i = 0; i < count; ++i) {
+            block_sum += data[i];
+        }
+        sum += block_sum;
+    });
+    return sum;
+}
+
+size_t MemoryUsage(const SimpleVector<std::uint64_t>& ids) {
+    return ids.GetCapacity() * sizeof(std::uint64_t);
+}
+
+size_t MemoryUsage(const PackedIntVector& ids) {
+    return ids.GetMemoryUsage();
+}
+
+// Полный проход по отсортированному списку из range(0) идентификаторов с шагом от 1 до 16
+template <typename Ids>
+void BM_IdScan(benchmark::State& state) {
+    Ids ids;
+    std::uint64_t id = 0;
+    std::uint64_t seed = 1;
+    for (std::int64_t i = 0; i < state.range(0); ++i) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        ids.PushBack(id += 1 + (seed >> 60));
+    }
+    ids.ShrinkToFit();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(SumIds(ids));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["bytes_per_id"] = static_cast<double>(MemoryUsage(ids)) / static_cast<double>(state.range(0));
+}
+
+// Чтение по случайным индексам из того же списка: в delta-блоке PackedIntVector
+// складывает не больше 15 разностей после ближайшей контрольной суммы
+template <typename Ids>
+void BM_IdLookup(benchmark::State& state) {
+    Ids ids;
+    std::uint64_t id = 0;
+    std::uint64_t seed = 1;
+    for (std::int64_t i = 0; i < state.range(0); ++i) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        ids.PushBack(id += 1 + (seed >> 60));
+    }
+    ids.ShrinkToFit();
+    const auto size = static_cast<std::uint64_t>(state.range(0));
+    for (auto _ : state) {
+        std::uint64_t sum = 0;
+        for (int i = 0; i < 1024; ++i) {
+            seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+            sum += ids[(seed >> 32) % size];
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * 1024);
+}
+
+// Размеры от 16 до 10M элементов с шагом x8
+void Sizes(benchmark::internal::Benchmark* bench) {
+    bench->RangeMultiplier(8)->Range(16, 10'000'000);
+}
+
+}  // namespace
+
+#define SIMPLE_VECTOR_BENCHMARK(...)                                             \
+    BENCHMARK_TEMPLATE(__VA_ARGS__, std::vector, int)->Apply(Sizes);             \
+    BENCHMARK_TEMPLATE(__VA_ARGS__, SimpleVector, int)->Apply(Sizes);            \
+    BENCHMARK_TEMPLATE(__VA_ARGS__, std::vector, std::string)->Apply(Sizes);     \
+    BENCHMARK_TEMPLATE(__VA_ARGS__, SimpleVector, std::string)->Apply(Sizes);    \
+    BENCHMARK_TEMPLATE(__VA_ARGS__, std::vector, Pod64)->Apply(Sizes);           \
+    BENCHMARK_TEMPLATE(__VA_ARGS__, SimpleVector, Pod64)->Apply(Sizes)
+
+#define SIMPLE_VECTOR_POSITION_BENCHMARK(fn, position)                                     \
+    BENCHMARK_TEMPLATE(fn, std::vector, int, position)->Apply(Sizes);                      \
+    BENCHMARK_TEMPLATE(fn, SimpleVector, int, position)->Apply(Sizes);                     \
+    BENCHMARK_TEMPLATE(fn, std::vector, std::string, position)->Apply(Sizes);              \
+    BENCHMARK_TEMPLATE(fn, SimpleVector, std::string, position)->Apply(Sizes);             \
+    BENCHMARK_TEMPLATE(fn, std::vector, Pod64, position)->Apply(Sizes);                    \
+    BENCHMARK_TEMPLATE(fn, SimpleVector, Pod64, position)->Apply(Sizes)
+
+SIMPLE_VECTOR_BENCHMARK(BM_PushBack);
+SIMPLE_VECTOR_POSITION_BENCHMARK(BM_InsertErase, Position::Front);
+SIMPLE_VECTOR_POSITION_BENCHMARK(BM_InsertErase, Position::Middle);
+SIMPLE_VECTOR_POSITION_BENCHMARK(BM_InsertErase, Position::Back);
+SIMPLE_VECTOR_BENCHMARK(BM_InsertEraseRange);
+SIMPLE_VECTOR_BENCHMARK(BM_ReserveGrowth);
+SIMPLE_VECTOR_BENCHMARK(BM_CopyConstruct);
+SIMPLE_VECTOR_BENCHMARK(BM_MoveConstruct);
+SIMPLE_VECTOR_BENCHMARK(BM_Equal);
+SIMPLE_VECTOR_BENCHMARK(BM_Less);
+SIMPLE_VECTOR_BENCHMARK(BM_LessEqual);
+SIMPLE_VECTOR_BENCHMARK(BM_Find);
+SIMPLE_VECTOR_BENCHMARK(BM_Count);
+SIMPLE_VECTOR_BENCHMARK(BM_MinElement);
+
+BENCHMARK(BM_FillConstruct)->Apply(Sizes)->UseRealTime();
+BENCHMARK(BM_ParallelAssign)->Apply(Sizes)->UseRealTime();
+BENCHMARK(BM_Sort)->Apply(Sizes)->UseRealTime();
+BENCHMARK(BM_ParallelSort)->Apply(Sizes)->UseRealTime();
+
+BENCHMARK(BM_MappedOpen)->Apply(Sizes);
+BENCHMARK(BM_ReadFile)->Apply(Sizes);
+
+BENCHMARK(BM_SaveLoad)->Apply(Sizes)->UseRealTime();
+BENCHMARK(BM_Checksum)->Apply(Sizes);
+
+BENCHMARK_TEMPLATE(BM_RandomRead, std::allocator<float>)->Apply(Sizes);
+BENCHMARK_TEMPLATE(BM_RandomRead, AlignedAllocator<float>)->Apply(Sizes);
+
+BENCHMARK(BM_PushBackStats)->Apply(Sizes);
+BENCHMARK_TEMPLATE(BM_PushBackGrowth, DoublingGrowth)->Apply(Sizes);
+BENCHMARK_TEMPLATE(BM_PushBackGrowth, OneAndHalfGrowth)->Apply(Sizes);
+BENCHMARK_TEMPLATE(BM_PushBackGrowth, PageRoundedGrowth<>)->Apply(Sizes);
+BENCHMARK_TEMPLATE(BM_PushBackTailLatency, SimpleVector<Pod64>)->Apply(Sizes);
+BENCHMARK_TEMPLATE(BM_PushBackTailLatency, SegmentedSimpleVector<Pod64>)->Apply(Sizes);
+BENCHMARK(BM_FieldScanRows)->Apply(Sizes);
+BENCHMARK(BM_FieldScanColumns)->Apply(Sizes);
+BENCHMARK_TEMPLATE(BM_Subrange, false)->RangeMultiplier(16)->Range(64, 1 << 20);
+BENCHMARK_TEMPLATE(BM_Subrange, true)->RangeMultiplier(16)->Range(64, 1 << 20);
+BENCHMARK_TEMPLATE(BM_MapLookup, CountedStdMap)->Arg(100)->Arg(10'000)->Arg(1'000'000);
+BENCHMARK_TEMPLATE(BM_MapLookup, CountedFlatMap)->Arg(100)->Arg(10'000)->Arg(1'000'000);
+BENCHMARK_TEMPLATE(BM_BitmapAndCount, SimpleVector<bool>)->Apply(Sizes);
+BENCHMARK_TEMPLATE(BM_BitmapAndCount, BitSimpleVector<>)->Apply(Sizes);
+BENCHMARK_TEMPLATE(BM_CursorEdits, SimpleVector<char>)->Apply(Sizes);
+BENCHMARK_TEMPLATE(BM_CursorEdits, GapSimpleVector<char>)->Apply(Sizes);
+BENCHMARK_TEMPLATE(BM_IdScan, SimpleVector<std::uint64_t>)->Apply(Sizes);
+BENCHMARK_TEMPLATE(BM_IdScan, PackedIntVector)->Apply(Sizes);
+BENCHMARK_TEMPLATE(BM_IdLookup, SimpleVector<std::uint64_t>)->Apply(Sizes);
+BENCHMARK_TEMPLATE(BM_IdLookup, PackedIntVector)->Apply(Sizes);
+
+BENCHMARK_TEMPLATE(BM_Snapshot, SimpleVector<int>)->Apply(Sizes);
+BENCHMARK_TEMPLATE(BM_Snapshot, SharedSimpleVector<int>)->Apply(Sizes);
+BENCHMARK(BM_SharedSnapshotThreads)->ThreadRange(1, 32)->UseRealTime();
+
+BENCHMARK(BM_ConcurrentPushBack)->Iterations(kConcurrentPushesPerThread)->ThreadRange(1, 32)->UseRealTime();
+BENCHMARK(BM_MutexPushBack)->Iterations(kConcurrentPushesPerThread)->ThreadRange(1, 32)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,493 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "simd_kernels.h"
+#include "simple_vector.h"
+
+// Вектор флагов, упакованных по 64 в слово: в 8 раз меньше памяти, чем у SimpleVector<bool>.
+// Слова лежат в SimpleVector<std::uint64_t>, поэтому рост, Resize и PushBack работают
+// словами целиком, а Count, FindFirst/FindNext и поразрядные &=, |=, ^= и AndNot идут
+// по 64 флага за операцию, а для Count и поразрядных операций - векторными ядрами.
+//
+// Биты последнего слова за концом вектора всегда нулевые, так что Count и сравнение
+// не маскируют хвост. Элемент - прокси-ссылка Reference на бит, а не bool&, поэтому
+// итераторы хранят вектор и индекс. SimpleVector<bool> остаётся обычным массивом
+// байтов - на него можно получить SimpleVectorView и указатель bool*
+template <typename Allocator = std::allocator<std::uint64_t>>
+class BitSimpleVector {
+public:
+    using Word = std::uint64_t;
+    using WordStorage = SimpleVector<Word, typename std::allocator_traits<Allocator>::template rebind_alloc<Word>>;
+    using AllocatorType = Allocator;
+
+    static constexpr size_t kWordBits = 64;
+
+    // Ссылка на один бит: читается как bool, присваивание меняет бит в слове
+    class Reference {
+    public:
+        Reference(Word* word, Word mask) noexcept
+        : word_(word)
+        , mask_(mask)
+        {}
+
+        Reference(const Reference&) = default;
+
+        operator bool() const noexcept
+        {
+            return (*word_ & mask_) != 0;
+        }
+
+        bool operator~() const noexcept
+        {
+            return !bool(*this);
+        }
+
+        Reference& operator=(bool value) noexcept
+        {
+            *word_ = value ? (*word_ | mask_) : (*word_ & ~mask_);
+            return *this;
+        }
+
+        // Присваивание копирует значение бита, а не саму ссылку
+        Reference& operator=(const Reference& other) noexcept
+        {
+            return *this = bool(other);
+        }
+
+        void Flip() noexcept
+        {
+            *word_ ^= mask_;
+        }
+
+    private:
+        Word* word_;
+        Word mask_;
+    };
+
+private:
+    template <typename Owner, typename Ref>
+    class BasicIterator;
+
+public:
+    using Iterator = BasicIterator<BitSimpleVector, Reference>;
+    using ConstIterator = BasicIterator<const BitSimpleVector, bool>;
+
+    BitSimpleVector() noexcept = default;
+
+    explicit BitSimpleVector(const Allocator& alloc) noexcept
+    : words_(typename WordStorage::AllocatorType(alloc))
+    {}
+
+    // Создаёт size флагов со значением value
+    explicit BitSimpleVector(size_t size, bool value = false, const Allocator& alloc = Allocator())
+    : BitSimpleVector(alloc)
+    {
+        Resize(size, value);
+    }
+
+    BitSimpleVector(std::initializer_list<bool> init, const Allocator& alloc = Allocator())
+    : BitSimpleVector(alloc)
+    {
+        Reserve(init.size());
+        for(bool value : init)
+        {
+            PushBack(value);
+        }
+    }
+
+    BitSimpleVector(const BitSimpleVector& other)
+    : words_(other.words_)
+    , size_(other.size_)
+    {}
+
+    BitSimpleVector(BitSimpleVector&& other) noexcept
+    : words_(std::move(other.words_))
+    , size_(std::exchange(other.size_, 0))
+    {}
+
+    BitSimpleVector& operator=(const BitSimpleVector& rhs)
+    {
+        if(this != &rhs)
+        {
+            BitSimpleVector copy(rhs);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    BitSimpleVector& operator=(BitSimpleVector&& rhs) noexcept
+    {
+        if(this != &rhs)
+        {
+            words_ = std::move(rhs.words_);
+            size_ = std::exchange(rhs.size_, 0);
+        }
+        return *this;
+    }
+
+    void swap(BitSimpleVector& other) noexcept
+    {
+        words_.swap(other.words_);
+        std::swap(size_, other.size_);
+    }
+
+    size_t GetSize() const noexcept
+    {
+        return size_;
+    }
+
+    // Сколько флагов поместится без перевыделения
+    size_t GetCapacity() const noexcept
+    {
+        return words_.GetCapacity() * kWordBits;
+    }
+
+    bool IsEmpty() const noexcept
+    {
+        return size_ == 0;
+    }
+
+    // Слова с флагами: флаг index - бит index % 64 слова index / 64
+    const Word* WordData() const noexcept
+    {
+        return words_.Data();
+    }
+
+    size_t GetWordCount() const noexcept
+    {
+        return words_.GetSize();
+    }
+
+    Reference operator[](size_t index) noexcept
+    {
+        assert(index < size_);
+        return Reference(&words_[index / kWordBits], BitMask(index));
+    }
+
+    bool operator[](size_t index) const noexcept
+    {
+        assert(index < size_);
+        return (words_[index / kWordBits] & BitMask(index)) != 0;
+    }
+
+    // Выбрасывает исключение std::out_of_range, если index >= size
+    Reference At(size_t index)
+    {
+        if(index >= size_)
+        {
+            throw std::out_of_range("Index is out of range");
+        }
+        return (*this)[index];
+    }
+
+    bool At(size_t index) const
+    {
+        if(index >= size_)
+        {
+            throw std::out_of_range("Index is out of range");
+        }
+        return (*this)[index];
+    }
+
+    void Set(size_t index, bool value = true) noexcept
+    {
+        (*this)[index] = value;
+    }
+
+    void Reset(size_t index) noexcept
+    {
+        (*this)[index] = false;
+    }
+
+    void Flip(size_t index) noexcept
+    {
+        (*this)[index].Flip();
+    }
+
+    // Записывает value во все флаги
+    void Fill(bool value) noexcept
+    {
+        const Word word = value ? ~Word{0} : Word{0};
+        for(Word& w : words_)
+        {
+            w = word;
+        }
+        ClearTail();
+    }
+
+    Iterator begin() noexcept
+    {
+        return Iterator(this, 0);
+    }
+
+    Iterator end() noexcept
+    {
+        return Iterator(this, size_);
+    }
+
+    ConstIterator begin() const noexcept
+    {
+        return ConstIterator(this, 0);
+    }
+
+    ConstIterator end() const noexcept
+    {
+        return ConstIterator(this, size_);
+    }
+
+    ConstIterator cbegin() const noexcept
+    {
+        return begin();
+    }
+
+    ConstIterator cend() const noexcept
+    {
+        return end();
+    }
+
+    void PushBack(bool value)
+    {
+        const size_t bit = size_ % kWordBits;
+        if(bit == 0)
+        {
+            words_.PushBack(Word(value));
+        }
+        else
+        {
+            words_[size_ / kWordBits] |= Word(value) << bit;
+        }
+        ++size_;
+    }
+
+    void PopBack() noexcept
+    {
+        assert(!IsEmpty());
+        --size_;
+        if(size_ % kWordBits == 0)
+        {
+            words_.PopBack();
+        }
+        else
+        {
+            words_[size_ / kWordBits] &= ~BitMask(size_);
+        }
+    }
+
+    // Изменяет число флагов. Новые флаги получают значение value
+    void Resize(size_t new_size, bool value = false)
+    {
+        const size_t old_words = words_.GetSize();
+        if(new_size > size_ && value && size_ % kWordBits != 0)
+        {
+            words_[old_words - 1] |= ~Word{0} << (size_ % kWordBits);
+        }
+        words_.Resize(WordsFor(new_size));
+        if(value)
+        {
+            for(size_t i = old_words; i < words_.GetSize(); ++i)
+            {
+                words_[i] = ~Word{0};
+            }
+        }
+        size_ = new_size;
+        ClearTail();
+    }
+
+    // Резервирует место под capacity флагов
+    void Reserve(size_t capacity)
+    {
+        words_.Reserve(WordsFor(capacity));
+    }
+
+    void Clear() noexcept
+    {
+        words_.Clear();
+        size_ = 0;
+    }
+
+    void ShrinkToFit()
+    {
+        words_.ShrinkToFit();
+    }
+
+    // Число установленных флагов
+    size_t Count() const noexcept
+    {
+        return simd_detail::PopCount(words_.Data(), words_.GetSize());
+    }
+
+    // Индекс первого установленного флага или GetSize(), если таких нет
+    size_t FindFirst() const noexcept
+    {
+        return FindNext(0);
+    }
+
+    // Индекс первого установленного флага, не меньшего from, или GetSize()
+    size_t FindNext(size_t from) const noexcept
+    {
+        if(from >= size_)
+        {
+            return size_;
+        }
+        size_t index = from / kWordBits;
+        // Флаги до from в первом слове отбрасываются
+        Word word = words_[index] & (~Word{0} << (from % kWordBits));
+        while(word == 0)
+        {
+            if(++index == words_.GetSize())
+            {
+                return size_;
+            }
+            word = words_[index];
+        }
+        return index * kWordBits + simd_detail::CountTrailingZeros64(word);
+    }
+
+    // Поразрядные операции над векторами одного размера. При разных размерах
+    // выбрасывают std::invalid_argument
+    BitSimpleVector& operator&=(const BitSimpleVector& rhs)
+    {
+        return Apply<BitOp::kAnd>(rhs);
+    }
+
+    BitSimpleVector& operator|=(const BitSimpleVector& rhs)
+    {
+        return Apply<BitOp::kOr>(rhs);
+    }
+
+    BitSimpleVector& operator^=(const BitSimpleVector& rhs)
+    {
+        return Apply<BitOp::kXor>(rhs);
+    }
+
+    // Сбрасывает флаги, установленные в rhs
+    BitSimpleVector& AndNot(const BitSimpleVector& rhs)
+    {
+        return Apply<BitOp::kAndNot>(rhs);
+    }
+
+    friend BitSimpleVector operator&(BitSimpleVector lhs, const BitSimpleVector& rhs)
+    {
+        return std::move(lhs &= rhs);
+    }
+
+    friend BitSimpleVector operator|(BitSimpleVector lhs, const BitSimpleVector& rhs)
+    {
+        return std::move(lhs |= rhs);
+    }
+
+    friend BitSimpleVector operator^(BitSimpleVector lhs, const BitSimpleVector& rhs)
+    {
+        return std::move(lhs ^= rhs);
+    }
+
+    // Хвосты последних слов нулевые, поэтому векторы сравниваются словами
+    friend bool operator==(const BitSimpleVector& lhs, const BitSimpleVector& rhs)
+    {
+        return lhs.size_ == rhs.size_ && RangeEqual<Word>(lhs.words_.Data(), rhs.words_.Data(), lhs.words_.GetSize());
+    }
+
+    friend bool operator!=(const BitSimpleVector& lhs, const BitSimpleVector& rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+private:
+    static constexpr size_t WordsFor(size_t bits) noexcept
+    {
+        return (bits + kWordBits - 1) / kWordBits;
+    }
+
+    static constexpr Word BitMask(size_t index) noexcept
+    {
+        return Word{1} << (index % kWordBits);
+    }
+
+    // Обнуляет биты последнего слова за концом вектора
+    void ClearTail() noexcept
+    {
+        if(size_ % kWordBits != 0)
+        {
+            words_[words_.GetSize() - 1] &= ~(~Word{0} << (size_ % kWordBits));
+        }
+    }
+
+    template <BitOp Op>
+    BitSimpleVector& Apply(const BitSimpleVector& rhs)
+    {
+        if(size_ != rhs.size_)
+        {
+            throw std::invalid_argument("Bit vectors have different sizes");
+        }
+        simd_detail::Bitwise<Op>(words_.Data(), rhs.words_.Data(), words_.GetSize());
+        return *this;
+    }
+
+    // Итератор произвольного доступа по индексу флага
+    template <typename Owner, typename Ref>
+    class BasicIterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = bool;
+        using difference_type = std::ptrdiff_t;
+        using reference = Ref;
+        using pointer = void;
+
+        BasicIterator() = default;
+
+        BasicIterator(Owner* owner, size_t index) noexcept
+        : owner_(owner)
+        , index_(index)
+        {}
+
+        // Неконстантный итератор приводится к константному
+        template <typename OtherOwner, typename OtherRef,
+                  typename = std::enable_if_t<std::is_convertible_v<OtherOwner*, Owner*>>>
+        BasicIterator(const BasicIterator<OtherOwner, OtherRef>& other) noexcept
+        : owner_(other.owner_)
+        , index_(other.index_)
+        {}
+
+        reference operator*() const noexcept { return (*owner_)[index_]; }
+        reference operator[](difference_type n) const noexcept { return (*owner_)[index_ + n]; }
+
+        BasicIterator& operator++() noexcept { ++index_; return *this; }
+        BasicIterator operator++(int) noexcept { BasicIterator old = *this; ++index_; return old; }
+        BasicIterator& operator--() noexcept { --index_; return *this; }
+        BasicIterator operator--(int) noexcept { BasicIterator old = *this; --index_; return old; }
+        BasicIterator& operator+=(difference_type n) noexcept { index_ += n; return *this; }
+        BasicIterator& operator-=(difference_type n) noexcept { index_ -= n; return *this; }
+        BasicIterator operator+(difference_type n) const noexcept { return BasicIterator(owner_, index_ + n); }
+        BasicIterator operator-(difference_type n) const noexcept { return BasicIterator(owner_, index_ - n); }
+        friend BasicIterator operator+(difference_type n, const BasicIterator& it) noexcept { return it + n; }
+        difference_type operator-(const BasicIterator& other) const noexcept
+        {
+            return static_cast<difference_type>(index_) - static_cast<difference_type>(other.index_);
+        }
+
+        bool operator==(const BasicIterator& other) const noexcept { return index_ == other.index_; }
+        bool operator!=(const BasicIterator& other) const noexcept { return index_ != other.index_; }
+        bool operator<(const BasicIterator& other) const noexcept { return index_ < other.index_; }
+        bool operator>(const BasicIterator& other) const noexcept { return index_ > other.index_; }
+        bool operator<=(const BasicIterator& other) const noexcept { return index_ <= other.index_; }
+        bool operator>=(const BasicIterator& other) const noexcept { return index_ >= other.index_; }
+
+    private:
+        template <typename, typename>
+        friend class BasicIterator;
+
+        Owner* owner_ = nullptr;
+        size_t index_ = 0;
+    };
+
+    WordStorage words_;
+    size_t size_ = 0;
+};
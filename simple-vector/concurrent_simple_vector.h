@@ -0,0 +1,363 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "relocation.h"
+#include "simple_vector.h"
+
+// Вектор, в который можно добавлять элементы из многих потоков без блокировок.
+//
+// Слот под новый элемент резервируется одним fetch_add по размеру. Элементы лежат
+// в сегментах, размер которых удваивается: сегмент k вмещает kFirstSegmentSize << k
+// элементов. Сегменты никогда не перевыделяются, поэтому ссылки и указатели на элементы
+// остаются действительными, пока вектор жив, а рост не останавливает других писателей.
+// Сегмент выделяет тот поток, которому он понадобился первым; одновременные попытки
+// разрешаются через compare_exchange.
+//
+// Правила использования:
+//  - PushBack/EmplaceBack/operator[] можно вызывать одновременно из разных потоков.
+//    Читатель может обращаться к элементу, только если запись элемента произошла раньше
+//    чтения (например, индекс получен от писателя через синхронизацию или писатели
+//    уже завершились). GetSize() считает зарезервированные слоты, а не готовые элементы.
+//  - Clear, Freeze и разрушение требуют, чтобы других обращений не было. Вектор не
+//    копируется и не перемещается: адреса элементов и сегментов должны оставаться прежними.
+//  - Allocator должен быть потокобезопасным (std::allocator подходит,
+//    std::pmr::monotonic_buffer_resource - нет).
+//  - Новый элемент сначала создаётся вне вектора и лишь потом перемещается в слот,
+//    поэтому Type обязан перемещаться без исключений. Иначе исключение оставило бы
+//    в векторе дыру. Нехватка памяти под сегмент приводит к std::terminate по той же причине
+template <typename Type, typename Allocator = std::allocator<Type>>
+class ConcurrentSimpleVector {
+    static_assert(std::is_nothrow_move_constructible_v<Type>,
+                  "ConcurrentSimpleVector requires a nothrow move constructor");
+    using AllocTraits = std::allocator_traits<Allocator>;
+
+    template <typename Owner, typename Value>
+    class BasicIterator;
+
+public:
+    using Iterator = BasicIterator<ConcurrentSimpleVector, Type>;
+    using ConstIterator = BasicIterator<const ConcurrentSimpleVector, const Type>;
+    using AllocatorType = Allocator;
+
+    // Размер первого сегмента, степень двойки
+    static constexpr size_t kFirstSegmentBits = 6;
+    static constexpr size_t kFirstSegmentSize = size_t{1} << kFirstSegmentBits;
+    static constexpr size_t kMaxSegments = sizeof(size_t) * 8 - kFirstSegmentBits;
+
+    ConcurrentSimpleVector() noexcept = default;
+
+    explicit ConcurrentSimpleVector(const Allocator& alloc) noexcept
+    : alloc_(alloc)
+    {}
+
+    ConcurrentSimpleVector(const ConcurrentSimpleVector&) = delete;
+    ConcurrentSimpleVector& operator=(const ConcurrentSimpleVector&) = delete;
+
+    ~ConcurrentSimpleVector()
+    {
+        Clear();
+        for(size_t segment = 0; segment < kMaxSegments; ++segment)
+        {
+            Type* data = segments_[segment].load(std::memory_order_relaxed);
+            if(data != nullptr)
+            {
+                AllocTraits::deallocate(alloc_, data, SegmentSize(segment));
+            }
+        }
+    }
+
+    // Создаёт элемент в конце вектора. Безопасно вызывать из нескольких потоков
+    // Возвращает ссылку на созданный элемент, она не инвалидируется ростом вектора
+    template <typename... Args>
+    Type& EmplaceBack(Args&&... args)
+    {
+        Type value(std::forward<Args>(args)...);
+        const size_t index = size_.fetch_add(1, std::memory_order_relaxed);
+        Type* slot = SegmentFor(index) + OffsetInSegment(index);
+        ConstructAt(alloc_, slot, std::move(value));
+        return *slot;
+    }
+
+    void PushBack(const Type& element)
+    {
+        EmplaceBack(element);
+    }
+
+    void PushBack(Type&& element)
+    {
+        EmplaceBack(std::move(element));
+    }
+
+    // Заранее выделяет сегменты, покрывающие capacity элементов
+    void Reserve(size_t capacity)
+    {
+        if(capacity == 0)
+        {
+            return;
+        }
+        const size_t last_segment = SegmentOf(capacity - 1);
+        for(size_t segment = 0; segment <= last_segment; ++segment)
+        {
+            EnsureSegment(segment);
+        }
+    }
+
+    // Возвращает число зарезервированных слотов
+    size_t GetSize() const noexcept
+    {
+        return size_.load(std::memory_order_acquire);
+    }
+
+    // Возвращает суммарную вместимость выделенных сегментов
+    size_t GetCapacity() const noexcept
+    {
+        size_t capacity = 0;
+        for(size_t segment = 0; segment < kMaxSegments; ++segment)
+        {
+            if(segments_[segment].load(std::memory_order_acquire) != nullptr)
+            {
+                capacity += SegmentSize(segment);
+            }
+        }
+        return capacity;
+    }
+
+    bool IsEmpty() const noexcept
+    {
+        return GetSize() == 0;
+    }
+
+    Type& operator[](size_t index) noexcept
+    {
+        assert(index < GetSize());
+        return segments_[SegmentOf(index)].load(std::memory_order_acquire)[OffsetInSegment(index)];
+    }
+
+    const Type& operator[](size_t index) const noexcept
+    {
+        assert(index < GetSize());
+        return segments_[SegmentOf(index)].load(std::memory_order_acquire)[OffsetInSegment(index)];
+    }
+
+    // Выбрасывает исключение std::out_of_range, если index >= size
+    Type& At(size_t index)
+    {
+        if(index >= GetSize())
+        {
+            throw std::out_of_range("Index is out of range");
+        }
+        return (*this)[index];
+    }
+
+    const Type& At(size_t index) const
+    {
+        if(index >= GetSize())
+        {
+            throw std::out_of_range("Index is out of range");
+        }
+        return (*this)[index];
+    }
+
+    // Разрушает элементы, сохраняя выделенные сегменты. Не потокобезопасно
+    void Clear() noexcept
+    {
+        ForEachSegment([this](Type* first, Type* last) {
+            DestroyRange(alloc_, first, last);
+        });
+        size_.store(0, std::memory_order_relaxed);
+    }
+
+    // Переносит элементы в непрерывный SimpleVector и опустошает этот вектор.
+    // Вызывается, когда писатели завершились. Сегменты остаются для повторного заполнения
+    SimpleVector<Type, Allocator> Freeze()
+    {
+        SimpleVector<Type, Allocator> result(alloc_);
+        result.Reserve(GetSize());
+        ForEachSegment([this, &result](Type* first, Type* last) {
+            result.Append(std::make_move_iterator(first), std::make_move_iterator(last));
+            DestroyRange(alloc_, first, last);
+        });
+        size_.store(0, std::memory_order_relaxed);
+        return result;
+    }
+
+    Iterator begin() noexcept
+    {
+        return Iterator(this, 0);
+    }
+
+    Iterator end() noexcept
+    {
+        return Iterator(this, GetSize());
+    }
+
+    ConstIterator begin() const noexcept
+    {
+        return ConstIterator(this, 0);
+    }
+
+    ConstIterator end() const noexcept
+    {
+        return ConstIterator(this, GetSize());
+    }
+
+    ConstIterator cbegin() const noexcept
+    {
+        return begin();
+    }
+
+    ConstIterator cend() const noexcept
+    {
+        return end();
+    }
+
+private:
+    static size_t FloorLog2(size_t value) noexcept
+    {
+        assert(value != 0);
+#if defined(__GNUC__) || defined(__clang__)
+        return sizeof(unsigned long long) * 8 - 1 - static_cast<size_t>(__builtin_clzll(value));
+#else
+        size_t result = 0;
+        while(value >>= 1)
+        {
+            ++result;
+        }
+        return result;
+#endif
+    }
+
+    // Индексы [kFirst * (2^k - 1), kFirst * (2^(k+1) - 1)) лежат в сегменте k
+    static size_t SegmentOf(size_t index) noexcept
+    {
+        return FloorLog2(index + kFirstSegmentSize) - kFirstSegmentBits;
+    }
+
+    static size_t SegmentStart(size_t segment) noexcept
+    {
+        return (kFirstSegmentSize << segment) - kFirstSegmentSize;
+    }
+
+    static size_t SegmentSize(size_t segment) noexcept
+    {
+        return kFirstSegmentSize << segment;
+    }
+
+    static size_t OffsetInSegment(size_t index) noexcept
+    {
+        return index - SegmentStart(SegmentOf(index));
+    }
+
+    // Быстрый путь: сегмент уже выделен, и всё обращение - одна атомарная загрузка
+    Type* SegmentFor(size_t index) noexcept
+    {
+        const size_t segment = SegmentOf(index);
+        Type* data = segments_[segment].load(std::memory_order_acquire);
+        if(data != nullptr)
+        {
+            return data;
+        }
+        return EnsureSegment(segment);
+    }
+
+    // Выделяет сегмент, если его ещё нет. Проигравший гонку поток освобождает свою память
+    Type* EnsureSegment(size_t segment) noexcept
+    {
+        Type* data = segments_[segment].load(std::memory_order_acquire);
+        if(data != nullptr)
+        {
+            return data;
+        }
+        Type* fresh = AllocTraits::allocate(alloc_, SegmentSize(segment));
+        if(segments_[segment].compare_exchange_strong(data, fresh, std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            return fresh;
+        }
+        AllocTraits::deallocate(alloc_, fresh, SegmentSize(segment));
+        return data;
+    }
+
+    // Вызывает f(first, last) для заполненной части каждого сегмента
+    template <typename F>
+    void ForEachSegment(F f)
+    {
+        const size_t size = size_.load(std::memory_order_acquire);
+        for(size_t segment = 0; segment < kMaxSegments && SegmentStart(segment) < size; ++segment)
+        {
+            Type* data = segments_[segment].load(std::memory_order_acquire);
+            const size_t count = std::min(SegmentSize(segment), size - SegmentStart(segment));
+            f(data, data + count);
+        }
+    }
+
+    // Итератор произвольного доступа по индексу. Ростом вектора не инвалидируется
+    template <typename Owner, typename Value>
+    class BasicIterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = std::remove_const_t<Value>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Value*;
+        using reference = Value&;
+
+        BasicIterator() = default;
+
+        BasicIterator(Owner* owner, size_t index) noexcept
+        : owner_(owner)
+        , index_(index)
+        {}
+
+        // Неконстантный итератор приводится к константному
+        template <typename OtherOwner, typename OtherValue,
+                  typename = std::enable_if_t<std::is_convertible_v<OtherValue*, Value*>>>
+        BasicIterator(const BasicIterator<OtherOwner, OtherValue>& other) noexcept
+        : owner_(other.owner_)
+        , index_(other.index_)
+        {}
+
+        reference operator*() const noexcept { return (*owner_)[index_]; }
+        pointer operator->() const noexcept { return &(*owner_)[index_]; }
+        reference operator[](difference_type n) const noexcept { return (*owner_)[index_ + n]; }
+
+        BasicIterator& operator++() noexcept { ++index_; return *this; }
+        BasicIterator operator++(int) noexcept { BasicIterator old = *this; ++index_; return old; }
+        BasicIterator& operator--() noexcept { --index_; return *this; }
+        BasicIterator operator--(int) noexcept { BasicIterator old = *this; --index_; return old; }
+        BasicIterator& operator+=(difference_type n) noexcept { index_ += n; return *this; }
+        BasicIterator& operator-=(difference_type n) noexcept { index_ -= n; return *this; }
+        BasicIterator operator+(difference_type n) const noexcept { return BasicIterator(owner_, index_ + n); }
+        BasicIterator operator-(difference_type n) const noexcept { return BasicIterator(owner_, index_ - n); }
+        friend BasicIterator operator+(difference_type n, const BasicIterator& it) noexcept { return it + n; }
+        difference_type operator-(const BasicIterator& other) const noexcept
+        {
+            return static_cast<difference_type>(index_) - static_cast<difference_type>(other.index_);
+        }
+
+        bool operator==(const BasicIterator& other) const noexcept { return index_ == other.index_; }
+        bool operator!=(const BasicIterator& other) const noexcept { return index_ != other.index_; }
+        bool operator<(const BasicIterator& other) const noexcept { return index_ < other.index_; }
+        bool operator>(const BasicIterator& other) const noexcept { return index_ > other.index_; }
+        bool operator<=(const BasicIterator& other) const noexcept { return index_ <= other.index_; }
+        bool operator>=(const BasicIterator& other) const noexcept { return index_ >= other.index_; }
+
+    private:
+        template <typename, typename>
+        friend class BasicIterator;
+
+        Owner* owner_ = nullptr;
+        size_t index_ = 0;
+    };
+
+    std::atomic<Type*> segments_[kMaxSegments] = {};
+    // Счётчик, по которому бьют все писатели, живёт в своей кеш-линии,
+    // чтобы не выбивать из кешей читателей таблицу сегментов
+    alignas(64) std::atomic<size_t> size_ = 0;
+    [[no_unique_address]] Allocator alloc_;
+};
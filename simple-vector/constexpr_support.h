@@ -0,0 +1,26 @@
+#pragma once
+
+#include <type_traits>
+
+// SimpleVector и его алгоритмы можно вызывать при вычислении констант, если компилятор
+// поддерживает выделение памяти в constexpr (C++20): вектор, созданный внутри
+// constexpr-функции, живёт до её конца. На C++17 макрос пуст и всё работает как раньше
+#if defined(__cpp_constexpr_dynamic_alloc) && defined(__cpp_lib_constexpr_dynamic_alloc) \
+    && defined(__cpp_lib_is_constant_evaluated)
+#define SIMPLE_VECTOR_CONSTEXPR constexpr
+#define SIMPLE_VECTOR_HAS_CONSTEXPR 1
+#else
+#define SIMPLE_VECTOR_CONSTEXPR
+#define SIMPLE_VECTOR_HAS_CONSTEXPR 0
+#endif
+
+// Истинно при вычислении константы. Быстрые пути на memcpy, memcmp и векторных
+// инструкциях там недоступны, и алгоритмы переходят на обычные циклы
+constexpr bool IsConstantEvaluated() noexcept
+{
+#if defined(__cpp_lib_is_constant_evaluated)
+    return std::is_constant_evaluated();
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,582 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "simple_vector.h"
+
+// Ассоциативные контейнеры поверх отсортированных SimpleVector. Ключи лежат подряд
+// в одном массиве, поэтому поиск не ходит по указателям и не промахивается мимо кеша
+// на каждом узле, а запись не выделяет память под узел. Вставка и удаление по одному
+// элементу сдвигают хвост за O(n), так что контейнеры рассчитаны на таблицы, которые
+// строятся целиком или пачками (InsertMany) и затем в основном читаются
+
+namespace flat_detail {
+
+// Первый элемент [first, first + count), не меньший key. Цикл без ветвлений:
+// сравнение превращается в условную пересылку, и процессору нечего предсказывать.
+// Для больших массивов заранее подгружаются обе половины следующего шага
+template <typename T, typename K, typename Compare>
+const T* LowerBound(const T* first, size_t count, const K& key, const Compare& comp)
+{
+    if(count == 0)
+    {
+        return first;
+    }
+    while(count > 1)
+    {
+        const size_t half = count / 2;
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(first + half / 2);
+        __builtin_prefetch(first + half + half / 2);
+#endif
+        first = comp(first[half - 1], key) ? first + half : first;
+        count -= half;
+    }
+    return first + (comp(*first, key) ? 1 : 0);
+}
+
+// Сортирует items по проекции proj и оставляет из равных первый по исходному порядку
+template <typename Vector, typename Compare, typename Projection>
+void SortUnique(Vector& items, const Compare& comp, Projection proj)
+{
+    auto less = [&](const auto& lhs, const auto& rhs) { return comp(proj(lhs), proj(rhs)); };
+    std::stable_sort(items.begin(), items.end(), less);
+    auto last = std::unique(items.begin(), items.end(), [&](const auto& lhs, const auto& rhs) {
+        return !less(lhs, rhs);
+    });
+    items.Erase(last, items.end());
+}
+
+} // namespace flat_detail
+
+// Множество уникальных ключей в отсортированном SimpleVector
+template <typename Key, typename Compare = std::less<Key>, typename Allocator = std::allocator<Key>>
+class FlatSet {
+public:
+    using Storage = SimpleVector<Key, Allocator>;
+    using ConstIterator = const Key*;
+    using Iterator = ConstIterator;
+
+    FlatSet() = default;
+
+    explicit FlatSet(const Compare& comp, const Allocator& alloc = Allocator())
+    : keys_(alloc)
+    , comp_(comp)
+    {}
+
+    // Строит множество из произвольного набора ключей: одна сортировка и удаление
+    // повторов вместо вставки по одному
+    template <typename InputIt, typename = std::enable_if_t<kIsIteratorOf<InputIt, std::input_iterator_tag>>>
+    FlatSet(InputIt first, InputIt last, const Compare& comp = Compare(), const Allocator& alloc = Allocator())
+    : keys_(first, last, alloc)
+    , comp_(comp)
+    {
+        flat_detail::SortUnique(keys_, comp_, [](const Key& key) -> const Key& { return key; });
+    }
+
+    FlatSet(std::initializer_list<Key> init, const Compare& comp = Compare(), const Allocator& alloc = Allocator())
+    : FlatSet(init.begin(), init.end(), comp, alloc)
+    {}
+
+    // Забирает ключи без копирования и сортирует их на месте
+    explicit FlatSet(Storage&& keys, const Compare& comp = Compare())
+    : keys_(std::move(keys))
+    , comp_(comp)
+    {
+        flat_detail::SortUnique(keys_, comp_, [](const Key& key) -> const Key& { return key; });
+    }
+
+    size_t GetSize() const noexcept
+    {
+        return keys_.GetSize();
+    }
+
+    bool IsEmpty() const noexcept
+    {
+        return keys_.IsEmpty();
+    }
+
+    void Reserve(size_t capacity)
+    {
+        keys_.Reserve(capacity);
+    }
+
+    void Clear() noexcept
+    {
+        keys_.Clear();
+    }
+
+    // Ключи по возрастанию
+    const Storage& Keys() const noexcept
+    {
+        return keys_;
+    }
+
+    ConstIterator begin() const noexcept
+    {
+        return keys_.Data();
+    }
+
+    ConstIterator end() const noexcept
+    {
+        return keys_.Data() + keys_.GetSize();
+    }
+
+    ConstIterator LowerBound(const Key& key) const
+    {
+        return flat_detail::LowerBound(keys_.Data(), keys_.GetSize(), key, comp_);
+    }
+
+    ConstIterator UpperBound(const Key& key) const
+    {
+        return std::upper_bound(begin(), end(), key, comp_);
+    }
+
+    ConstIterator Find(const Key& key) const
+    {
+        ConstIterator it = LowerBound(key);
+        return it != end() && !comp_(key, *it) ? it : end();
+    }
+
+    bool Contains(const Key& key) const
+    {
+        return Find(key) != end();
+    }
+
+    size_t Count(const Key& key) const
+    {
+        return Contains(key) ? 1 : 0;
+    }
+
+    // Вставляет ключ, если его ещё нет. Возвращает позицию ключа и признак вставки
+    std::pair<ConstIterator, bool> Insert(Key key)
+    {
+        ConstIterator it = LowerBound(key);
+        if(it != end() && !comp_(key, *it))
+        {
+            return {it, false};
+        }
+        const auto index = static_cast<size_t>(it - begin());
+        keys_.Insert(keys_.cbegin() + index, std::move(key));
+        return {begin() + index, true};
+    }
+
+    // Добавляет пачку ключей слиянием: пачка сортируется отдельно, а затем за один
+    // проход сливается с уже имеющимися ключами в новый массив. Ключи, которые уже
+    // есть в множестве, остаются прежними
+    template <typename InputIt, typename = std::enable_if_t<kIsIteratorOf<InputIt, std::input_iterator_tag>>>
+    void InsertMany(InputIt first, InputIt last)
+    {
+        Storage batch(first, last, keys_.GetAllocator());
+        flat_detail::SortUnique(batch, comp_, [](const Key& key) -> const Key& { return key; });
+        if(batch.IsEmpty())
+        {
+            return;
+        }
+        Storage merged(keys_.GetAllocator());
+        merged.Reserve(keys_.GetSize() + batch.GetSize());
+        size_t i = 0;
+        size_t j = 0;
+        while(i < keys_.GetSize() && j < batch.GetSize())
+        {
+            if(comp_(batch[j], keys_[i]))
+            {
+                merged.PushBack(std::move(batch[j++]));
+            }
+            else
+            {
+                j += comp_(keys_[i], batch[j]) ? 0 : 1;
+                merged.PushBack(std::move(keys_[i++]));
+            }
+        }
+        merged.Append(std::make_move_iterator(keys_.begin() + i), std::make_move_iterator(keys_.end()));
+        merged.Append(std::make_move_iterator(batch.begin() + j), std::make_move_iterator(batch.end()));
+        keys_ = std::move(merged);
+    }
+
+    void InsertMany(std::initializer_list<Key> init)
+    {
+        InsertMany(init.begin(), init.end());
+    }
+
+    // Удаляет ключ и возвращает число удалённых (0 или 1)
+    size_t Erase(const Key& key)
+    {
+        ConstIterator it = Find(key);
+        if(it == end())
+        {
+            return 0;
+        }
+        keys_.Erase(keys_.cbegin() + (it - begin()));
+        return 1;
+    }
+
+    ConstIterator Erase(ConstIterator pos)
+    {
+        const auto index = static_cast<size_t>(pos - begin());
+        keys_.Erase(keys_.cbegin() + index);
+        return begin() + index;
+    }
+
+    friend bool operator==(const FlatSet& lhs, const FlatSet& rhs)
+    {
+        return lhs.keys_ == rhs.keys_;
+    }
+
+    friend bool operator!=(const FlatSet& lhs, const FlatSet& rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+private:
+    Storage keys_;
+    [[no_unique_address]] Compare comp_;
+};
+
+// Отображение в двух отсортированных SimpleVector: ключи отдельно от значений.
+// Поиск читает только массив ключей, так что большие значения его не замедляют.
+// Итератор - индекс в обоих массивах; разыменование даёт пару ссылок
+// std::pair<const Key&, Value&>, которую удобно разбирать structured binding
+template <typename Key, typename Value, typename Compare = std::less<Key>,
+          typename KeyAllocator = std::allocator<Key>, typename ValueAllocator = std::allocator<Value>>
+class FlatMap {
+    template <typename Owner, typename MappedRef>
+    class BasicIterator;
+
+public:
+    using KeyStorage = SimpleVector<Key, KeyAllocator>;
+    using ValueStorage = SimpleVector<Value, ValueAllocator>;
+    using Iterator = BasicIterator<FlatMap, Value&>;
+    using ConstIterator = BasicIterator<const FlatMap, const Value&>;
+
+    FlatMap() = default;
+
+    explicit FlatMap(const Compare& comp)
+    : comp_(comp)
+    {}
+
+    // Строит отображение из набора пар: одна сортировка и удаление повторов.
+    // Из пар с равными ключами остаётся первая, как при вставке по одной
+    template <typename InputIt, typename = std::enable_if_t<kIsIteratorOf<InputIt, std::input_iterator_tag>>>
+    FlatMap(InputIt first, InputIt last, const Compare& comp = Compare())
+    : comp_(comp)
+    {
+        SimpleVector<std::pair<Key, Value>> entries(first, last);
+        flat_detail::SortUnique(entries, comp_, [](const auto& entry) -> const Key& { return entry.first; });
+        keys_.Reserve(entries.GetSize());
+        values_.Reserve(entries.GetSize());
+        for(auto& [key, value] : entries)
+        {
+            keys_.PushBack(std::move(key));
+            values_.PushBack(std::move(value));
+        }
+    }
+
+    FlatMap(std::initializer_list<std::pair<Key, Value>> init, const Compare& comp = Compare())
+    : FlatMap(init.begin(), init.end(), comp)
+    {}
+
+    size_t GetSize() const noexcept
+    {
+        return keys_.GetSize();
+    }
+
+    bool IsEmpty() const noexcept
+    {
+        return keys_.IsEmpty();
+    }
+
+    void Reserve(size_t capacity)
+    {
+        keys_.Reserve(capacity);
+        values_.Reserve(capacity);
+    }
+
+    void Clear() noexcept
+    {
+        keys_.Clear();
+        values_.Clear();
+    }
+
+    // Ключи по возрастанию и значения в том же порядке
+    const KeyStorage& Keys() const noexcept
+    {
+        return keys_;
+    }
+
+    const ValueStorage& Values() const noexcept
+    {
+        return values_;
+    }
+
+    Iterator begin() noexcept
+    {
+        return Iterator(this, 0);
+    }
+
+    Iterator end() noexcept
+    {
+        return Iterator(this, GetSize());
+    }
+
+    ConstIterator begin() const noexcept
+    {
+        return ConstIterator(this, 0);
+    }
+
+    ConstIterator end() const noexcept
+    {
+        return ConstIterator(this, GetSize());
+    }
+
+    Iterator LowerBound(const Key& key)
+    {
+        return Iterator(this, LowerIndex(key));
+    }
+
+    ConstIterator LowerBound(const Key& key) const
+    {
+        return ConstIterator(this, LowerIndex(key));
+    }
+
+    Iterator Find(const Key& key)
+    {
+        return Iterator(this, FindIndex(key));
+    }
+
+    ConstIterator Find(const Key& key) const
+    {
+        return ConstIterator(this, FindIndex(key));
+    }
+
+    bool Contains(const Key& key) const
+    {
+        return FindIndex(key) != GetSize();
+    }
+
+    size_t Count(const Key& key) const
+    {
+        return Contains(key) ? 1 : 0;
+    }
+
+    // Выбрасывает исключение std::out_of_range, если ключа нет
+    Value& At(const Key& key)
+    {
+        return values_[CheckedIndex(key)];
+    }
+
+    const Value& At(const Key& key) const
+    {
+        return values_[CheckedIndex(key)];
+    }
+
+    // Значение по ключу; если ключа нет, вставляет значение по умолчанию
+    Value& operator[](const Key& key)
+    {
+        return Emplace(key).first.GetValue();
+    }
+
+    // Вставляет пару, если ключа ещё нет. Возвращает позицию ключа и признак вставки
+    template <typename... Args>
+    std::pair<Iterator, bool> Emplace(const Key& key, Args&&... args)
+    {
+        const size_t index = LowerIndex(key);
+        if(index != GetSize() && !comp_(key, keys_[index]))
+        {
+            return {Iterator(this, index), false};
+        }
+        values_.Emplace(values_.begin() + index, std::forward<Args>(args)...);
+        try
+        {
+            keys_.Insert(keys_.begin() + index, key);
+        }
+        catch(...)
+        {
+            values_.Erase(values_.begin() + index);
+            throw;
+        }
+        return {Iterator(this, index), true};
+    }
+
+    std::pair<Iterator, bool> Insert(const Key& key, Value value)
+    {
+        return Emplace(key, std::move(value));
+    }
+
+    // Добавляет пачку пар слиянием: пачка сортируется отдельно и за один проход
+    // сливается с имеющимися парами в новые массивы. Ключи, которые уже есть
+    // в отображении, сохраняют прежние значения
+    template <typename InputIt, typename = std::enable_if_t<kIsIteratorOf<InputIt, std::input_iterator_tag>>>
+    void InsertMany(InputIt first, InputIt last)
+    {
+        SimpleVector<std::pair<Key, Value>> batch(first, last);
+        flat_detail::SortUnique(batch, comp_, [](const auto& entry) -> const Key& { return entry.first; });
+        if(batch.IsEmpty())
+        {
+            return;
+        }
+        KeyStorage keys(keys_.GetAllocator());
+        ValueStorage values(values_.GetAllocator());
+        keys.Reserve(keys_.GetSize() + batch.GetSize());
+        values.Reserve(keys_.GetSize() + batch.GetSize());
+        size_t i = 0;
+        size_t j = 0;
+        while(i < keys_.GetSize() || j < batch.GetSize())
+        {
+            const bool take_batch = i == keys_.GetSize()
+                || (j < batch.GetSize() && comp_(batch[j].first, keys_[i]));
+            if(take_batch)
+            {
+                keys.PushBack(std::move(batch[j].first));
+                values.PushBack(std::move(batch[j].second));
+                ++j;
+                continue;
+            }
+            if(j < batch.GetSize() && !comp_(keys_[i], batch[j].first))
+            {
+                ++j;
+            }
+            keys.PushBack(std::move(keys_[i]));
+            values.PushBack(std::move(values_[i]));
+            ++i;
+        }
+        keys_ = std::move(keys);
+        values_ = std::move(values);
+    }
+
+    void InsertMany(std::initializer_list<std::pair<Key, Value>> init)
+    {
+        InsertMany(init.begin(), init.end());
+    }
+
+    // Удаляет пару и возвращает число удалённых (0 или 1)
+    size_t Erase(const Key& key)
+    {
+        const size_t index = FindIndex(key);
+        if(index == GetSize())
+        {
+            return 0;
+        }
+        EraseAt(index);
+        return 1;
+    }
+
+    Iterator Erase(ConstIterator pos)
+    {
+        EraseAt(pos.index_);
+        return Iterator(this, pos.index_);
+    }
+
+    friend bool operator==(const FlatMap& lhs, const FlatMap& rhs)
+    {
+        return lhs.keys_ == rhs.keys_ && lhs.values_ == rhs.values_;
+    }
+
+    friend bool operator!=(const FlatMap& lhs, const FlatMap& rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+private:
+    size_t LowerIndex(const Key& key) const
+    {
+        return static_cast<size_t>(flat_detail::LowerBound(keys_.Data(), keys_.GetSize(), key, comp_) - keys_.Data());
+    }
+
+    // Индекс ключа или GetSize(), если его нет
+    size_t FindIndex(const Key& key) const
+    {
+        const size_t index = LowerIndex(key);
+        return index != GetSize() && !comp_(key, keys_[index]) ? index : GetSize();
+    }
+
+    size_t CheckedIndex(const Key& key) const
+    {
+        const size_t index = FindIndex(key);
+        if(index == GetSize())
+        {
+            throw std::out_of_range("Key is not found");
+        }
+        return index;
+    }
+
+    void EraseAt(size_t index)
+    {
+        keys_.Erase(keys_.begin() + index);
+        values_.Erase(values_.begin() + index);
+    }
+
+    // Итератор произвольного доступа по индексу пары
+    template <typename Owner, typename MappedRef>
+    class BasicIterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = std::pair<Key, Value>;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::pair<const Key&, MappedRef>;
+        using pointer = void;
+
+        BasicIterator() = default;
+
+        BasicIterator(Owner* owner, size_t index) noexcept
+        : owner_(owner)
+        , index_(index)
+        {}
+
+        // Неконстантный итератор приводится к константному
+        template <typename OtherOwner, typename OtherRef,
+                  typename = std::enable_if_t<std::is_convertible_v<OtherOwner*, Owner*>>>
+        BasicIterator(const BasicIterator<OtherOwner, OtherRef>& other) noexcept
+        : owner_(other.owner_)
+        , index_(other.index_)
+        {}
+
+        const Key& GetKey() const noexcept { return owner_->keys_[index_]; }
+        MappedRef GetValue() const noexcept { return owner_->values_[index_]; }
+
+        reference operator*() const noexcept { return reference(GetKey(), GetValue()); }
+        reference operator[](difference_type n) const noexcept { return *(*this + n); }
+
+        BasicIterator& operator++() noexcept { ++index_; return *this; }
+        BasicIterator operator++(int) noexcept { BasicIterator old = *this; ++index_; return old; }
+        BasicIterator& operator--() noexcept { --index_; return *this; }
+        BasicIterator operator--(int) noexcept { BasicIterator old = *this; --index_; return old; }
+        BasicIterator& operator+=(difference_type n) noexcept { index_ += n; return *this; }
+        BasicIterator& operator-=(difference_type n) noexcept { index_ -= n; return *this; }
+        BasicIterator operator+(difference_type n) const noexcept { return BasicIterator(owner_, index_ + n); }
+        BasicIterator operator-(difference_type n) const noexcept { return BasicIterator(owner_, index_ - n); }
+        friend BasicIterator operator+(difference_type n, const BasicIterator& it) noexcept { return it + n; }
+        difference_type operator-(const BasicIterator& other) const noexcept
+        {
+            return static_cast<difference_type>(index_) - static_cast<difference_type>(other.index_);
+        }
+
+        bool operator==(const BasicIterator& other) const noexcept { return index_ == other.index_; }
+        bool operator!=(const BasicIterator& other) const noexcept { return index_ != other.index_; }
+        bool operator<(const BasicIterator& other) const noexcept { return index_ < other.index_; }
+        bool operator>(const BasicIterator& other) const noexcept { return index_ > other.index_; }
+        bool operator<=(const BasicIterator& other) const noexcept { return index_ <= other.index_; }
+        bool operator>=(const BasicIterator& other) const noexcept { return index_ >= other.index_; }
+
+    private:
+        friend class FlatMap;
+
+        template <typename, typename>
+        friend class BasicIterator;
+
+        Owner* owner_ = nullptr;
+        size_t index_ = 0;
+    };
+
+    KeyStorage keys_;
+    ValueStorage values_;
+    [[no_unique_address]] Compare comp_;
+};
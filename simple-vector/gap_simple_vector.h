@@ -0,0 +1,678 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "array_ptr.h"
+#include "growth_policy.h"
+#include "relocation.h"
+#include "simd_kernels.h"
+
+// Вектор с разрывом (gap buffer): свободные ячейки буфера лежат не в конце, а в разрыве
+// в позиции последней правки. Элементы [0, gap) хранятся в начале буфера, остальные -
+// в его конце. Вставка и удаление в позиции разрыва - O(1), а чтобы править в другом
+// месте, разрыв сначала переезжает туда, перенося только элементы между старой и новой
+// позицией. Серия правок вокруг курсора, как в текстовом редакторе, стоит расстояния,
+// на которое сдвинулся курсор, а не длины хвоста, как SimpleVector::Insert и Erase.
+//
+// Доступ по индексу - одно сравнение с позицией разрыва. Элементы лежат двумя
+// непрерывными кусками, которые отдаёт ForEachBlock. Итераторы хранят вектор и индекс
+template <typename Type, typename Allocator = std::allocator<Type>>
+class GapSimpleVector {
+    using AllocTraits = std::allocator_traits<Allocator>;
+
+    template <typename Owner, typename Value>
+    class BasicIterator;
+
+public:
+    using Iterator = BasicIterator<GapSimpleVector, Type>;
+    using ConstIterator = BasicIterator<const GapSimpleVector, const Type>;
+    using AllocatorType = Allocator;
+
+    GapSimpleVector() noexcept = default;
+
+    explicit GapSimpleVector(const Allocator& alloc) noexcept
+    : buffer_(alloc)
+    {}
+
+    // Создаёт вектор из size элементов, инициализированных значением по умолчанию
+    explicit GapSimpleVector(size_t size, const Allocator& alloc = Allocator())
+    : buffer_(size, alloc)
+    {
+        UninitializedValueConstructN(buffer_.GetAllocator(), buffer_.GetRawPtr(), size);
+        gap_begin_ = gap_end_ = size;
+    }
+
+    GapSimpleVector(size_t size, const Type& value, const Allocator& alloc = Allocator())
+    : buffer_(size, alloc)
+    {
+        UninitializedFillN(buffer_.GetAllocator(), buffer_.GetRawPtr(), size, value);
+        gap_begin_ = gap_end_ = size;
+    }
+
+    GapSimpleVector(std::initializer_list<Type> init, const Allocator& alloc = Allocator())
+    : buffer_(init.size(), alloc)
+    {
+        UninitializedCopy(buffer_.GetAllocator(), init.begin(), init.end(), buffer_.GetRawPtr());
+        gap_begin_ = gap_end_ = init.size();
+    }
+
+    // Копия собирает оба куска подряд, разрыв остаётся в конце
+    GapSimpleVector(const GapSimpleVector& other)
+    : GapSimpleVector(other, AllocTraits::select_on_container_copy_construction(other.buffer_.GetAllocator()))
+    {}
+
+    // Копирует other, выделяя память через alloc
+    GapSimpleVector(const GapSimpleVector& other, const Allocator& alloc)
+    : buffer_(other.GetSize(), alloc)
+    {
+        ConstructFrom(other, [](Type* element) { return element; });
+    }
+
+    GapSimpleVector(GapSimpleVector&& other) noexcept
+    : buffer_(std::move(other.buffer_))
+    , gap_begin_(std::exchange(other.gap_begin_, 0))
+    , gap_end_(std::exchange(other.gap_end_, 0))
+    {}
+
+    // Перемещает other в вектор с аллокатором alloc. Если аллокаторы не равны,
+    // буфер забрать нельзя, и элементы переносятся по одному
+    GapSimpleVector(GapSimpleVector&& other, const Allocator& alloc)
+    : buffer_(alloc == other.buffer_.GetAllocator() ? 0 : other.GetSize(), alloc)
+    {
+        if(alloc == other.buffer_.GetAllocator())
+        {
+            StealFrom(other);
+            return;
+        }
+        ConstructFrom(other, [](Type* element) { return std::make_move_iterator(element); });
+    }
+
+    GapSimpleVector& operator=(const GapSimpleVector& rhs)
+    {
+        if(this != &rhs)
+        {
+            // Копия строится сразу нужным аллокатором, а затем забирается перемещением
+            GapSimpleVector copy(rhs, AllocTraits::propagate_on_container_copy_assignment::value
+                                          ? rhs.buffer_.GetAllocator()
+                                          : buffer_.GetAllocator());
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    GapSimpleVector& operator=(GapSimpleVector&& rhs) noexcept(AllocTraits::propagate_on_container_move_assignment::value
+                                                               || AllocTraits::is_always_equal::value)
+    {
+        if(this == &rhs)
+        {
+            return *this;
+        }
+        if constexpr (AllocTraits::propagate_on_container_move_assignment::value || AllocTraits::is_always_equal::value)
+        {
+            StealFrom(rhs);
+        }
+        else if(buffer_.GetAllocator() == rhs.buffer_.GetAllocator())
+        {
+            StealFrom(rhs);
+        }
+        else
+        {
+            // Буфер rhs освобождается чужим ресурсом, поэтому элементы переносятся в наш
+            GapSimpleVector temp(std::move(rhs), buffer_.GetAllocator());
+            StealFrom(temp);
+        }
+        return *this;
+    }
+
+    ~GapSimpleVector()
+    {
+        Clear();
+    }
+
+    // Если аллокатор не переезжает при обмене, аллокаторы векторов должны быть равны
+    void swap(GapSimpleVector& other) noexcept
+    {
+        buffer_.swap(other.buffer_);
+        std::swap(gap_begin_, other.gap_begin_);
+        std::swap(gap_end_, other.gap_end_);
+    }
+
+    Allocator GetAllocator() const noexcept
+    {
+        return buffer_.GetAllocator();
+    }
+
+    size_t GetSize() const noexcept
+    {
+        return buffer_.GetSize() - (gap_end_ - gap_begin_);
+    }
+
+    size_t GetCapacity() const noexcept
+    {
+        return buffer_.GetSize();
+    }
+
+    bool IsEmpty() const noexcept
+    {
+        return GetSize() == 0;
+    }
+
+    // Индекс, перед которым стоит разрыв: вставка сюда не переносит элементы
+    size_t GetGapPosition() const noexcept
+    {
+        return gap_begin_;
+    }
+
+    Type& operator[](size_t index) noexcept
+    {
+        assert(index < GetSize());
+        return buffer_.GetRawPtr()[index < gap_begin_ ? index : index + (gap_end_ - gap_begin_)];
+    }
+
+    const Type& operator[](size_t index) const noexcept
+    {
+        assert(index < GetSize());
+        return buffer_.GetRawPtr()[index < gap_begin_ ? index : index + (gap_end_ - gap_begin_)];
+    }
+
+    // Выбрасывает исключение std::out_of_range, если index >= size
+    Type& At(size_t index)
+    {
+        if(index >= GetSize())
+        {
+            throw std::out_of_range("Index is out of range");
+        }
+        return (*this)[index];
+    }
+
+    const Type& At(size_t index) const
+    {
+        if(index >= GetSize())
+        {
+            throw std::out_of_range("Index is out of range");
+        }
+        return (*this)[index];
+    }
+
+    // Переносит разрыв перед элементом position, сдвигая элементы между старой и новой
+    // позицией. Последовательность элементов не меняется, так что при исключении
+    // из перемещения вектор остаётся прежним, а разрыв - где успел оказаться
+    void MoveGap(size_t position)
+    {
+        assert(position <= GetSize());
+        if(gap_begin_ == gap_end_)
+        {
+            // Пустой разрыв можно поставить куда угодно, ничего не перенося
+            gap_begin_ = gap_end_ = position;
+            return;
+        }
+        Allocator& alloc = buffer_.GetAllocator();
+        Type* data = buffer_.GetRawPtr();
+        if constexpr (kIsTriviallyRelocatable<Type>)
+        {
+            if(position < gap_begin_)
+            {
+                const size_t count = gap_begin_ - position;
+                RelocateOverlapping(data + position, count, data + gap_end_ - count);
+                gap_begin_ -= count;
+                gap_end_ -= count;
+            }
+            else if(position > gap_begin_)
+            {
+                const size_t count = position - gap_begin_;
+                RelocateOverlapping(data + gap_end_, count, data + gap_begin_);
+                gap_begin_ += count;
+                gap_end_ += count;
+            }
+        }
+        else
+        {
+            // Поэлементно, чтобы разрыв всегда отделял живые элементы от пустых ячеек
+            while(position < gap_begin_)
+            {
+                ConstructAt(alloc, data + gap_end_ - 1, std::move_if_noexcept(data[gap_begin_ - 1]));
+                DestroyAt(alloc, data + gap_begin_ - 1);
+                --gap_begin_;
+                --gap_end_;
+            }
+            while(position > gap_begin_)
+            {
+                ConstructAt(alloc, data + gap_begin_, std::move_if_noexcept(data[gap_end_]));
+                DestroyAt(alloc, data + gap_end_);
+                ++gap_begin_;
+                ++gap_end_;
+            }
+        }
+    }
+
+    // Создаёт элемент перед элементом index. Элемент сначала собирается отдельно, так что
+    // args могут ссылаться на элементы самого вектора. Возвращает ссылку на новый элемент
+    template <typename... Args>
+    Type& Emplace(size_t index, Args&&... args)
+    {
+        assert(index <= GetSize());
+        Type value(std::forward<Args>(args)...);
+        return InsertValue(index, std::move(value));
+    }
+
+    // Элемент самого вектора копируется заранее, остальные создаются сразу на месте
+    Type& Insert(size_t index, const Type& value)
+    {
+        assert(index <= GetSize());
+        if(IsOwnElement(value))
+        {
+            return Emplace(index, value);
+        }
+        return InsertValue(index, value);
+    }
+
+    Type& Insert(size_t index, Type&& value)
+    {
+        assert(index <= GetSize());
+        if(IsOwnElement(value))
+        {
+            return Emplace(index, std::move(value));
+        }
+        return InsertValue(index, std::move(value));
+    }
+
+    // Удаляет элемент index; разрыв остаётся на его месте
+    void Erase(size_t index)
+    {
+        Erase(index, index + 1);
+    }
+
+    // Удаляет элементы [first, last)
+    void Erase(size_t first, size_t last)
+    {
+        assert(first <= last && last <= GetSize());
+        MoveGap(first);
+        const size_t count = last - first;
+        DestroyRange(buffer_.GetAllocator(), buffer_.GetRawPtr() + gap_end_, buffer_.GetRawPtr() + gap_end_ + count);
+        gap_end_ += count;
+    }
+
+    void PushBack(const Type& value)
+    {
+        Insert(GetSize(), value);
+    }
+
+    void PushBack(Type&& value)
+    {
+        Insert(GetSize(), std::move(value));
+    }
+
+    void PushFront(const Type& value)
+    {
+        Insert(0, value);
+    }
+
+    void PushFront(Type&& value)
+    {
+        Insert(0, std::move(value));
+    }
+
+    void PopBack()
+    {
+        assert(!IsEmpty());
+        Erase(GetSize() - 1);
+    }
+
+    void PopFront()
+    {
+        assert(!IsEmpty());
+        Erase(0);
+    }
+
+    // Резервирует место под capacity элементов, не сдвигая разрыв
+    void Reserve(size_t capacity)
+    {
+        if(capacity > GetCapacity())
+        {
+            Reallocate(capacity);
+        }
+    }
+
+    void Clear() noexcept
+    {
+        Allocator& alloc = buffer_.GetAllocator();
+        DestroyRange(alloc, Front(), Front() + gap_begin_);
+        DestroyRange(alloc, Back(), Back() + BackSize());
+        gap_begin_ = 0;
+        gap_end_ = buffer_.GetSize();
+    }
+
+    Iterator begin() noexcept
+    {
+        return Iterator(this, 0);
+    }
+
+    Iterator end() noexcept
+    {
+        return Iterator(this, GetSize());
+    }
+
+    ConstIterator begin() const noexcept
+    {
+        return ConstIterator(this, 0);
+    }
+
+    ConstIterator end() const noexcept
+    {
+        return ConstIterator(this, GetSize());
+    }
+
+    ConstIterator cbegin() const noexcept
+    {
+        return begin();
+    }
+
+    ConstIterator cend() const noexcept
+    {
+        return end();
+    }
+
+    // Вызывает f(first, count) для кусков до и после разрыва, пропуская пустые
+    template <typename F>
+    void ForEachBlock(F f) const
+    {
+        if(gap_begin_ != 0)
+        {
+            f(Front(), gap_begin_);
+        }
+        if(BackSize() != 0)
+        {
+            f(Back(), BackSize());
+        }
+    }
+
+    template <typename F>
+    void ForEachBlock(F f)
+    {
+        if(gap_begin_ != 0)
+        {
+            f(Front(), gap_begin_);
+        }
+        if(BackSize() != 0)
+        {
+            f(Back(), BackSize());
+        }
+    }
+
+private:
+    Type* Front() const noexcept
+    {
+        return buffer_.GetRawPtr();
+    }
+
+    Type* Back() const noexcept
+    {
+        return buffer_.GetRawPtr() + gap_end_;
+    }
+
+    size_t BackSize() const noexcept
+    {
+        return buffer_.GetSize() - gap_end_;
+    }
+
+    // Создаёт в свежем буфере на other.GetSize() ячеек элементы other подряд, оставляя
+    // разрыв в конце. wrap(element) даёт итератор, из которого элемент копируется
+    // или перемещается. При исключении созданные элементы разрушаются
+    template <typename Wrap>
+    void ConstructFrom(const GapSimpleVector& other, Wrap wrap)
+    {
+        Allocator& alloc = buffer_.GetAllocator();
+        Type* dest = buffer_.GetRawPtr();
+        Type* middle = UninitializedCopy(alloc, wrap(other.Front()), wrap(other.Front() + other.gap_begin_), dest);
+        try
+        {
+            UninitializedCopy(alloc, wrap(other.Back()), wrap(other.Back() + other.BackSize()), middle);
+        }
+        catch(...)
+        {
+            DestroyRange(alloc, dest, middle);
+            throw;
+        }
+        gap_begin_ = gap_end_ = other.GetSize();
+    }
+
+    // Уничтожает свои элементы и забирает буфер other. Аллокаторы должны быть равны,
+    // либо аллокатор other должен переезжать при перемещающем присваивании
+    void StealFrom(GapSimpleVector& other) noexcept
+    {
+        Clear();
+        // При равных аллокаторах наш опустевший буфер достаётся other целиком как разрыв
+        buffer_ = std::move(other.buffer_);
+        gap_begin_ = std::exchange(other.gap_begin_, 0);
+        gap_end_ = std::exchange(other.gap_end_, other.buffer_.GetSize());
+    }
+
+    bool IsOwnElement(const Type& value) const noexcept
+    {
+        const Type* p = std::addressof(value);
+        return std::less_equal<const Type*>()(Front(), p) && std::less<const Type*>()(p, Front() + GetCapacity());
+    }
+
+    // Ставит разрыв перед index и создаёт в его первой ячейке элемент из value,
+    // который не лежит в самом векторе
+    template <typename Value>
+    Type& InsertValue(size_t index, Value&& value)
+    {
+        if(gap_begin_ == gap_end_)
+        {
+            const size_t max_size = AllocTraits::max_size(buffer_.GetAllocator());
+            if(GetSize() >= max_size)
+            {
+                throw std::length_error("GapSimpleVector is too long");
+            }
+            Reallocate(std::min(DoublingGrowth::NextCapacity(GetCapacity(), GetSize() + 1, sizeof(Type)), max_size));
+        }
+        MoveGap(index);
+        Type* slot = buffer_.GetRawPtr() + gap_begin_;
+        ConstructAt(buffer_.GetAllocator(), slot, std::forward<Value>(value));
+        ++gap_begin_;
+        return *slot;
+    }
+
+    // Переносит элементы в новый буфер на new_capacity ячеек: начало - в начало,
+    // хвост - в конец, разрыв остаётся в той же позиции
+    void Reallocate(size_t new_capacity)
+    {
+        ArrayPtr<Type, Allocator> temp(new_capacity, buffer_.GetAllocator());
+        Allocator& alloc = buffer_.GetAllocator();
+        const size_t back_size = BackSize();
+        Type* new_back = temp.GetRawPtr() + new_capacity - back_size;
+        if constexpr (kIsTriviallyRelocatable<Type>)
+        {
+            UninitializedRelocate(alloc, Front(), Front() + gap_begin_, temp.GetRawPtr());
+            UninitializedRelocate(alloc, Back(), Back() + back_size, new_back);
+        }
+        else
+        {
+            // Старые элементы разрушаются, только когда оба куска перенесены
+            UninitializedMoveIfNoexcept(alloc, Front(), Front() + gap_begin_, temp.GetRawPtr());
+            try
+            {
+                UninitializedMoveIfNoexcept(alloc, Back(), Back() + back_size, new_back);
+            }
+            catch(...)
+            {
+                DestroyRange(alloc, temp.GetRawPtr(), temp.GetRawPtr() + gap_begin_);
+                throw;
+            }
+            DestroyRange(alloc, Front(), Front() + gap_begin_);
+            DestroyRange(alloc, Back(), Back() + back_size);
+        }
+        buffer_ = std::move(temp);
+        gap_end_ = new_capacity - back_size;
+    }
+
+    template <typename Owner, typename Value>
+    class BasicIterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = std::remove_const_t<Value>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Value*;
+        using reference = Value&;
+
+        BasicIterator() = default;
+
+        BasicIterator(Owner* owner, size_t index) noexcept
+        : owner_(owner)
+        , index_(index)
+        {}
+
+        // Неконстантный итератор приводится к константному
+        template <typename OtherOwner, typename OtherValue,
+                  typename = std::enable_if_t<std::is_convertible_v<OtherValue*, Value*>>>
+        BasicIterator(const BasicIterator<OtherOwner, OtherValue>& other) noexcept
+        : owner_(other.owner_)
+        , index_(other.index_)
+        {}
+
+        reference operator*() const noexcept { return (*owner_)[index_]; }
+        pointer operator->() const noexcept { return &(*owner_)[index_]; }
+        reference operator[](difference_type n) const noexcept { return (*owner_)[index_ + n]; }
+
+        BasicIterator& operator++() noexcept { ++index_; return *this; }
+        BasicIterator operator++(int) noexcept { BasicIterator old = *this; ++index_; return old; }
+        BasicIterator& operator--() noexcept { --index_; return *this; }
+        BasicIterator operator--(int) noexcept { BasicIterator old = *this; --index_; return old; }
+        BasicIterator& operator+=(difference_type n) noexcept { index_ += n; return *this; }
+        BasicIterator& operator-=(difference_type n) noexcept { index_ -= n; return *this; }
+        BasicIterator operator+(difference_type n) const noexcept { return BasicIterator(owner_, index_ + n); }
+        BasicIterator operator-(difference_type n) const noexcept { return BasicIterator(owner_, index_ - n); }
+        friend BasicIterator operator+(difference_type n, const BasicIterator& it) noexcept { return it + n; }
+        difference_type operator-(const BasicIterator& other) const noexcept
+        {
+            return static_cast<difference_type>(index_) - static_cast<difference_type>(other.index_);
+        }
+
+        bool operator==(const BasicIterator& other) const noexcept { return index_ == other.index_; }
+        bool operator!=(const BasicIterator& other) const noexcept { return index_ != other.index_; }
+        bool operator<(const BasicIterator& other) const noexcept { return index_ < other.index_; }
+        bool operator>(const BasicIterator& other) const noexcept { return index_ > other.index_; }
+        bool operator<=(const BasicIterator& other) const noexcept { return index_ <= other.index_; }
+        bool operator>=(const BasicIterator& other) const noexcept { return index_ >= other.index_; }
+
+    private:
+        template <typename, typename>
+        friend class BasicIterator;
+
+        Owner* owner_ = nullptr;
+        size_t index_ = 0;
+    };
+
+    ArrayPtr<Type, Allocator> buffer_;
+    size_t gap_begin_ = 0;
+    size_t gap_end_ = 0;
+};
+
+namespace gap_detail {
+
+// Число элементов, лежащих подряд начиная с index
+template <typename Type, typename Allocator>
+size_t ContiguousFrom(const GapSimpleVector<Type, Allocator>& vector, size_t index) noexcept
+{
+    return (index < vector.GetGapPosition() ? vector.GetGapPosition() : vector.GetSize()) - index;
+}
+
+// Общая часть векторов делится на куски, непрерывные в обоих, и сравнивается теми же
+// однопроходными функциями, что и у SimpleVector. Для каждого куска вызывает
+// compare(lhs, rhs, n) и возвращает первый ненулевой результат или zero
+template <typename Type, typename Allocator, typename Result, typename Compare>
+Result CompareChunks(const GapSimpleVector<Type, Allocator>& lhs, const GapSimpleVector<Type, Allocator>& rhs,
+                     Result zero, Compare compare)
+{
+    const size_t common = std::min(lhs.GetSize(), rhs.GetSize());
+    for(size_t start = 0; start < common;)
+    {
+        const size_t n = std::min({ContiguousFrom(lhs, start), ContiguousFrom(rhs, start), common - start});
+        const Result result = compare(&lhs[start], &rhs[start], n);
+        if(result != 0)
+        {
+            return result;
+        }
+        start += n;
+    }
+    return zero;
+}
+
+} // namespace gap_detail
+
+template <typename Type, typename Allocator>
+bool operator==(const GapSimpleVector<Type, Allocator>& lhs, const GapSimpleVector<Type, Allocator>& rhs) {
+    if(lhs.GetSize() != rhs.GetSize())
+    {
+        return false;
+    }
+    return gap_detail::CompareChunks(lhs, rhs, 0, [](const Type* a, const Type* b, size_t n) {
+        return RangeEqual(a, b, n) ? 0 : 1;
+    }) == 0;
+}
+
+template <typename Type, typename Allocator>
+bool operator!=(const GapSimpleVector<Type, Allocator>& lhs, const GapSimpleVector<Type, Allocator>& rhs) {
+    return !(lhs == rhs);
+}
+
+// Результат сравнения как у RangeCompare: отрицательный, ноль или положительный
+template <typename Type, typename Allocator>
+int Compare(const GapSimpleVector<Type, Allocator>& lhs, const GapSimpleVector<Type, Allocator>& rhs) {
+    const int result = gap_detail::CompareChunks(lhs, rhs, 0, [](const Type* a, const Type* b, size_t n) {
+        return RangeCompare(a, n, b, n);
+    });
+    if(result != 0)
+    {
+        return result;
+    }
+    return lhs.GetSize() < rhs.GetSize() ? -1 : (lhs.GetSize() > rhs.GetSize() ? 1 : 0);
+}
+
+template <typename Type, typename Allocator>
+bool operator<(const GapSimpleVector<Type, Allocator>& lhs, const GapSimpleVector<Type, Allocator>& rhs) {
+    return Compare(lhs, rhs) < 0;
+}
+
+template <typename Type, typename Allocator>
+bool operator>(const GapSimpleVector<Type, Allocator>& lhs, const GapSimpleVector<Type, Allocator>& rhs) {
+    return Compare(lhs, rhs) > 0;
+}
+
+template <typename Type, typename Allocator>
+bool operator<=(const GapSimpleVector<Type, Allocator>& lhs, const GapSimpleVector<Type, Allocator>& rhs) {
+    return Compare(lhs, rhs) <= 0;
+}
+
+template <typename Type, typename Allocator>
+bool operator>=(const GapSimpleVector<Type, Allocator>& lhs, const GapSimpleVector<Type, Allocator>& rhs) {
+    return Compare(lhs, rhs) >= 0;
+}
+
+#if defined(__cpp_impl_three_way_comparison) && defined(__cpp_lib_three_way_comparison)
+template <typename Type, typename Allocator>
+SynthThreeWayResult<Type> operator<=>(const GapSimpleVector<Type, Allocator>& lhs,
+                                      const GapSimpleVector<Type, Allocator>& rhs) {
+    const size_t common = std::min(lhs.GetSize(), rhs.GetSize());
+    for(size_t start = 0; start < common;)
+    {
+        const size_t n = std::min({gap_detail::ContiguousFrom(lhs, start), gap_detail::ContiguousFrom(rhs, start), common - start});
+        const SynthThreeWayResult<Type> result = RangeCompareThreeWay(&lhs[start], n, &rhs[start], n);
+        if(result != 0)
+        {
+            return result;
+        }
+        start += n;
+    }
+    return lhs.GetSize() <=> rhs.GetSize();
+}
+#endif
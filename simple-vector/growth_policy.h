@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+
+// Политики роста SimpleVector. Политика - это тип со статическим методом
+//     size_t NextCapacity(size_t capacity, size_t required, size_t element_size) noexcept;
+// который возвращает новую вместимость не меньше required, когда текущей capacity
+// не хватает. Чтобы добавление в конец оставалось амортизированным O(1), рост должен
+// быть геометрическим.
+//
+// Политика может также уменьшать буфер, когда вектор опустел, - для этого у неё есть
+//     size_t ShrinkCapacity(size_t capacity, size_t size, size_t element_size) noexcept;
+// возвращающий новую вместимость (capacity, если уменьшать не нужно)
+
+// Вместимость растёт в Numerator / Denominator раз
+template <size_t Numerator, size_t Denominator = 1>
+struct GeometricGrowth {
+    static_assert(Numerator > Denominator && Denominator != 0, "Growth factor must be greater than one");
+
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t) noexcept
+    {
+        if(capacity > std::numeric_limits<size_t>::max() / Numerator)
+        {
+            return std::numeric_limits<size_t>::max();
+        }
+        const size_t grown = capacity * Numerator / Denominator;
+        return grown > required ? grown : required;
+    }
+};
+
+// Удвоение - политика по умолчанию: меньше всего перевыделений
+using DoublingGrowth = GeometricGrowth<2>;
+
+// Рост в полтора раза: до 1/3 меньше запаса, зато освобождённые буферы
+// со временем можно переиспользовать под следующий рост
+using OneAndHalfGrowth = GeometricGrowth<3, 2>;
+
+// Округляет вместимость Base так, чтобы буфер занимал целый класс размера аллокатора:
+// меньше страницы - степень двойки байтов, от страницы - целое число страниц.
+// Тогда округление, которое аллокатор сделал бы всё равно, становится вместимостью
+template <typename Base = DoublingGrowth, size_t PageSize = 4096>
+struct PageRoundedGrowth {
+    static_assert((PageSize & (PageSize - 1)) == 0, "PageSize must be a power of two");
+
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t element_size) noexcept
+    {
+        const size_t count = Base::NextCapacity(capacity, required, element_size);
+        if(count > (std::numeric_limits<size_t>::max() - PageSize) / element_size)
+        {
+            return count;
+        }
+        const size_t bytes = count * element_size;
+        size_t rounded = PageSize;
+        if(bytes < PageSize)
+        {
+            rounded = 16;
+            while(rounded < bytes)
+            {
+                rounded *= 2;
+            }
+        }
+        else
+        {
+            rounded = (bytes + PageSize - 1) / PageSize * PageSize;
+        }
+        return rounded / element_size;
+    }
+};
+
+// Добавляет к Base автоматическое уменьшение: когда элементов становится меньше
+// 1/ShrinkDivisor вместимости, буфер ужимается до удвоенного размера. Между ростом
+// и уменьшением остаётся зазор (гистерезис), поэтому чередование PushBack и PopBack
+// на границе не перевыделяет буфер каждый раз, и операции остаются амортизированными O(1).
+// Буферы не больше MinCapacity элементов не уменьшаются
+template <typename Base = DoublingGrowth, size_t ShrinkDivisor = 4, size_t MinCapacity = 16>
+struct AutoShrinkGrowth {
+    static_assert(ShrinkDivisor > 2, "Shrinking to twice the size needs a divisor above two");
+
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t element_size) noexcept
+    {
+        return Base::NextCapacity(capacity, required, element_size);
+    }
+
+    static constexpr size_t ShrinkCapacity(size_t capacity, size_t size, size_t) noexcept
+    {
+        if(capacity <= MinCapacity || size >= capacity / ShrinkDivisor)
+        {
+            return capacity;
+        }
+        return size * 2;
+    }
+};
+
+// Истинно, если политика Growth умеет уменьшать буфер
+template <typename Growth, typename = void>
+inline constexpr bool kGrowthShrinks = false;
+
+template <typename Growth>
+inline constexpr bool kGrowthShrinks<Growth, std::void_t<decltype(Growth::ShrinkCapacity(size_t{}, size_t{}, size_t{}))>> = true;
@@ -0,0 +1,272 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <type_traits>
+#include "constexpr_support.h"
+
+// Уровень проверок SimpleVector задаётся при сборке, например -DSIMPLE_VECTOR_HARDENING=2.
+// NONE - как раньше: operator[], PopBack, Erase и Insert проверяют аргументы через assert,
+//        итераторы - сырые указатели.
+// FAST - те же проверки остаются и с NDEBUG: нарушение печатает сообщение и вызывает
+//        std::abort. Итераторы по-прежнему сырые указатели, цена - одно сравнение на вызов.
+// CHECKED - вдобавок итераторы помнят поколение буфера и проверяют его и границы при
+//        разыменовании, освобождённые ячейки заполняются kPoisonByte, а под ASan
+//        незанятая часть буфера [size, capacity) помечается недоступной.
+// Уровень меняет раскладку SimpleVector, поэтому все единицы трансляции программы
+// должны собираться с одним и тем же значением
+#define SIMPLE_VECTOR_HARDENING_NONE 0
+#define SIMPLE_VECTOR_HARDENING_FAST 1
+#define SIMPLE_VECTOR_HARDENING_CHECKED 2
+
+#ifndef SIMPLE_VECTOR_HARDENING
+#define SIMPLE_VECTOR_HARDENING SIMPLE_VECTOR_HARDENING_NONE
+#endif
+
+#define SIMPLE_VECTOR_HAS_CHECKED_ITERATORS (SIMPLE_VECTOR_HARDENING >= SIMPLE_VECTOR_HARDENING_CHECKED)
+
+// Аннотации контейнера нужны, только если программа собрана с AddressSanitizer
+#if SIMPLE_VECTOR_HAS_CHECKED_ITERATORS && defined(__SANITIZE_ADDRESS__)
+#define SIMPLE_VECTOR_ANNOTATE_ASAN 1
+#elif SIMPLE_VECTOR_HAS_CHECKED_ITERATORS && defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define SIMPLE_VECTOR_ANNOTATE_ASAN 1
+#endif
+#endif
+
+#ifndef SIMPLE_VECTOR_ANNOTATE_ASAN
+#define SIMPLE_VECTOR_ANNOTATE_ASAN 0
+#endif
+
+#if SIMPLE_VECTOR_ANNOTATE_ASAN
+#include <sanitizer/common_interface_defs.h>
+#endif
+
+namespace hardening_detail {
+
+// Байт, которым в режиме CHECKED заполняются ячейки без живых элементов
+inline constexpr unsigned char kPoisonByte = 0xDD;
+
+[[noreturn]] inline void Fail(const char* message) noexcept
+{
+    std::fprintf(stderr, "SimpleVector hardening: %s\n", message);
+    std::abort();
+}
+
+inline void PoisonFill(void* first, size_t bytes) noexcept
+{
+    std::memset(first, kPoisonByte, bytes);
+}
+
+// Сообщает ASan, что в буфере [first, last) доступны ячейки до new_mid, а не до old_mid.
+// Старые версии ASan требуют, чтобы first был выровнен на 8 байт; такие буферы дают
+// все стандартные аллокаторы, остальные просто не аннотируются
+inline void AnnotateContiguous(const void* first, const void* last, const void* old_mid, const void* new_mid) noexcept
+{
+#if SIMPLE_VECTOR_ANNOTATE_ASAN
+    if(first != nullptr && old_mid != new_mid && reinterpret_cast<std::uintptr_t>(first) % 8 == 0)
+    {
+        __sanitizer_annotate_contiguous_container(first, last, old_mid, new_mid);
+    }
+#else
+    (void)first;
+    (void)last;
+    (void)old_mid;
+    (void)new_mid;
+#endif
+}
+
+} // namespace hardening_detail
+
+// Проверка аргумента, которая на уровне FAST и выше не исчезает вместе с NDEBUG
+#if SIMPLE_VECTOR_HARDENING >= SIMPLE_VECTOR_HARDENING_FAST
+#define SIMPLE_VECTOR_CHECK(condition, message) \
+    ((condition) ? void() : ::hardening_detail::Fail(message))
+#else
+#define SIMPLE_VECTOR_CHECK(condition, message) assert((condition) && (message))
+#endif
+
+#if SIMPLE_VECTOR_HAS_CHECKED_ITERATORS
+
+namespace hardening_detail {
+
+// Итератор режима CHECKED. Owner сообщает Data(), GetSize() и GetGeneration(); поколение
+// растёт при каждой смене буфера, так что итератор, переживший перевыделение, ловится
+// при первом же разыменовании или сдвиге. Итератор, оставшийся в пределах буфера после
+// сдвига элементов Insert или Erase, считается действительным: память под ним жива
+template <typename Owner, typename Value>
+class CheckedIterator {
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = std::remove_cv_t<Value>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = Value*;
+    using reference = Value&;
+
+    constexpr CheckedIterator() noexcept = default;
+
+    constexpr CheckedIterator(Value* ptr, const Owner* owner) noexcept
+        : ptr_(ptr)
+        , owner_(owner)
+        , generation_(owner->GetGeneration())
+    {}
+
+    // Итератор приводится к константному, но не обратно
+    template <typename Other, typename = std::enable_if_t<!std::is_same_v<Other, Value>
+                                                          && std::is_convertible_v<Other*, Value*>>>
+    constexpr CheckedIterator(const CheckedIterator<Owner, Other>& other) noexcept
+        : ptr_(other.ptr_)
+        , owner_(other.owner_)
+        , generation_(other.generation_)
+    {}
+
+    constexpr reference operator*() const noexcept
+    {
+        Check(ptr_, true);
+        return *ptr_;
+    }
+
+    constexpr pointer operator->() const noexcept
+    {
+        Check(ptr_, true);
+        return ptr_;
+    }
+
+    constexpr reference operator[](difference_type n) const noexcept
+    {
+        return *(*this + n);
+    }
+
+    constexpr CheckedIterator& operator+=(difference_type n) noexcept
+    {
+        Check(ptr_ + n, false);
+        ptr_ += n;
+        return *this;
+    }
+
+    constexpr CheckedIterator& operator-=(difference_type n) noexcept
+    {
+        return *this += -n;
+    }
+
+    constexpr CheckedIterator& operator++() noexcept
+    {
+        return *this += 1;
+    }
+
+    constexpr CheckedIterator operator++(int) noexcept
+    {
+        CheckedIterator old = *this;
+        ++*this;
+        return old;
+    }
+
+    constexpr CheckedIterator& operator--() noexcept
+    {
+        return *this -= 1;
+    }
+
+    constexpr CheckedIterator operator--(int) noexcept
+    {
+        CheckedIterator old = *this;
+        --*this;
+        return old;
+    }
+
+    friend constexpr CheckedIterator operator+(CheckedIterator it, difference_type n) noexcept
+    {
+        return it += n;
+    }
+
+    friend constexpr CheckedIterator operator+(difference_type n, CheckedIterator it) noexcept
+    {
+        return it += n;
+    }
+
+    friend constexpr CheckedIterator operator-(CheckedIterator it, difference_type n) noexcept
+    {
+        return it -= n;
+    }
+
+    friend constexpr difference_type operator-(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept
+    {
+        return lhs.ptr_ - rhs.ptr_;
+    }
+
+    friend constexpr bool operator==(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept
+    {
+        return lhs.ptr_ == rhs.ptr_;
+    }
+
+    friend constexpr bool operator!=(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept
+    {
+        return lhs.ptr_ != rhs.ptr_;
+    }
+
+    friend constexpr bool operator<(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept
+    {
+        return lhs.ptr_ < rhs.ptr_;
+    }
+
+    friend constexpr bool operator>(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept
+    {
+        return lhs.ptr_ > rhs.ptr_;
+    }
+
+    friend constexpr bool operator<=(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept
+    {
+        return lhs.ptr_ <= rhs.ptr_;
+    }
+
+    friend constexpr bool operator>=(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept
+    {
+        return lhs.ptr_ >= rhs.ptr_;
+    }
+
+    // Проверяет, что итератор действителен и принадлежит owner, и возвращает его указатель.
+    // Так вектор принимает позиции в Insert и Erase
+    constexpr pointer Unwrap(const Owner* owner) const noexcept
+    {
+        if(owner_ != owner)
+        {
+            Fail("Iterator belongs to another vector");
+        }
+        Check(ptr_, false);
+        return ptr_;
+    }
+
+private:
+    template <typename, typename>
+    friend class CheckedIterator;
+
+    constexpr void Check(const Value* ptr, bool dereference) const noexcept
+    {
+        if(owner_ == nullptr)
+        {
+            Fail("Iterator is not bound to a vector");
+        }
+        if(generation_ != owner_->GetGeneration())
+        {
+            Fail("Iterator is invalidated");
+        }
+        const auto* first = owner_->Data();
+        const auto* last = first + owner_->GetSize();
+        if(ptr < first || ptr > last || (dereference && ptr == last))
+        {
+            Fail("Iterator is out of range");
+        }
+    }
+
+    Value* ptr_ = nullptr;
+    const Owner* owner_ = nullptr;
+    std::uint64_t generation_ = 0;
+};
+
+} // namespace hardening_detail
+
+#endif
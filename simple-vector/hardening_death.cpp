@@ -0,0 +1,49 @@
+#include "simple_vector.h"
+
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <string_view>
+
+// Ошибки, на которых проверки SimpleVector обязаны остановить программу. Собирается
+// с SIMPLE_VECTOR_HARDENING=2, каждый сценарий CTest запускает отдельно и ждёт
+// в выводе сообщение hardening_detail::Fail. Ожидаемый std::abort превращается
+// в обычный выход, иначе CTest считает процесс упавшим
+
+extern "C" void ExitOnAbort(int) {
+    std::_Exit(EXIT_SUCCESS);
+}
+
+int main(int argc, char* argv[]) {
+    std::signal(SIGABRT, ExitOnAbort);
+    if (argc != 2) {
+        std::cerr << "Usage: simple_vector_hardening_death <scenario>" << std::endl;
+        return 2;
+    }
+    const std::string_view scenario = argv[1];
+    SimpleVector<int> v{1, 2, 3};
+    volatile int sink = 0;
+    if (scenario == "index") {
+        sink = v[3];
+    } else if (scenario == "pop-empty") {
+        SimpleVector<int> empty;
+        empty.PopBack();
+    } else if (scenario == "stale-iterator") {
+        const auto it = v.begin();
+        v.Reserve(100);
+        sink = *it;
+    } else if (scenario == "past-end") {
+        const auto it = v.end() - 1;
+        v.PopBack();
+        sink = *it;
+    } else if (scenario == "foreign-iterator") {
+        SimpleVector<int> other{4};
+        v.Erase(other.begin());
+    } else {
+        std::cerr << "Unknown scenario " << scenario << std::endl;
+        return 2;
+    }
+    (void)sink;
+    std::cerr << "Scenario " << scenario << " was not stopped" << std::endl;
+    return 1;
+}
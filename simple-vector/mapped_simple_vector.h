@@ -0,0 +1,390 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Как открыть файл с элементами MappedSimpleVector
+enum class MapMode {
+    // Изменения попадают в файл, файл растёт вместе с вектором
+    kReadWrite,
+    // Только чтение; изменяющие методы выбрасывают std::logic_error. Запись через
+    // ссылку на элемент, как в kCopyOnWrite, остаётся в памяти процесса и не попадает в файл
+    kReadOnly,
+    // Изменения видны только этому вектору, файл остаётся прежним
+    kCopyOnWrite,
+};
+
+// Вектор тривиально копируемых записей, буфер которого - отображённый в память файл.
+// Файл содержит ровно GetSize() записей подряд, без заголовка, поэтому можно открыть
+// любой готовый файл фиксированных записей. Открытие ничего не читает: страницы
+// подгружаются системой при первом обращении, так что файл может быть больше памяти.
+//
+// В режиме kReadWrite вместимость - это размер файла: рост делает ftruncate и mremap,
+// а разрушение вектора обрезает файл до GetSize() записей. Если процесс упадёт,
+// в конце файла останутся нулевые записи запасной вместимости.
+// В режиме kCopyOnWrite файл отображается закрыто (MAP_PRIVATE); при росте вектор
+// переезжает в анонимную память, копируя записи
+template <typename Type>
+class MappedSimpleVector {
+    static_assert(std::is_trivially_copyable_v<Type>, "MappedSimpleVector stores raw bytes of elements");
+
+public:
+    using Iterator = Type*;
+    using ConstIterator = const Type*;
+
+    static constexpr size_t kGrowthFactor = 2;
+
+    // Открывает файл path, в режиме kReadWrite создавая его при необходимости.
+    // Выбрасывает std::system_error, если файл не удалось открыть или отобразить,
+    // и std::runtime_error, если размер файла не кратен sizeof(Type)
+    explicit MappedSimpleVector(const std::string& path, MapMode mode = MapMode::kReadWrite)
+    : mode_(mode)
+    {
+        const int flags = mode == MapMode::kReadWrite ? O_RDWR | O_CREAT : O_RDONLY;
+        fd_ = ::open(path.c_str(), flags | O_CLOEXEC, 0644);
+        if(fd_ < 0)
+        {
+            ThrowSystemError("open " + path);
+        }
+        try
+        {
+            struct stat info;
+            if(::fstat(fd_, &info) != 0)
+            {
+                ThrowSystemError("fstat " + path);
+            }
+            const auto bytes = static_cast<size_t>(info.st_size);
+            if(bytes % sizeof(Type) != 0)
+            {
+                throw std::runtime_error("File size of " + path + " is not a multiple of the element size");
+            }
+            if(bytes != 0)
+            {
+                data_ = Map(bytes, mode_ == MapMode::kReadWrite ? MAP_SHARED : MAP_PRIVATE, fd_);
+            }
+            size_ = bytes / sizeof(Type);
+            capacity_ = size_;
+        }
+        catch(...)
+        {
+            ::close(fd_);
+            throw;
+        }
+    }
+
+    MappedSimpleVector(const MappedSimpleVector&) = delete;
+    MappedSimpleVector& operator=(const MappedSimpleVector&) = delete;
+
+    MappedSimpleVector(MappedSimpleVector&& other) noexcept
+    : data_(std::exchange(other.data_, nullptr))
+    , size_(std::exchange(other.size_, 0))
+    , capacity_(std::exchange(other.capacity_, 0))
+    , fd_(std::exchange(other.fd_, -1))
+    , mode_(other.mode_)
+    , anonymous_(std::exchange(other.anonymous_, false))
+    {}
+
+    MappedSimpleVector& operator=(MappedSimpleVector&& other) noexcept
+    {
+        if(this != &other)
+        {
+            MappedSimpleVector old(std::move(*this));
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+            capacity_ = std::exchange(other.capacity_, 0);
+            fd_ = std::exchange(other.fd_, -1);
+            mode_ = other.mode_;
+            anonymous_ = std::exchange(other.anonymous_, false);
+        }
+        return *this;
+    }
+
+    // Снимает отображение и обрезает файл до размера вектора
+    ~MappedSimpleVector()
+    {
+        if(data_ != nullptr)
+        {
+            ::munmap(data_, capacity_ * sizeof(Type));
+        }
+        if(fd_ >= 0)
+        {
+            if(mode_ == MapMode::kReadWrite)
+            {
+                [[maybe_unused]] const int result = ::ftruncate(fd_, static_cast<off_t>(size_ * sizeof(Type)));
+            }
+            ::close(fd_);
+        }
+    }
+
+    MapMode GetMode() const noexcept
+    {
+        return mode_;
+    }
+
+    size_t GetSize() const noexcept
+    {
+        return size_;
+    }
+
+    size_t GetCapacity() const noexcept
+    {
+        return capacity_;
+    }
+
+    bool IsEmpty() const noexcept
+    {
+        return size_ == 0;
+    }
+
+    Type& operator[](size_t index) noexcept
+    {
+        assert(index < size_);
+        return data_[index];
+    }
+
+    const Type& operator[](size_t index) const noexcept
+    {
+        assert(index < size_);
+        return data_[index];
+    }
+
+    // Выбрасывает исключение std::out_of_range, если index >= size
+    Type& At(size_t index)
+    {
+        if(index >= size_)
+        {
+            throw std::out_of_range("Index is out of range");
+        }
+        return data_[index];
+    }
+
+    const Type& At(size_t index) const
+    {
+        if(index >= size_)
+        {
+            throw std::out_of_range("Index is out of range");
+        }
+        return data_[index];
+    }
+
+    // Увеличивает вместимость (и в режиме kReadWrite - размер файла) до new_capacity записей
+    void Reserve(size_t new_capacity)
+    {
+        CheckWritable();
+        if(new_capacity > capacity_)
+        {
+            Grow(new_capacity);
+        }
+    }
+
+    // Изменяет размер. Новые записи получают значение по умолчанию
+    void Resize(size_t new_size)
+    {
+        CheckWritable();
+        if(new_size > capacity_)
+        {
+            Grow(std::max(new_size, capacity_ * kGrowthFactor));
+        }
+        if(new_size > size_)
+        {
+            std::uninitialized_value_construct(data_ + size_, data_ + new_size);
+        }
+        size_ = new_size;
+    }
+
+    void Clear()
+    {
+        CheckWritable();
+        size_ = 0;
+    }
+
+    template <typename... Args>
+    Type& EmplaceBack(Args&&... args)
+    {
+        CheckWritable();
+        // Запись создаётся до роста, пока ссылки в args ещё указывают в старый буфер
+        Type value(std::forward<Args>(args)...);
+        if(size_ == capacity_)
+        {
+            Grow(std::max<size_t>(size_ + 1, capacity_ * kGrowthFactor));
+        }
+        Type* slot = new(data_ + size_) Type(value);
+        ++size_;
+        return *slot;
+    }
+
+    void PushBack(const Type& value)
+    {
+        EmplaceBack(value);
+    }
+
+    void PopBack()
+    {
+        CheckWritable();
+        assert(size_ != 0);
+        --size_;
+    }
+
+    // Сбрасывает изменённые страницы на диск. В остальных режимах ничего не делает
+    void Sync()
+    {
+        if(mode_ == MapMode::kReadWrite && data_ != nullptr && ::msync(data_, capacity_ * sizeof(Type), MS_SYNC) != 0)
+        {
+            ThrowSystemError("msync");
+        }
+    }
+
+    Iterator begin() noexcept
+    {
+        return data_;
+    }
+
+    Iterator end() noexcept
+    {
+        return data_ + size_;
+    }
+
+    ConstIterator begin() const noexcept
+    {
+        return data_;
+    }
+
+    ConstIterator end() const noexcept
+    {
+        return data_ + size_;
+    }
+
+    ConstIterator cbegin() const noexcept
+    {
+        return data_;
+    }
+
+    ConstIterator cend() const noexcept
+    {
+        return data_ + size_;
+    }
+
+private:
+    [[noreturn]] static void ThrowSystemError(const std::string& what)
+    {
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+
+    Type* Map(size_t bytes, int flags, int fd) const
+    {
+        // Закрытое отображение можно открыть на запись и при файле только для чтения:
+        // тогда неконстантные ссылки на записи не упадут на защищённой странице
+        void* address = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, flags, fd, 0);
+        if(address == MAP_FAILED)
+        {
+            ThrowSystemError("mmap");
+        }
+        return static_cast<Type*>(address);
+    }
+
+    void CheckWritable() const
+    {
+        if(mode_ == MapMode::kReadOnly)
+        {
+            throw std::logic_error("MappedSimpleVector is opened read-only");
+        }
+    }
+
+    void Grow(size_t new_capacity)
+    {
+        if(new_capacity > static_cast<size_t>(std::numeric_limits<off_t>::max()) / sizeof(Type))
+        {
+            throw std::length_error("MappedSimpleVector is too long");
+        }
+        const size_t old_bytes = capacity_ * sizeof(Type);
+        const size_t new_bytes = new_capacity * sizeof(Type);
+        if(mode_ == MapMode::kReadWrite)
+        {
+            // Хвост файла добавляется нулями и отображается на место нового буфера
+            if(::ftruncate(fd_, static_cast<off_t>(new_bytes)) != 0)
+            {
+                ThrowSystemError("ftruncate");
+            }
+            try
+            {
+                data_ = Remap(new_bytes, MAP_SHARED, fd_);
+            }
+            catch(...)
+            {
+                [[maybe_unused]] const int result = ::ftruncate(fd_, static_cast<off_t>(old_bytes));
+                throw;
+            }
+        }
+        else if(anonymous_)
+        {
+            data_ = Remap(new_bytes, MAP_PRIVATE | MAP_ANONYMOUS, -1);
+        }
+        else
+        {
+            // За концом файла закрытое отображение расти не может, поэтому записи
+            // переезжают в анонимную память
+            Type* fresh = Map(new_bytes, MAP_PRIVATE | MAP_ANONYMOUS, -1);
+            if(size_ != 0)
+            {
+                std::memcpy(static_cast<void*>(fresh), data_, size_ * sizeof(Type));
+            }
+            if(data_ != nullptr)
+            {
+                ::munmap(data_, old_bytes);
+            }
+            data_ = fresh;
+            anonymous_ = true;
+        }
+        capacity_ = new_capacity;
+    }
+
+    // Расширяет текущее отображение до new_bytes, перенося его при необходимости
+    Type* Remap(size_t new_bytes, [[maybe_unused]] int flags, [[maybe_unused]] int fd)
+    {
+        if(data_ == nullptr)
+        {
+            return Map(new_bytes, flags, fd);
+        }
+#if defined(__linux__)
+        void* address = ::mremap(data_, capacity_ * sizeof(Type), new_bytes, MREMAP_MAYMOVE);
+        if(address == MAP_FAILED)
+        {
+            ThrowSystemError("mremap");
+        }
+        return static_cast<Type*>(address);
+#else
+        // Без mremap файловое отображение создаётся заново; анонимное копируется
+        Type* fresh = Map(new_bytes, flags, fd);
+        if(fd < 0)
+        {
+            std::memcpy(static_cast<void*>(fresh), data_, size_ * sizeof(Type));
+        }
+        ::munmap(data_, capacity_ * sizeof(Type));
+        return fresh;
+#endif
+    }
+
+    Type* data_ = nullptr;
+    size_t size_ = 0;
+    size_t capacity_ = 0;
+    int fd_ = -1;
+    MapMode mode_ = MapMode::kReadWrite;
+    // В режиме kCopyOnWrite буфер уже переехал из файла в анонимную память
+    bool anonymous_ = false;
+};
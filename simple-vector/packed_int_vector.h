@@ -0,0 +1,534 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "simd_kernels.h"
+#include "simple_vector.h"
+#include "static_simple_vector.h"
+
+namespace packed_detail {
+
+constexpr size_t kBlockSize = 128;
+
+// Delta-блок хранит сумму разностей перед каждым kCheckpointStep-м значением,
+// так что чтение по индексу складывает не больше kCheckpointStep - 1 разностей
+constexpr size_t kCheckpointStep = 16;
+constexpr size_t kCheckpoints = kBlockSize / kCheckpointStep - 1;
+
+// Упакованные значения ширины Width: значение j занимает биты [j * Width, (j + 1) * Width)
+// массива слов и может переходить через границу слова. 64 значения занимают ровно
+// Width слов, так что половины блока упаковываются одинаково
+template <unsigned Width, size_t J>
+inline std::uint64_t Extract(const std::uint64_t* in) noexcept
+{
+    if constexpr (Width == 0)
+    {
+        return 0;
+    }
+    else if constexpr (Width == 64)
+    {
+        return in[J];
+    }
+    else
+    {
+        constexpr size_t kBit = J * Width;
+        constexpr unsigned kShift = kBit % 64;
+        std::uint64_t value = in[kBit / 64] >> kShift;
+        if constexpr (kShift + Width > 64)
+        {
+            value |= in[kBit / 64 + 1] << (64 - kShift);
+        }
+        return value & ((std::uint64_t{1} << Width) - 1);
+    }
+}
+
+// Распаковка 64 значений с шириной, известной при компиляции: все сдвиги и маски -
+// константы, цикл развёрнут, и компилятор раскладывает его по векторным регистрам
+template <unsigned Width, size_t... J>
+inline void Unpack64(const std::uint64_t* in, std::uint64_t* out, std::index_sequence<J...>) noexcept
+{
+    ((out[J] = Extract<Width, J>(in)), ...);
+}
+
+template <unsigned Width>
+void UnpackBlock(const std::uint64_t* in, std::uint64_t* out) noexcept
+{
+    Unpack64<Width>(in, out, std::make_index_sequence<64>{});
+    Unpack64<Width>(in + Width, out + 64, std::make_index_sequence<64>{});
+}
+
+using UnpackFunction = void (*)(const std::uint64_t*, std::uint64_t*) noexcept;
+
+template <size_t... W>
+constexpr auto MakeUnpackTable(std::index_sequence<W...>) noexcept
+{
+    return std::array<UnpackFunction, sizeof...(W)>{&UnpackBlock<static_cast<unsigned>(W)>...};
+}
+
+// Распаковщик блока для каждой ширины от 0 до 64
+inline constexpr auto kUnpackBlock = MakeUnpackTable(std::make_index_sequence<65>{});
+
+// Одно значение с шириной, известной только при выполнении
+inline std::uint64_t ExtractOne(const std::uint64_t* in, unsigned width, size_t index) noexcept
+{
+    if(width == 0)
+    {
+        return 0;
+    }
+    const size_t bit = index * width;
+    const unsigned shift = bit % 64;
+    std::uint64_t value = in[bit / 64] >> shift;
+    if(shift + width > 64)
+    {
+        value |= in[bit / 64 + 1] << (64 - shift);
+    }
+    return width == 64 ? value : value & ((std::uint64_t{1} << width) - 1);
+}
+
+// Сколько слов занимают count значений шириной width
+constexpr size_t PackedWords(size_t count, unsigned width) noexcept
+{
+    return (count * width + 63) / 64;
+}
+
+// Упаковывает count значений шириной width в PackedWords(count, width) слов out
+inline void PackValues(const std::uint64_t* values, size_t count, unsigned width, std::uint64_t* out) noexcept
+{
+    std::fill(out, out + PackedWords(count, width), std::uint64_t{0});
+    if(width == 0)
+    {
+        return;
+    }
+    for(size_t i = 0; i < count; ++i)
+    {
+        const size_t bit = i * width;
+        const unsigned shift = bit % 64;
+        out[bit / 64] |= values[i] << shift;
+        if(shift + width > 64)
+        {
+            out[bit / 64 + 1] |= values[i] >> (64 - shift);
+        }
+    }
+}
+
+inline unsigned BitWidth(std::uint64_t value) noexcept
+{
+    unsigned width = 0;
+    for(; value != 0; value >>= 1)
+    {
+        ++width;
+    }
+    return width;
+}
+
+// Ширина контрольной суммы delta-блока: сумма до 127 разностей шириной width
+// умещается в width + 7 битов, а по модулю 2^64 её хватает и в 64 битах
+constexpr unsigned CheckpointWidth(unsigned width) noexcept
+{
+    return std::min(width + 7u, 64u);
+}
+
+// Слова, которые занимают упакованные значения delta-блока и его контрольные суммы.
+// Блоку нулевой ширины суммы не нужны: его значения - арифметическая прогрессия
+constexpr size_t DeltaBlockWords(unsigned width) noexcept
+{
+    return width == 0 ? 0 : PackedWords(kBlockSize, width) + PackedWords(kCheckpoints, CheckpointWidth(width));
+}
+
+} // namespace packed_detail
+
+// Сжатый вектор 64-битных целых для плотных и в основном возрастающих последовательностей,
+// например отсортированных списков идентификаторов. Значения хранятся блоками по 128:
+// - frame of reference: блок хранит минимум, а значения - как разность с ним;
+// - delta: у неубывающего блока хранятся разности соседей за вычетом наименьшей из них,
+//   так что идущие подряд идентификаторы занимают 0 битов на значение;
+//   За упакованными разностями лежат суммы разностей перед каждым 16-м значением;
+// - значения упаковываются в столько битов, сколько нужно самому большому из них,
+//   и для каждого блока выбирается способ, которому нужно меньше слов.
+//
+// Заголовки блоков - индекс пропуска: operator[] находит блок делением и читает одно
+// значение, а в delta-блоке - ближайшую сумму и не больше 15 разностей после неё.
+// Последовательный обход идёт через ForEachBlock, который распаковывает блок целиком
+// развёрнутым под ширину циклом, или через итератор, который помнит распакованный блок.
+// PushBack дописывает в открытый хвостовой блок, который упаковывается, когда заполнится.
+// Изменять записанные значения нельзя
+class PackedIntVector {
+    struct BlockHeader {
+        std::uint64_t base = 0;
+        std::uint64_t step = 0;
+        std::uint64_t offset : 56;
+        std::uint64_t width : 7;
+        std::uint64_t delta : 1;
+    };
+
+public:
+    using ValueType = std::uint64_t;
+
+    class ConstIterator;
+
+    static constexpr size_t kBlockSize = packed_detail::kBlockSize;
+
+    PackedIntVector() noexcept = default;
+
+    PackedIntVector(std::initializer_list<std::uint64_t> init)
+    : PackedIntVector(init.begin(), init.end())
+    {}
+
+    template <typename InputIt, typename = std::enable_if_t<kIsIteratorOf<InputIt, std::input_iterator_tag>>>
+    PackedIntVector(InputIt first, InputIt last)
+    {
+        for(; first != last; ++first)
+        {
+            PushBack(*first);
+        }
+    }
+
+    PackedIntVector(const PackedIntVector& other)
+    : words_(other.words_)
+    , blocks_(other.blocks_)
+    , tail_(other.tail_)
+    {}
+
+    PackedIntVector(PackedIntVector&& other) noexcept = default;
+
+    PackedIntVector& operator=(const PackedIntVector& rhs)
+    {
+        if(this != &rhs)
+        {
+            PackedIntVector copy(rhs);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    PackedIntVector& operator=(PackedIntVector&& rhs) noexcept = default;
+
+    void swap(PackedIntVector& other) noexcept
+    {
+        words_.swap(other.words_);
+        blocks_.swap(other.blocks_);
+        std::swap(tail_, other.tail_);
+    }
+
+    size_t GetSize() const noexcept
+    {
+        return blocks_.GetSize() * kBlockSize + tail_.GetSize();
+    }
+
+    bool IsEmpty() const noexcept
+    {
+        return GetSize() == 0;
+    }
+
+    // Байты, занятые упакованными значениями, заголовками блоков и хвостом
+    size_t GetMemoryUsage() const noexcept
+    {
+        return words_.GetCapacity() * sizeof(std::uint64_t) + blocks_.GetCapacity() * sizeof(BlockHeader)
+            + sizeof(tail_);
+    }
+
+    std::uint64_t operator[](size_t index) const noexcept
+    {
+        assert(index < GetSize());
+        const size_t block = index / kBlockSize;
+        const size_t position = index % kBlockSize;
+        if(block == blocks_.GetSize())
+        {
+            return tail_[position];
+        }
+        const BlockHeader& header = blocks_[block];
+        const std::uint64_t* data = words_.Data() + header.offset;
+        const auto width = static_cast<unsigned>(header.width);
+        if(!header.delta)
+        {
+            return header.base + packed_detail::ExtractOne(data, width, position);
+        }
+        std::uint64_t value = header.base + position * header.step;
+        if(width == 0)
+        {
+            return value;
+        }
+        const size_t checkpoint = position / packed_detail::kCheckpointStep;
+        if(checkpoint != 0)
+        {
+            const std::uint64_t* sums = data + packed_detail::PackedWords(kBlockSize, width);
+            value += packed_detail::ExtractOne(sums, packed_detail::CheckpointWidth(width), checkpoint - 1);
+        }
+        for(size_t i = checkpoint * packed_detail::kCheckpointStep + 1; i <= position; ++i)
+        {
+            value += packed_detail::ExtractOne(data, width, i);
+        }
+        return value;
+    }
+
+    // Выбрасывает исключение std::out_of_range, если index >= size
+    std::uint64_t At(size_t index) const
+    {
+        if(index >= GetSize())
+        {
+            throw std::out_of_range("Index is out of range");
+        }
+        return (*this)[index];
+    }
+
+    // Дописывает значение в хвостовой блок. Заполненный хвост упаковывается перед
+    // следующим добавлением, так что при исключении вектор не меняется
+    void PushBack(std::uint64_t value)
+    {
+        if(tail_.GetSize() == kBlockSize)
+        {
+            SealTail();
+        }
+        tail_.PushBack(value);
+    }
+
+    // Резервирует заголовки под size значений
+    void Reserve(size_t size)
+    {
+        blocks_.Reserve(size / kBlockSize);
+    }
+
+    void Clear() noexcept
+    {
+        words_.Clear();
+        blocks_.Clear();
+        tail_.Clear();
+    }
+
+    void ShrinkToFit()
+    {
+        words_.ShrinkToFit();
+        blocks_.ShrinkToFit();
+    }
+
+    // Распаковывает блоки по порядку и вызывает f(values, count) для каждого из них;
+    // последним идёт хвост, если он не пуст
+    template <typename F>
+    void ForEachBlock(F f) const
+    {
+        std::uint64_t values[kBlockSize];
+        for(size_t block = 0; block < blocks_.GetSize(); ++block)
+        {
+            DecodeBlock(block, values);
+            f(static_cast<const std::uint64_t*>(values), kBlockSize);
+        }
+        if(!tail_.IsEmpty())
+        {
+            f(tail_.begin(), tail_.GetSize());
+        }
+    }
+
+    ConstIterator begin() const noexcept;
+    ConstIterator end() const noexcept;
+
+    friend bool operator==(const PackedIntVector& lhs, const PackedIntVector& rhs)
+    {
+        if(lhs.GetSize() != rhs.GetSize())
+        {
+            return false;
+        }
+        std::uint64_t left[kBlockSize];
+        std::uint64_t right[kBlockSize];
+        for(size_t block = 0; block < lhs.blocks_.GetSize(); ++block)
+        {
+            lhs.DecodeBlock(block, left);
+            rhs.DecodeBlock(block, right);
+            if(!RangeEqual(left, right, kBlockSize))
+            {
+                return false;
+            }
+        }
+        return lhs.tail_ == rhs.tail_;
+    }
+
+    friend bool operator!=(const PackedIntVector& lhs, const PackedIntVector& rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+private:
+    // Распаковывает блок block в kBlockSize значений out
+    void DecodeBlock(size_t block, std::uint64_t* out) const noexcept
+    {
+        const BlockHeader& header = blocks_[block];
+        packed_detail::kUnpackBlock[header.width](words_.Data() + header.offset, out);
+        if(header.delta)
+        {
+            // Первая разность всегда нулевая, так что out[0] получает base
+            simd_detail::PrefixSum(out, kBlockSize, header.base, header.step);
+        }
+        else
+        {
+            for(size_t i = 0; i < kBlockSize; ++i)
+            {
+                out[i] += header.base;
+            }
+        }
+    }
+
+    // Упаковывает заполненный хвост способом, которому нужно меньше слов
+    void SealTail()
+    {
+        const std::uint64_t* values = tail_.begin();
+        const auto [min, max] = std::minmax_element(values, values + kBlockSize);
+        const unsigned for_width = packed_detail::BitWidth(*max - *min);
+
+        bool sorted = true;
+        std::uint64_t min_step = ~std::uint64_t{0};
+        std::uint64_t max_step = 0;
+        for(size_t i = 1; i < kBlockSize && sorted; ++i)
+        {
+            sorted = values[i - 1] <= values[i];
+            min_step = std::min(min_step, values[i] - values[i - 1]);
+            max_step = std::max(max_step, values[i] - values[i - 1]);
+        }
+        const unsigned delta_width = sorted ? packed_detail::BitWidth(max_step - min_step) : 64;
+
+        BlockHeader header;
+        header.offset = words_.GetSize();
+        header.delta = sorted && packed_detail::DeltaBlockWords(delta_width) < packed_detail::PackedWords(kBlockSize, for_width);
+        header.width = header.delta ? delta_width : for_width;
+        header.base = header.delta ? values[0] : *min;
+        header.step = header.delta ? min_step : 0;
+
+        std::uint64_t stored[kBlockSize];
+        stored[0] = header.delta ? 0 : values[0] - header.base;
+        for(size_t i = 1; i < kBlockSize; ++i)
+        {
+            stored[i] = header.delta ? values[i] - values[i - 1] - min_step : values[i] - header.base;
+        }
+
+        const auto width = static_cast<unsigned>(header.width);
+        const size_t words = header.delta ? packed_detail::DeltaBlockWords(width) : packed_detail::PackedWords(kBlockSize, width);
+
+        // Если слова не смогли вырасти, заголовок убирается и хвост остаётся открытым
+        blocks_.PushBack(header);
+        try
+        {
+            words_.Resize(words_.GetSize() + words);
+        }
+        catch(...)
+        {
+            blocks_.PopBack();
+            throw;
+        }
+        std::uint64_t* data = words_.Data() + header.offset;
+        packed_detail::PackValues(stored, kBlockSize, width, data);
+        if(header.delta && width != 0)
+        {
+            std::uint64_t sums[packed_detail::kCheckpoints];
+            std::uint64_t sum = 0;
+            for(size_t i = 1; i <= packed_detail::kCheckpoints * packed_detail::kCheckpointStep; ++i)
+            {
+                sum += stored[i];
+                if(i % packed_detail::kCheckpointStep == 0)
+                {
+                    sums[i / packed_detail::kCheckpointStep - 1] = sum;
+                }
+            }
+            packed_detail::PackValues(sums, packed_detail::kCheckpoints, packed_detail::CheckpointWidth(width),
+                                      data + packed_detail::PackedWords(kBlockSize, width));
+        }
+        tail_.Clear();
+    }
+
+    SimpleVector<std::uint64_t> words_;
+    SimpleVector<BlockHeader> blocks_;
+    StaticSimpleVector<std::uint64_t, kBlockSize> tail_;
+};
+
+// Итератор по значениям. Разыменование распаковывает блок целиком и запоминает его,
+// так что проход по порядку платит за значение столько же, сколько ForEachBlock.
+// Запомненный блок не копируется вместе с итератором, поэтому копии дешёвые
+class PackedIntVector::ConstIterator {
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = std::uint64_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = std::uint64_t;
+    using pointer = void;
+
+    ConstIterator() = default;
+
+    ConstIterator(const PackedIntVector* owner, size_t index) noexcept
+    : owner_(owner)
+    , index_(index)
+    {}
+
+    ConstIterator(const ConstIterator& other) noexcept
+    : owner_(other.owner_)
+    , index_(other.index_)
+    {}
+
+    ConstIterator& operator=(const ConstIterator& other) noexcept
+    {
+        owner_ = other.owner_;
+        index_ = other.index_;
+        cached_block_ = kNoBlock;
+        return *this;
+    }
+
+    reference operator*() const noexcept
+    {
+        const size_t block = index_ / kBlockSize;
+        if(block == owner_->blocks_.GetSize())
+        {
+            return owner_->tail_[index_ % kBlockSize];
+        }
+        if(block != cached_block_)
+        {
+            owner_->DecodeBlock(block, values_);
+            cached_block_ = block;
+        }
+        return values_[index_ % kBlockSize];
+    }
+
+    reference operator[](difference_type n) const noexcept { return (*owner_)[index_ + n]; }
+
+    ConstIterator& operator++() noexcept { ++index_; return *this; }
+    ConstIterator operator++(int) noexcept { ConstIterator old = *this; ++index_; return old; }
+    ConstIterator& operator--() noexcept { --index_; return *this; }
+    ConstIterator operator--(int) noexcept { ConstIterator old = *this; --index_; return old; }
+    ConstIterator& operator+=(difference_type n) noexcept { index_ += n; return *this; }
+    ConstIterator& operator-=(difference_type n) noexcept { index_ -= n; return *this; }
+    ConstIterator operator+(difference_type n) const noexcept { return ConstIterator(owner_, index_ + n); }
+    ConstIterator operator-(difference_type n) const noexcept { return ConstIterator(owner_, index_ - n); }
+    friend ConstIterator operator+(difference_type n, const ConstIterator& it) noexcept { return it + n; }
+    difference_type operator-(const ConstIterator& other) const noexcept
+    {
+        return static_cast<difference_type>(index_) - static_cast<difference_type>(other.index_);
+    }
+
+    bool operator==(const ConstIterator& other) const noexcept { return index_ == other.index_; }
+    bool operator!=(const ConstIterator& other) const noexcept { return index_ != other.index_; }
+    bool operator<(const ConstIterator& other) const noexcept { return index_ < other.index_; }
+    bool operator>(const ConstIterator& other) const noexcept { return index_ > other.index_; }
+    bool operator<=(const ConstIterator& other) const noexcept { return index_ <= other.index_; }
+    bool operator>=(const ConstIterator& other) const noexcept { return index_ >= other.index_; }
+
+private:
+    static constexpr size_t kNoBlock = ~size_t{0};
+
+    const PackedIntVector* owner_ = nullptr;
+    size_t index_ = 0;
+    mutable size_t cached_block_ = kNoBlock;
+    mutable std::uint64_t values_[kBlockSize];
+};
+
+inline PackedIntVector::ConstIterator PackedIntVector::begin() const noexcept
+{
+    return ConstIterator(this, 0);
+}
+
+inline PackedIntVector::ConstIterator PackedIntVector::end() const noexcept
+{
+    return ConstIterator(this, GetSize());
+}
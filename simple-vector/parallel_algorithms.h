@@ -0,0 +1,622 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "array_ptr.h"
+#include "relocation.h"
+#include "simple_vector.h"
+
+// Параллельные алгоритмы над SimpleVector: заполнение, копирование, преобразование,
+// свёртка и сортировка. Работа делится на задачи, которые выполняет пул потоков
+// с перехватом работы (work stealing). Поток, ожидающий свои задачи, не спит,
+// а выполняет чужие, поэтому задачи могут порождать и ждать вложенные задачи.
+//
+// Элементы создаются и разрушаются из разных потоков, поэтому аллокатор вектора
+// (и ресурс памяти вложенных элементов) должен быть потокобезопасным
+
+// Пул рабочих потоков. У каждого потока своя очередь: свои задачи он берёт с конца
+// (самые свежие и мелкие), а у других забирает с начала (самые крупные)
+class ThreadPool {
+public:
+    // Создаёт пул из thread_count рабочих потоков
+    explicit ThreadPool(size_t thread_count)
+    {
+        thread_count = std::max<size_t>(thread_count, 1);
+        for(size_t i = 0; i < thread_count; ++i)
+        {
+            queues_.push_back(std::make_unique<Queue>());
+        }
+        threads_.reserve(thread_count);
+        for(size_t i = 0; i < thread_count; ++i)
+        {
+            threads_.emplace_back([this, i] {
+                WorkerLoop(i);
+            });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Дожидается выполнения всех поставленных задач и останавливает потоки
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard lock(sleep_mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for(std::thread& thread : threads_)
+        {
+            thread.join();
+        }
+    }
+
+    // Общий пул на все ядра машины. Вызывающий поток тоже работает, пока ждёт,
+    // поэтому рабочих потоков на один меньше, чем ядер
+    static ThreadPool& Default()
+    {
+        static ThreadPool pool(std::max<size_t>(std::thread::hardware_concurrency(), 2) - 1);
+        return pool;
+    }
+
+    size_t GetThreadCount() const noexcept
+    {
+        return threads_.size();
+    }
+
+    // Ставит задачу в очередь. Задача не должна выбрасывать исключений
+    void Submit(std::function<void()> task)
+    {
+        // Рабочий поток кладёт задачу к себе, внешний - в очереди по кругу
+        const size_t index = current_pool_ == this
+            ? current_index_
+            : next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+        {
+            std::lock_guard lock(queues_[index]->mutex);
+            queues_[index]->tasks.push_back(std::move(task));
+        }
+        pending_.fetch_add(1, std::memory_order_release);
+        {
+            // Захват мьютекса не даёт уведомлению проскочить между проверкой и засыпанием
+            std::lock_guard lock(sleep_mutex_);
+        }
+        wake_.notify_one();
+    }
+
+    // Выполняет одну задачу из очередей пула, если она есть
+    bool RunPendingTask()
+    {
+        const size_t own = current_pool_ == this ? current_index_ : 0;
+        std::function<void()> task;
+        if(!TakeTask(own, task))
+        {
+            return false;
+        }
+        task();
+        return true;
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    // Берёт задачу из своей очереди own, а если она пуста - из чужих
+    bool TakeTask(size_t own, std::function<void()>& task)
+    {
+        if(pending_.load(std::memory_order_acquire) == 0)
+        {
+            return false;
+        }
+        {
+            Queue& queue = *queues_[own];
+            std::lock_guard lock(queue.mutex);
+            if(current_pool_ == this && !queue.tasks.empty())
+            {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+                pending_.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        for(size_t shift = 0; shift < queues_.size(); ++shift)
+        {
+            Queue& queue = *queues_[(own + shift) % queues_.size()];
+            std::lock_guard lock(queue.mutex);
+            if(!queue.tasks.empty())
+            {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+                pending_.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void WorkerLoop(size_t index)
+    {
+        current_pool_ = this;
+        current_index_ = index;
+        std::function<void()> task;
+        while(true)
+        {
+            if(TakeTask(index, task))
+            {
+                task();
+                task = nullptr;
+                continue;
+            }
+            std::unique_lock lock(sleep_mutex_);
+            wake_.wait(lock, [this] {
+                return stop_ || pending_.load(std::memory_order_acquire) != 0;
+            });
+            if(stop_ && pending_.load(std::memory_order_acquire) == 0)
+            {
+                return;
+            }
+        }
+    }
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> threads_;
+    std::atomic<size_t> pending_ = 0;
+    std::atomic<size_t> next_queue_ = 0;
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+    bool stop_ = false;
+
+    // Пул и номер очереди, которым принадлежит текущий поток
+    inline static thread_local ThreadPool* current_pool_ = nullptr;
+    inline static thread_local size_t current_index_ = 0;
+};
+
+// Группа задач, завершения которых можно дождаться. Первое исключение из задач
+// сохраняется и выбрасывается из Wait, когда завершатся все задачи группы
+class TaskGroup {
+public:
+    explicit TaskGroup(ThreadPool& pool) noexcept
+    : pool_(pool)
+    {}
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    ~TaskGroup()
+    {
+        WaitAll();
+    }
+
+    template <typename F>
+    void Run(F f)
+    {
+        remaining_.fetch_add(1, std::memory_order_relaxed);
+        try
+        {
+            pool_.Submit([this, f = std::move(f)]() mutable {
+                try
+                {
+                    f();
+                }
+                catch(...)
+                {
+                    std::lock_guard lock(error_mutex_);
+                    if(!error_)
+                    {
+                        error_ = std::current_exception();
+                    }
+                }
+                remaining_.fetch_sub(1, std::memory_order_release);
+            });
+        }
+        catch(...)
+        {
+            remaining_.fetch_sub(1, std::memory_order_relaxed);
+            throw;
+        }
+    }
+
+    // Ждёт завершения задач группы, выполняя тем временем задачи пула
+    void Wait()
+    {
+        WaitAll();
+        if(error_)
+        {
+            std::rethrow_exception(std::exchange(error_, nullptr));
+        }
+    }
+
+private:
+    void WaitAll() noexcept
+    {
+        while(remaining_.load(std::memory_order_acquire) != 0)
+        {
+            if(!pool_.RunPendingTask())
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    ThreadPool& pool_;
+    std::atomic<size_t> remaining_ = 0;
+    std::mutex error_mutex_;
+    std::exception_ptr error_;
+};
+
+// Настройки параллельных алгоритмов
+struct ParallelOptions {
+    // Диапазоны короче этого обрабатываются в вызывающем потоке без пула
+    size_t sequential_threshold = size_t{1} << 15;
+    // Сколько элементов обрабатывает одна задача. 0 - подобрать по числу потоков
+    size_t grain_size = 0;
+    // Пул, в котором выполняются задачи. nullptr - ThreadPool::Default()
+    ThreadPool* pool = nullptr;
+};
+
+namespace parallel_detail {
+
+inline ThreadPool& PoolOf(const ParallelOptions& options)
+{
+    return options.pool != nullptr ? *options.pool : ThreadPool::Default();
+}
+
+inline bool RunsSequentially(size_t count, const ParallelOptions& options)
+{
+    return count <= options.sequential_threshold;
+}
+
+// По умолчанию на каждый поток приходится около восьми задач: этого хватает,
+// чтобы выровнять нагрузку перехватом, и не слишком много для накладных расходов
+inline size_t GrainOf(size_t count, const ParallelOptions& options)
+{
+    if(options.grain_size != 0)
+    {
+        return options.grain_size;
+    }
+    const size_t tasks = (PoolOf(options).GetThreadCount() + 1) * 8;
+    return std::max<size_t>(count / tasks, 4096);
+}
+
+// Делит [first, last) пополам, пока куски больше grain, и отдаёт половины в группу.
+// Вызывающий поток сразу берётся за левый кусок, правые достаются другим потокам
+template <typename Body>
+void SplitRange(TaskGroup& group, size_t first, size_t last, size_t grain, const Body& body)
+{
+    while(last - first > grain)
+    {
+        const size_t middle = first + (last - first) / 2;
+        group.Run([&group, middle, last, grain, &body] {
+            SplitRange(group, middle, last, grain, body);
+        });
+        last = middle;
+    }
+    body(first, last);
+}
+
+// Вызывает body(first, last) для кусков, покрывающих [0, count)
+template <typename Body>
+void ForEachChunk(size_t count, const ParallelOptions& options, const Body& body)
+{
+    if(RunsSequentially(count, options))
+    {
+        body(size_t{0}, count);
+        return;
+    }
+    TaskGroup group(PoolOf(options));
+    SplitRange(group, 0, count, GrainOf(count, options), body);
+    group.Wait();
+}
+
+// Создаёт count элементов в сырой памяти dest, вызывая construct(alloc, chunk_dest, offset, n)
+// для кусков. Если хотя бы один кусок выбросил исключение, уже созданные куски разрушаются
+template <typename Type, typename Allocator, typename Construct>
+void ConstructChunks(Allocator& alloc, Type* dest, size_t count, const ParallelOptions& options, const Construct& construct)
+{
+    std::mutex done_mutex;
+    std::vector<std::pair<size_t, size_t>> done;
+    std::atomic<bool> failed = false;
+    try
+    {
+        ForEachChunk(count, options, [&](size_t first, size_t last) {
+            if(failed.load(std::memory_order_relaxed))
+            {
+                return;
+            }
+            try
+            {
+                construct(alloc, dest + first, first, last - first);
+            }
+            catch(...)
+            {
+                failed.store(true, std::memory_order_relaxed);
+                throw;
+            }
+            std::lock_guard lock(done_mutex);
+            done.emplace_back(first, last);
+        });
+    }
+    catch(...)
+    {
+        for(const auto& [first, last] : done)
+        {
+            DestroyRange(alloc, dest + first, dest + last);
+        }
+        throw;
+    }
+}
+
+// Сливает отсортированные [first1, last1) и [first2, last2) в dest перемещением.
+// Большой диапазон делится пополам, а его середина ищется во втором двоичным поиском,
+// так что обе половины слияния выполняются параллельно. Слияние устойчиво
+template <typename Type, typename Compare>
+void ParallelMerge(TaskGroup& group, Type* first1, Type* last1, Type* first2, Type* last2, Type* dest,
+                   size_t grain, const Compare& comp)
+{
+    while(static_cast<size_t>((last1 - first1) + (last2 - first2)) > grain)
+    {
+        Type* middle1;
+        Type* middle2;
+        if(last1 - first1 >= last2 - first2)
+        {
+            middle1 = first1 + (last1 - first1) / 2;
+            middle2 = std::lower_bound(first2, last2, *middle1, comp);
+        }
+        else
+        {
+            middle2 = first2 + (last2 - first2) / 2;
+            middle1 = std::upper_bound(first1, last1, *middle2, comp);
+        }
+        Type* right_dest = dest + (middle1 - first1) + (middle2 - first2);
+        group.Run([&group, middle1, last1, middle2, last2, right_dest, grain, &comp] {
+            ParallelMerge(group, middle1, last1, middle2, last2, right_dest, grain, comp);
+        });
+        last1 = middle1;
+        last2 = middle2;
+    }
+    std::merge(std::make_move_iterator(first1), std::make_move_iterator(last1),
+               std::make_move_iterator(first2), std::make_move_iterator(last2), dest, comp);
+}
+
+// Сортирует [first, last) слиянием. Результат оказывается в [first, last), если to_buffer
+// ложно, иначе - в буфере buffer той же длины. Половины сортируются в противоположный
+// массив и затем сливаются на место, поэтому каждый уровень переносит элементы один раз
+template <typename Type, typename Compare, typename LeafSort>
+void MergeSort(ThreadPool& pool, Type* first, Type* last, Type* buffer, bool to_buffer,
+               size_t grain, const Compare& comp, const LeafSort& leaf_sort)
+{
+    const size_t count = static_cast<size_t>(last - first);
+    if(count <= grain)
+    {
+        leaf_sort(first, last);
+        if(to_buffer)
+        {
+            std::move(first, last, buffer);
+        }
+        return;
+    }
+    const size_t half = count / 2;
+    {
+        TaskGroup group(pool);
+        group.Run([&] {
+            MergeSort(pool, first + half, last, buffer + half, !to_buffer, grain, comp, leaf_sort);
+        });
+        MergeSort(pool, first, first + half, buffer, !to_buffer, grain, comp, leaf_sort);
+        group.Wait();
+    }
+    Type* from = to_buffer ? first : buffer;
+    Type* to = to_buffer ? buffer : first;
+    TaskGroup group(pool);
+    ParallelMerge(group, from, from + half, from + half, from + count, to, grain, comp);
+    group.Wait();
+}
+
+// Сортирует вектор слиянием через буфер, куда элементы переносятся перемещением.
+// Сортировка идёт из буфера обратно в вектор, а оставшиеся в векторе перемещённые
+// объекты служат ей черновиком. Куски не длиннее grain сортируются leaf_sort
+template <typename Type, typename Allocator, typename Growth, typename Compare, typename LeafSort>
+void SortWithBuffer(SimpleVector<Type, Allocator, Growth>& v, const Compare& comp, const ParallelOptions& options,
+                    const LeafSort& leaf_sort)
+{
+    const size_t count = v.GetSize();
+    ArrayPtr<Type, Allocator> buffer(count, v.GetAllocator());
+    Allocator& alloc = buffer.GetAllocator();
+    Type* data = v.Data();
+    ConstructChunks(alloc, buffer.GetRawPtr(), count, options,
+        [data](Allocator& a, Type* dest, size_t offset, size_t n) {
+            UninitializedCopy(a, std::make_move_iterator(data + offset), std::make_move_iterator(data + offset + n), dest);
+        });
+
+    // Буфер целиком состоит из живых элементов и разрушается при любом исходе сортировки
+    struct BufferGuard {
+        ~BufferGuard()
+        {
+            DestroyRange(alloc, first, last);
+        }
+        Allocator& alloc;
+        Type* first;
+        Type* last;
+    } guard{alloc, buffer.GetRawPtr(), buffer.GetRawPtr() + count};
+
+    MergeSort(PoolOf(options), buffer.GetRawPtr(), buffer.GetRawPtr() + count, data, true, GrainOf(count, options), comp, leaf_sort);
+}
+
+} // namespace parallel_detail
+
+// Присваивает value всем элементам вектора
+template <typename Type, typename Allocator, typename Growth>
+void ParallelFill(SimpleVector<Type, Allocator, Growth>& v, const Type& value, const ParallelOptions& options = {})
+{
+    // value может ссылаться на элемент вектора, который перезапишет другой поток
+    const Type copy(value);
+    Type* data = v.Data();
+    parallel_detail::ForEachChunk(v.GetSize(), options, [data, &copy](size_t first, size_t last) {
+        std::fill(data + first, data + last, copy);
+    });
+}
+
+// Заменяет содержимое вектора count копиями value. Элементы создаются параллельно,
+// поэтому страницы нового буфера впервые касаются те же потоки, что будут с ними работать
+template <typename Type, typename Allocator, typename Growth>
+void ParallelAssign(SimpleVector<Type, Allocator, Growth>& v, size_t count, const Type& value, const ParallelOptions& options = {})
+{
+    const Type copy(value);
+    v.Clear();
+    v.AppendConstructed(count, [&](Allocator& alloc, Type* dest, size_t n) {
+        parallel_detail::ConstructChunks(alloc, dest, n, options,
+            [&copy](Allocator& a, Type* chunk, size_t, size_t k) {
+                UninitializedFillN(a, chunk, k, copy);
+            });
+    });
+}
+
+// Изменяет размер вектора. Новые элементы получают значение по умолчанию и создаются
+// параллельно - как и в ParallelAssign, это раскладывает страницы по узлам NUMA потоков пула
+template <typename Type, typename Allocator, typename Growth>
+void ParallelResize(SimpleVector<Type, Allocator, Growth>& v, size_t new_size, const ParallelOptions& options = {})
+{
+    if(new_size <= v.GetSize())
+    {
+        v.Resize(new_size);
+        return;
+    }
+    v.AppendConstructed(new_size - v.GetSize(), [&](Allocator& alloc, Type* dest, size_t n) {
+        parallel_detail::ConstructChunks(alloc, dest, n, options,
+            [](Allocator& a, Type* chunk, size_t, size_t k) {
+                UninitializedValueConstructN(a, chunk, k);
+            });
+    });
+}
+
+// Возвращает копию вектора, элементы которой копируются параллельно.
+// В отличие от конструктора копирования, вместимость копии равна её размеру
+template <typename Type, typename Allocator, typename Growth>
+SimpleVector<Type, Allocator, Growth> ParallelCopy(const SimpleVector<Type, Allocator, Growth>& other, const ParallelOptions& options = {})
+{
+    SimpleVector<Type, Allocator, Growth> result(
+        std::allocator_traits<Allocator>::select_on_container_copy_construction(other.GetAllocator()));
+    const Type* source = other.Data();
+    result.AppendConstructed(other.GetSize(), [&](Allocator& alloc, Type* dest, size_t n) {
+        parallel_detail::ConstructChunks(alloc, dest, n, options,
+            [source](Allocator& a, Type* chunk, size_t offset, size_t k) {
+                UninitializedCopy(a, source + offset, source + offset + k, chunk);
+            });
+    });
+    return result;
+}
+
+// Заменяет каждый элемент v результатом f(элемент)
+template <typename Type, typename Allocator, typename Growth, typename F>
+void ParallelTransform(SimpleVector<Type, Allocator, Growth>& v, F f, const ParallelOptions& options = {})
+{
+    Type* data = v.Data();
+    parallel_detail::ForEachChunk(v.GetSize(), options, [data, &f](size_t first, size_t last) {
+        std::transform(data + first, data + last, data + first, f);
+    });
+}
+
+// Заменяет содержимое dest результатами f(элемент source), по одному на каждый элемент
+template <typename Type, typename Allocator, typename Growth, typename Result, typename ResultAllocator, typename ResultGrowth, typename F>
+void ParallelTransform(const SimpleVector<Type, Allocator, Growth>& source, SimpleVector<Result, ResultAllocator, ResultGrowth>& dest, F f,
+                       const ParallelOptions& options = {})
+{
+    assert(static_cast<const void*>(&source) != static_cast<const void*>(&dest));
+    const Type* from = source.Data();
+    dest.Clear();
+    dest.AppendConstructed(source.GetSize(), [&](ResultAllocator& alloc, Result* to, size_t n) {
+        parallel_detail::ConstructChunks(alloc, to, n, options,
+            [from, &f](ResultAllocator& a, Result* chunk, size_t offset, size_t k) {
+                size_t done = 0;
+                try
+                {
+                    for(; done < k; ++done)
+                    {
+                        ConstructAt(a, chunk + done, f(from[offset + done]));
+                    }
+                }
+                catch(...)
+                {
+                    DestroyRange(a, chunk, chunk + done);
+                    throw;
+                }
+            });
+    });
+}
+
+// Сворачивает элементы операцией op, начиная с init. Как и у std::reduce, op должна быть
+// ассоциативной, а элементы - приводиться к Result. Куски сворачиваются независимо,
+// а их частичные результаты - по порядку, так что коммутативность op не требуется
+template <typename Type, typename Allocator, typename Growth, typename Result, typename BinaryOp = std::plus<>>
+Result ParallelReduce(const SimpleVector<Type, Allocator, Growth>& v, Result init, BinaryOp op = {},
+                      const ParallelOptions& options = {})
+{
+    const Type* data = v.Data();
+    if(parallel_detail::RunsSequentially(v.GetSize(), options))
+    {
+        return std::accumulate(data, data + v.GetSize(), std::move(init), op);
+    }
+    std::mutex partials_mutex;
+    std::vector<std::pair<size_t, Result>> partials;
+    parallel_detail::ForEachChunk(v.GetSize(), options, [&](size_t first, size_t last) {
+        if(first == last)
+        {
+            return;
+        }
+        Result partial = std::accumulate(data + first + 1, data + last, Result(data[first]), op);
+        std::lock_guard lock(partials_mutex);
+        partials.emplace_back(first, std::move(partial));
+    });
+    std::sort(partials.begin(), partials.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.first < rhs.first;
+    });
+    for(auto& partial : partials)
+    {
+        init = op(std::move(init), std::move(partial.second));
+    }
+    return init;
+}
+
+// Сортирует вектор. Куски сортируются std::sort в разных потоках и затем попарно
+// сливаются, причём каждое слияние тоже делится между потоками. Нужен временный
+// буфер размером с вектор
+template <typename Type, typename Allocator, typename Growth, typename Compare = std::less<>>
+void ParallelSort(SimpleVector<Type, Allocator, Growth>& v, Compare comp = {}, const ParallelOptions& options = {})
+{
+    if(parallel_detail::RunsSequentially(v.GetSize(), options))
+    {
+        std::sort(v.begin(), v.end(), comp);
+        return;
+    }
+    parallel_detail::SortWithBuffer(v, comp, options, [&comp](Type* first, Type* last) {
+        std::sort(first, last, comp);
+    });
+}
+
+// Сортирует вектор, сохраняя порядок равных элементов
+template <typename Type, typename Allocator, typename Growth, typename Compare = std::less<>>
+void ParallelStableSort(SimpleVector<Type, Allocator, Growth>& v, Compare comp = {}, const ParallelOptions& options = {})
+{
+    if(parallel_detail::RunsSequentially(v.GetSize(), options))
+    {
+        std::stable_sort(v.begin(), v.end(), comp);
+        return;
+    }
+    parallel_detail::SortWithBuffer(v, comp, options, [&comp](Type* first, Type* last) {
+        std::stable_sort(first, last, comp);
+    });
+}
@@ -0,0 +1,212 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include "constexpr_support.h"
+
+// Алгоритмы над неинициализированной памятью, которые создают и разрушают элементы
+// через std::allocator_traits<Allocator>. Так контейнер с std::pmr::polymorphic_allocator
+// передаёт свой ресурс памяти вложенным элементам (например, std::pmr::string).
+// При вычислении констант алгоритмы из <memory>, memcpy и memmove заменяются циклами
+
+// Признак тривиальной перемещаемости типа: объект можно перенести на новое место
+// побайтовым копированием, не вызывая конструктор перемещения и деструктор исходника.
+// По умолчанию верен для тривиально копируемых типов. Для своих типов (например,
+// владеющих указателем на кучу) признак можно включить специализацией:
+//     template <>
+//     struct IsTriviallyRelocatable<MyType> : std::true_type {};
+// Типы, хранящие указатели на самих себя, так помечать нельзя
+template <typename T>
+struct IsTriviallyRelocatable : std::is_trivially_copyable<T> {};
+
+template <typename T>
+inline constexpr bool kIsTriviallyRelocatable = IsTriviallyRelocatable<T>::value;
+
+// Истинно, если Allocator::construct сводится к обычному placement new,
+// и вместо поэлементного цикла можно звать алгоритмы из <memory>
+template <typename Allocator, typename T>
+inline constexpr bool kConstructsInPlace = std::is_same_v<Allocator, std::allocator<T>>
+    || (std::is_trivially_copyable_v<T> && !std::uses_allocator_v<T, Allocator>);
+
+template <typename Allocator, typename T, typename... Args>
+SIMPLE_VECTOR_CONSTEXPR void ConstructAt(Allocator& alloc, T* p, Args&&... args)
+{
+    std::allocator_traits<Allocator>::construct(alloc, p, std::forward<Args>(args)...);
+}
+
+template <typename Allocator, typename T>
+SIMPLE_VECTOR_CONSTEXPR void DestroyAt(Allocator& alloc, T* p) noexcept
+{
+    std::allocator_traits<Allocator>::destroy(alloc, p);
+}
+
+// Разрушает элементы [first, last)
+template <typename Allocator, typename T>
+SIMPLE_VECTOR_CONSTEXPR void DestroyRange(Allocator& alloc, T* first, T* last) noexcept
+{
+    if constexpr (kConstructsInPlace<Allocator, T> || std::is_trivially_destructible_v<T>)
+    {
+        if(!IsConstantEvaluated())
+        {
+            std::destroy(first, last);
+            return;
+        }
+    }
+    for(; first != last; ++first)
+    {
+        std::allocator_traits<Allocator>::destroy(alloc, first);
+    }
+}
+
+// Копирует [first, last) в сырую память dest. При исключении уже созданные копии разрушаются
+// Возвращает указатель за последним созданным элементом
+template <typename Allocator, typename InputIt, typename T>
+SIMPLE_VECTOR_CONSTEXPR T* UninitializedCopy(Allocator& alloc, InputIt first, InputIt last, T* dest)
+{
+    if constexpr (kConstructsInPlace<Allocator, T>)
+    {
+        if(!IsConstantEvaluated())
+        {
+            return std::uninitialized_copy(first, last, dest);
+        }
+    }
+    T* current = dest;
+    try
+    {
+        for(; first != last; ++first, ++current)
+        {
+            ConstructAt(alloc, current, *first);
+        }
+    }
+    catch(...)
+    {
+        DestroyRange(alloc, dest, current);
+        throw;
+    }
+    return current;
+}
+
+// Создаёт count копий value в сырой памяти dest
+template <typename Allocator, typename T>
+SIMPLE_VECTOR_CONSTEXPR T* UninitializedFillN(Allocator& alloc, T* dest, size_t count, const T& value)
+{
+    if constexpr (kConstructsInPlace<Allocator, T>)
+    {
+        if(!IsConstantEvaluated())
+        {
+            return std::uninitialized_fill_n(dest, count, value);
+        }
+    }
+    T* current = dest;
+    try
+    {
+        for(; count > 0; --count, ++current)
+        {
+            ConstructAt(alloc, current, value);
+        }
+    }
+    catch(...)
+    {
+        DestroyRange(alloc, dest, current);
+        throw;
+    }
+    return current;
+}
+
+// Создаёт count элементов со значением по умолчанию в сырой памяти dest
+template <typename Allocator, typename T>
+SIMPLE_VECTOR_CONSTEXPR T* UninitializedValueConstructN(Allocator& alloc, T* dest, size_t count)
+{
+    if constexpr (kConstructsInPlace<Allocator, T>)
+    {
+        if(!IsConstantEvaluated())
+        {
+            return std::uninitialized_value_construct_n(dest, count);
+        }
+    }
+    T* current = dest;
+    try
+    {
+        for(; count > 0; --count, ++current)
+        {
+            ConstructAt(alloc, current);
+        }
+    }
+    catch(...)
+    {
+        DestroyRange(alloc, dest, current);
+        throw;
+    }
+    return current;
+}
+
+// Переносит [first, last) в сырую память dest, не разрушая исходные элементы.
+// Перемещает, если перемещение не бросает исключений (или копирование невозможно),
+// иначе копирует, чтобы при исключении исходные элементы остались целыми
+template <typename Allocator, typename T>
+SIMPLE_VECTOR_CONSTEXPR void UninitializedMoveIfNoexcept(Allocator& alloc, T* first, T* last, T* dest)
+{
+    if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>)
+    {
+        UninitializedCopy(alloc, std::make_move_iterator(first), std::make_move_iterator(last), dest);
+    }
+    else
+    {
+        UninitializedCopy(alloc, first, last, dest);
+    }
+}
+
+// Истинно, если перенос элементов T в новый буфер идёт копированием: T не тривиально
+// перемещаем, а его перемещение может бросить исключение
+template <typename T>
+inline constexpr bool kRelocatesByCopy = !kIsTriviallyRelocatable<T>
+    && !std::is_nothrow_move_constructible_v<T> && std::is_copy_constructible_v<T>;
+
+// Переносит [first, last) в сырую память dest, после чего исходные ячейки считаются
+// неинициализированными. Диапазоны не должны пересекаться.
+// Для тривиально перемещаемых типов это один memcpy
+template <typename Allocator, typename T>
+SIMPLE_VECTOR_CONSTEXPR void UninitializedRelocate(Allocator& alloc, T* first, T* last, T* dest)
+{
+    if constexpr (kIsTriviallyRelocatable<T>)
+    {
+        if(!IsConstantEvaluated())
+        {
+            if(first != last)
+            {
+                std::memcpy(static_cast<void*>(dest), static_cast<const void*>(first), static_cast<size_t>(last - first) * sizeof(T));
+            }
+            return;
+        }
+    }
+    UninitializedMoveIfNoexcept(alloc, first, last, dest);
+    DestroyRange(alloc, first, last);
+}
+
+// Побайтово сдвигает count тривиально перемещаемых объектов из first в dest.
+// Диапазоны могут пересекаться
+template <typename T>
+SIMPLE_VECTOR_CONSTEXPR void RelocateOverlapping(T* first, size_t count, T* dest) noexcept
+{
+    static_assert(kIsTriviallyRelocatable<T>);
+    if(IsConstantEvaluated())
+    {
+        // Каждый объект переезжает перемещением; порядок обхода не даёт затереть
+        // ещё не перенесённые объекты пересекающегося диапазона
+        std::allocator<T> alloc;
+        for(size_t i = 0; i < count; ++i)
+        {
+            const size_t k = dest < first ? i : count - 1 - i;
+            ConstructAt(alloc, dest + k, std::move(first[k]));
+            DestroyAt(alloc, first + k);
+        }
+        return;
+    }
+    if(count != 0)
+    {
+        std::memmove(static_cast<void*>(dest), static_cast<const void*>(first), count * sizeof(T));
+    }
+}
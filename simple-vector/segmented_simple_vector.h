@@ -0,0 +1,593 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "relocation.h"
+#include "simd_kernels.h"
+#include "simple_vector.h"
+
+// Число элементов в блоке SegmentedSimpleVector по умолчанию: степень двойки,
+// при которой блок занимает около 16 КБ, но не меньше 16 элементов
+template <typename Type>
+constexpr size_t DefaultSegmentBits() noexcept
+{
+    size_t bits = 4;
+    while((sizeof(Type) << (bits + 1)) <= 16384)
+    {
+        ++bits;
+    }
+    return bits;
+}
+
+// Вектор из блоков фиксированного размера 2^BlockBits элементов и таблицы указателей
+// на блоки. Элементы никогда не переносятся: рост выделяет ещё один блок и дописывает
+// указатель в таблицу, поэтому ссылки и указатели на элементы остаются действительными
+// до их удаления, а время PushBack не зависит от размера вектора. Переезжает при росте
+// только таблица - по 8 байтов на блок, то есть в BlockSize раз меньше данных, чем у
+// SimpleVector.
+//
+// Доступ по индексу - сдвиг, маска и одно лишнее чтение из таблицы. Итераторы хранят
+// вектор и индекс, поэтому тоже переживают рост. PopBack и Clear не освобождают
+// блоки: их отдаёт ShrinkToFit
+template <typename Type, size_t BlockBits = DefaultSegmentBits<Type>(), typename Allocator = std::allocator<Type>>
+class SegmentedSimpleVector {
+    using AllocTraits = std::allocator_traits<Allocator>;
+    using BlockTable = SimpleVector<Type*, typename AllocTraits::template rebind_alloc<Type*>>;
+
+    template <typename Owner, typename Value>
+    class BasicIterator;
+
+public:
+    using Iterator = BasicIterator<SegmentedSimpleVector, Type>;
+    using ConstIterator = BasicIterator<const SegmentedSimpleVector, const Type>;
+    using AllocatorType = Allocator;
+
+    static constexpr size_t kBlockBits = BlockBits;
+    static constexpr size_t kBlockSize = size_t{1} << BlockBits;
+
+    SegmentedSimpleVector() noexcept = default;
+
+    explicit SegmentedSimpleVector(const Allocator& alloc) noexcept
+    : table_(typename BlockTable::AllocatorType(alloc))
+    , alloc_(alloc)
+    {}
+
+    // Создаёт вектор из size элементов, инициализированных значением по умолчанию
+    explicit SegmentedSimpleVector(size_t size, const Allocator& alloc = Allocator())
+    : SegmentedSimpleVector(alloc)
+    {
+        Resize(size);
+    }
+
+    SegmentedSimpleVector(size_t size, const Type& value, const Allocator& alloc = Allocator())
+    : SegmentedSimpleVector(alloc)
+    {
+        AppendWith(size, [&value](Allocator& a, Type* dest, size_t, size_t n) {
+            UninitializedFillN(a, dest, n, value);
+        });
+    }
+
+    SegmentedSimpleVector(std::initializer_list<Type> init, const Allocator& alloc = Allocator())
+    : SegmentedSimpleVector(alloc)
+    {
+        AppendWith(init.size(), [&init](Allocator& a, Type* dest, size_t offset, size_t n) {
+            UninitializedCopy(a, init.begin() + offset, init.begin() + offset + n, dest);
+        });
+    }
+
+    SegmentedSimpleVector(const SegmentedSimpleVector& other)
+    : SegmentedSimpleVector(other, AllocTraits::select_on_container_copy_construction(other.alloc_))
+    {}
+
+    // Копирует other, выделяя блоки через alloc
+    SegmentedSimpleVector(const SegmentedSimpleVector& other, const Allocator& alloc)
+    : SegmentedSimpleVector(alloc)
+    {
+        AppendWith(other.size_, [&other](Allocator& a, Type* dest, size_t offset, size_t n) {
+            const Type* source = &other[offset];
+            UninitializedCopy(a, source, source + n, dest);
+        });
+    }
+
+    // Перемещение забирает таблицу блоков, элементы не трогаются
+    SegmentedSimpleVector(SegmentedSimpleVector&& other) noexcept
+    : table_(std::move(other.table_))
+    , size_(std::exchange(other.size_, 0))
+    , alloc_(std::move(other.alloc_))
+    {}
+
+    // Перемещает other в вектор с аллокатором alloc. Если аллокаторы не равны,
+    // блоки забрать нельзя, и элементы переносятся по одному
+    SegmentedSimpleVector(SegmentedSimpleVector&& other, const Allocator& alloc)
+    : SegmentedSimpleVector(alloc)
+    {
+        if(alloc_ == other.alloc_)
+        {
+            StealFrom(other);
+            return;
+        }
+        AppendWith(other.size_, [&other](Allocator& a, Type* dest, size_t offset, size_t n) {
+            Type* source = &other[offset];
+            UninitializedCopy(a, std::make_move_iterator(source), std::make_move_iterator(source + n), dest);
+        });
+    }
+
+    SegmentedSimpleVector& operator=(const SegmentedSimpleVector& rhs)
+    {
+        if(this != &rhs)
+        {
+            // Копия строится сразу нужным аллокатором, а затем забирается перемещением
+            SegmentedSimpleVector copy(rhs, AllocTraits::propagate_on_container_copy_assignment::value ? rhs.alloc_ : alloc_);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    SegmentedSimpleVector& operator=(SegmentedSimpleVector&& rhs) noexcept(AllocTraits::propagate_on_container_move_assignment::value
+                                                                           || AllocTraits::is_always_equal::value)
+    {
+        if(this == &rhs)
+        {
+            return *this;
+        }
+        if constexpr (AllocTraits::propagate_on_container_move_assignment::value || AllocTraits::is_always_equal::value)
+        {
+            StealFrom(rhs);
+        }
+        else if(alloc_ == rhs.alloc_)
+        {
+            StealFrom(rhs);
+        }
+        else
+        {
+            // Блоки rhs освобождаются чужим ресурсом, поэтому элементы переносятся в наши
+            SegmentedSimpleVector temp(std::move(rhs), alloc_);
+            StealFrom(temp);
+        }
+        return *this;
+    }
+
+    ~SegmentedSimpleVector()
+    {
+        Clear();
+        ReleaseBlocks(0);
+    }
+
+    // Если аллокатор не переезжает при обмене, аллокаторы векторов должны быть равны
+    void swap(SegmentedSimpleVector& other) noexcept
+    {
+        table_.swap(other.table_);
+        std::swap(size_, other.size_);
+        if constexpr (AllocTraits::propagate_on_container_swap::value)
+        {
+            using std::swap;
+            swap(alloc_, other.alloc_);
+        }
+    }
+
+    Allocator GetAllocator() const noexcept
+    {
+        return alloc_;
+    }
+
+    size_t GetSize() const noexcept
+    {
+        return size_;
+    }
+
+    // Вместимость - все выделенные блоки
+    size_t GetCapacity() const noexcept
+    {
+        return table_.GetSize() * kBlockSize;
+    }
+
+    bool IsEmpty() const noexcept
+    {
+        return size_ == 0;
+    }
+
+    Type& operator[](size_t index) noexcept
+    {
+        assert(index < size_);
+        return table_[index >> kBlockBits][index & (kBlockSize - 1)];
+    }
+
+    const Type& operator[](size_t index) const noexcept
+    {
+        assert(index < size_);
+        return table_[index >> kBlockBits][index & (kBlockSize - 1)];
+    }
+
+    // Выбрасывает исключение std::out_of_range, если index >= size
+    Type& At(size_t index)
+    {
+        if(index >= size_)
+        {
+            throw std::out_of_range("Index is out of range");
+        }
+        return (*this)[index];
+    }
+
+    const Type& At(size_t index) const
+    {
+        if(index >= size_)
+        {
+            throw std::out_of_range("Index is out of range");
+        }
+        return (*this)[index];
+    }
+
+    // Создаёт элемент в конце вектора. Старые элементы не переносятся, поэтому args
+    // могут ссылаться на элементы самого вектора. Возвращает ссылку на новый элемент
+    template <typename... Args>
+    Type& EmplaceBack(Args&&... args)
+    {
+        if(size_ == GetCapacity())
+        {
+            AddBlock();
+        }
+        Type* slot = table_[size_ >> kBlockBits] + (size_ & (kBlockSize - 1));
+        ConstructAt(alloc_, slot, std::forward<Args>(args)...);
+        ++size_;
+        return *slot;
+    }
+
+    void PushBack(const Type& element)
+    {
+        EmplaceBack(element);
+    }
+
+    void PushBack(Type&& element)
+    {
+        EmplaceBack(std::move(element));
+    }
+
+    void PopBack() noexcept
+    {
+        assert(size_ != 0);
+        --size_;
+        DestroyAt(alloc_, table_[size_ >> kBlockBits] + (size_ & (kBlockSize - 1)));
+    }
+
+    // Выделяет блоки, покрывающие capacity элементов
+    void Reserve(size_t capacity)
+    {
+        if(capacity > GetCapacity())
+        {
+            table_.Reserve(BlocksFor(capacity));
+            while(GetCapacity() < capacity)
+            {
+                AddBlock();
+            }
+        }
+    }
+
+    // Изменяет размер. Новые элементы получают значение по умолчанию.
+    // Если создание элемента бросит исключение, размер останется прежним
+    void Resize(size_t new_size)
+    {
+        if(new_size > size_)
+        {
+            AppendWith(new_size - size_, [](Allocator& a, Type* dest, size_t, size_t n) {
+                UninitializedValueConstructN(a, dest, n);
+            });
+            return;
+        }
+        DestroyTail(new_size);
+    }
+
+    // Разрушает элементы, сохраняя блоки
+    void Clear() noexcept
+    {
+        DestroyTail(0);
+    }
+
+    // Освобождает блоки за последним элементом и ужимает таблицу
+    void ShrinkToFit()
+    {
+        ReleaseBlocks(BlocksFor(size_));
+        table_.ShrinkToFit();
+    }
+
+    Iterator begin() noexcept
+    {
+        return Iterator(this, 0);
+    }
+
+    Iterator end() noexcept
+    {
+        return Iterator(this, size_);
+    }
+
+    ConstIterator begin() const noexcept
+    {
+        return ConstIterator(this, 0);
+    }
+
+    ConstIterator end() const noexcept
+    {
+        return ConstIterator(this, size_);
+    }
+
+    ConstIterator cbegin() const noexcept
+    {
+        return begin();
+    }
+
+    ConstIterator cend() const noexcept
+    {
+        return end();
+    }
+
+    // Вызывает f(first, count) для каждого непрерывного куска элементов по порядку.
+    // Циклы по кускам не платят за пересчёт индекса на каждом элементе
+    template <typename F>
+    void ForEachBlock(F f) const
+    {
+        for(size_t start = 0; start < size_; start += kBlockSize)
+        {
+            f(static_cast<const Type*>(table_[start >> kBlockBits]), std::min(kBlockSize, size_ - start));
+        }
+    }
+
+    template <typename F>
+    void ForEachBlock(F f)
+    {
+        for(size_t start = 0; start < size_; start += kBlockSize)
+        {
+            f(table_[start >> kBlockBits], std::min(kBlockSize, size_ - start));
+        }
+    }
+
+private:
+    static size_t BlocksFor(size_t count) noexcept
+    {
+        return (count + kBlockSize - 1) >> kBlockBits;
+    }
+
+    // Уничтожает свои элементы и блоки и забирает таблицу other. Аллокаторы должны быть
+    // равны, либо аллокатор other должен переезжать при перемещающем присваивании
+    void StealFrom(SegmentedSimpleVector& other) noexcept
+    {
+        Clear();
+        ReleaseBlocks(0);
+        table_ = std::move(other.table_);
+        size_ = std::exchange(other.size_, 0);
+        if constexpr (AllocTraits::propagate_on_container_move_assignment::value)
+        {
+            alloc_ = std::move(other.alloc_);
+        }
+    }
+
+    // Дописывает в таблицу новый блок. Если таблица не смогла вырасти, блок освобождается
+    void AddBlock()
+    {
+        Type* block = AllocTraits::allocate(alloc_, kBlockSize);
+        try
+        {
+            table_.PushBack(block);
+        }
+        catch(...)
+        {
+            AllocTraits::deallocate(alloc_, block, kBlockSize);
+            throw;
+        }
+    }
+
+    // Освобождает блоки с номерами от first_block. Элементов в них быть не должно
+    void ReleaseBlocks(size_t first_block) noexcept
+    {
+        while(table_.GetSize() > first_block)
+        {
+            AllocTraits::deallocate(alloc_, table_[table_.GetSize() - 1], kBlockSize);
+            table_.PopBack();
+        }
+    }
+
+    // Разрушает элементы [new_size, size_)
+    void DestroyTail(size_t new_size) noexcept
+    {
+        while(size_ > new_size)
+        {
+            const size_t block_start = (size_ - 1) & ~(kBlockSize - 1);
+            const size_t first = std::max(block_start, new_size);
+            Type* block = table_[block_start >> kBlockBits];
+            DestroyRange(alloc_, block + (first - block_start), block + (size_ - block_start));
+            size_ = first;
+        }
+    }
+
+    // Дописывает count элементов, которые construct(alloc, dest, offset, n) создаёт
+    // кусками в сырой памяти блоков; offset - номер первого элемента куска среди новых.
+    // При исключении созданные элементы разрушаются, а размер остаётся прежним
+    template <typename Construct>
+    void AppendWith(size_t count, Construct construct)
+    {
+        const size_t old_size = size_;
+        Reserve(size_ + count);
+        try
+        {
+            while(size_ < old_size + count)
+            {
+                const size_t offset_in_block = size_ & (kBlockSize - 1);
+                const size_t n = std::min(kBlockSize - offset_in_block, old_size + count - size_);
+                construct(alloc_, table_[size_ >> kBlockBits] + offset_in_block, size_ - old_size, n);
+                size_ += n;
+            }
+        }
+        catch(...)
+        {
+            DestroyTail(old_size);
+            throw;
+        }
+    }
+
+    // Итератор произвольного доступа по индексу. Ростом вектора не инвалидируется
+    template <typename Owner, typename Value>
+    class BasicIterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = std::remove_const_t<Value>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Value*;
+        using reference = Value&;
+
+        BasicIterator() = default;
+
+        BasicIterator(Owner* owner, size_t index) noexcept
+        : owner_(owner)
+        , index_(index)
+        {}
+
+        // Неконстантный итератор приводится к константному
+        template <typename OtherOwner, typename OtherValue,
+                  typename = std::enable_if_t<std::is_convertible_v<OtherValue*, Value*>>>
+        BasicIterator(const BasicIterator<OtherOwner, OtherValue>& other) noexcept
+        : owner_(other.owner_)
+        , index_(other.index_)
+        {}
+
+        reference operator*() const noexcept { return (*owner_)[index_]; }
+        pointer operator->() const noexcept { return &(*owner_)[index_]; }
+        reference operator[](difference_type n) const noexcept { return (*owner_)[index_ + n]; }
+
+        BasicIterator& operator++() noexcept { ++index_; return *this; }
+        BasicIterator operator++(int) noexcept { BasicIterator old = *this; ++index_; return old; }
+        BasicIterator& operator--() noexcept { --index_; return *this; }
+        BasicIterator operator--(int) noexcept { BasicIterator old = *this; --index_; return old; }
+        BasicIterator& operator+=(difference_type n) noexcept { index_ += n; return *this; }
+        BasicIterator& operator-=(difference_type n) noexcept { index_ -= n; return *this; }
+        BasicIterator operator+(difference_type n) const noexcept { return BasicIterator(owner_, index_ + n); }
+        BasicIterator operator-(difference_type n) const noexcept { return BasicIterator(owner_, index_ - n); }
+        friend BasicIterator operator+(difference_type n, const BasicIterator& it) noexcept { return it + n; }
+        difference_type operator-(const BasicIterator& other) const noexcept
+        {
+            return static_cast<difference_type>(index_) - static_cast<difference_type>(other.index_);
+        }
+
+        bool operator==(const BasicIterator& other) const noexcept { return index_ == other.index_; }
+        bool operator!=(const BasicIterator& other) const noexcept { return index_ != other.index_; }
+        bool operator<(const BasicIterator& other) const noexcept { return index_ < other.index_; }
+        bool operator>(const BasicIterator& other) const noexcept { return index_ > other.index_; }
+        bool operator<=(const BasicIterator& other) const noexcept { return index_ <= other.index_; }
+        bool operator>=(const BasicIterator& other) const noexcept { return index_ >= other.index_; }
+
+    private:
+        template <typename, typename>
+        friend class BasicIterator;
+
+        Owner* owner_ = nullptr;
+        size_t index_ = 0;
+    };
+
+    BlockTable table_;
+    size_t size_ = 0;
+    [[no_unique_address]] Allocator alloc_;
+};
+
+namespace segmented_detail {
+
+// Блоки обоих векторов начинаются с одних и тех же индексов, поэтому сравнение
+// идёт блок за блоком теми же однопроходными функциями, что и у SimpleVector.
+// Для каждого общего куска вызывает compare(lhs, rhs, n) и возвращает первый ненулевой
+// результат или нулевой, если общая часть совпала
+template <typename Type, size_t BlockBits, typename Allocator, typename Result, typename Compare>
+Result CompareBlocks(const SegmentedSimpleVector<Type, BlockBits, Allocator>& lhs,
+                     const SegmentedSimpleVector<Type, BlockBits, Allocator>& rhs, Result zero, Compare compare)
+{
+    constexpr size_t kBlockSize = SegmentedSimpleVector<Type, BlockBits, Allocator>::kBlockSize;
+    const size_t common = std::min(lhs.GetSize(), rhs.GetSize());
+    for(size_t start = 0; start < common; start += kBlockSize)
+    {
+        const Result result = compare(&lhs[start], &rhs[start], std::min(kBlockSize, common - start));
+        if(result != 0)
+        {
+            return result;
+        }
+    }
+    return zero;
+}
+
+} // namespace segmented_detail
+
+template <typename Type, size_t BlockBits, typename Allocator>
+bool operator==(const SegmentedSimpleVector<Type, BlockBits, Allocator>& lhs,
+                const SegmentedSimpleVector<Type, BlockBits, Allocator>& rhs) {
+    if(lhs.GetSize() != rhs.GetSize())
+    {
+        return false;
+    }
+    return segmented_detail::CompareBlocks(lhs, rhs, 0, [](const Type* a, const Type* b, size_t n) {
+        return RangeEqual(a, b, n) ? 0 : 1;
+    }) == 0;
+}
+
+template <typename Type, size_t BlockBits, typename Allocator>
+bool operator!=(const SegmentedSimpleVector<Type, BlockBits, Allocator>& lhs,
+                const SegmentedSimpleVector<Type, BlockBits, Allocator>& rhs) {
+    return !(lhs == rhs);
+}
+
+// Результат сравнения как у RangeCompare: отрицательный, ноль или положительный
+template <typename Type, size_t BlockBits, typename Allocator>
+int Compare(const SegmentedSimpleVector<Type, BlockBits, Allocator>& lhs,
+            const SegmentedSimpleVector<Type, BlockBits, Allocator>& rhs) {
+    const int result = segmented_detail::CompareBlocks(lhs, rhs, 0, [](const Type* a, const Type* b, size_t n) {
+        return RangeCompare(a, n, b, n);
+    });
+    if(result != 0)
+    {
+        return result;
+    }
+    return lhs.GetSize() < rhs.GetSize() ? -1 : (lhs.GetSize() > rhs.GetSize() ? 1 : 0);
+}
+
+template <typename Type, size_t BlockBits, typename Allocator>
+bool operator<(const SegmentedSimpleVector<Type, BlockBits, Allocator>& lhs,
+               const SegmentedSimpleVector<Type, BlockBits, Allocator>& rhs) {
+    return Compare(lhs, rhs) < 0;
+}
+
+template <typename Type, size_t BlockBits, typename Allocator>
+bool operator>(const SegmentedSimpleVector<Type, BlockBits, Allocator>& lhs,
+               const SegmentedSimpleVector<Type, BlockBits, Allocator>& rhs) {
+    return Compare(lhs, rhs) > 0;
+}
+
+template <typename Type, size_t BlockBits, typename Allocator>
+bool operator<=(const SegmentedSimpleVector<Type, BlockBits, Allocator>& lhs,
+                const SegmentedSimpleVector<Type, BlockBits, Allocator>& rhs) {
+    return Compare(lhs, rhs) <= 0;
+}
+
+template <typename Type, size_t BlockBits, typename Allocator>
+bool operator>=(const SegmentedSimpleVector<Type, BlockBits, Allocator>& lhs,
+                const SegmentedSimpleVector<Type, BlockBits, Allocator>& rhs) {
+    return Compare(lhs, rhs) >= 0;
+}
+
+#if defined(__cpp_impl_three_way_comparison) && defined(__cpp_lib_three_way_comparison)
+template <typename Type, size_t BlockBits, typename Allocator>
+SynthThreeWayResult<Type> operator<=>(const SegmentedSimpleVector<Type, BlockBits, Allocator>& lhs,
+                                      const SegmentedSimpleVector<Type, BlockBits, Allocator>& rhs) {
+    const size_t common = std::min(lhs.GetSize(), rhs.GetSize());
+    constexpr size_t kBlockSize = SegmentedSimpleVector<Type, BlockBits, Allocator>::kBlockSize;
+    for(size_t start = 0; start < common; start += kBlockSize)
+    {
+        const size_t n = std::min(kBlockSize, common - start);
+        const SynthThreeWayResult<Type> result = RangeCompareThreeWay(&lhs[start], n, &rhs[start], n);
+        if(result != 0)
+        {
+            return result;
+        }
+    }
+    return lhs.GetSize() <=> rhs.GetSize();
+}
+#endif
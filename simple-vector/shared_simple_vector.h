@@ -0,0 +1,360 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <utility>
+#include "simple_vector.h"
+
+// Вектор с копированием при записи. Копия SharedSimpleVector не копирует элементы,
+// а разделяет с оригиналом буфер и атомарный счётчик ссылок, так что снимок
+// вектора стоит O(1). Первое изменение копии, буфер которой кому-то ещё нужен,
+// отделяет её: элементы копируются в собственный буфер, и дальше копия меняется сама.
+//
+// Изменяющими считаются все неконстантные методы, в том числе operator[], At, begin
+// и end. Чтобы читать неконстантный вектор, не отделяя его, используйте cbegin/cend,
+// Get() или std::as_const.
+//
+// Как и у std::shared_ptr, разные объекты SharedSimpleVector можно читать, копировать,
+// изменять и разрушать из разных потоков, даже если они разделяют буфер. Один и тот же
+// объект требует внешней синхронизации, если хотя бы один поток его изменяет.
+// Ссылки и итераторы, полученные через неконстантный доступ, нельзя использовать
+// после того, как с вектора снята копия: запись через них попала бы в общий буфер
+template <typename Type, typename Allocator = std::allocator<Type>>
+class SharedSimpleVector {
+    using Vector = SimpleVector<Type, Allocator>;
+
+    struct Block {
+        explicit Block(Vector&& v)
+        : vector(std::move(v))
+        {}
+
+        std::atomic<size_t> refs = 1;
+        Vector vector;
+    };
+
+    using BlockAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Block>;
+    using BlockTraits = std::allocator_traits<BlockAllocator>;
+
+public:
+    using Iterator = Type*;
+    using ConstIterator = const Type*;
+    using AllocatorType = Allocator;
+
+    SharedSimpleVector() noexcept = default;
+
+    // Забирает элементы v без копирования
+    explicit SharedSimpleVector(Vector v)
+    : block_(MakeBlock(std::move(v)))
+    {}
+
+    SharedSimpleVector(std::initializer_list<Type> init)
+    : SharedSimpleVector(Vector(init))
+    {}
+
+    // Разделяет буфер с other: элементы не копируются
+    SharedSimpleVector(const SharedSimpleVector& other) noexcept
+    : block_(other.block_)
+    {
+        if(block_ != nullptr)
+        {
+            block_->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    SharedSimpleVector(SharedSimpleVector&& other) noexcept
+    : block_(std::exchange(other.block_, nullptr))
+    {}
+
+    SharedSimpleVector& operator=(const SharedSimpleVector& rhs) noexcept
+    {
+        SharedSimpleVector(rhs).swap(*this);
+        return *this;
+    }
+
+    SharedSimpleVector& operator=(SharedSimpleVector&& rhs) noexcept
+    {
+        SharedSimpleVector(std::move(rhs)).swap(*this);
+        return *this;
+    }
+
+    ~SharedSimpleVector()
+    {
+        Release(block_);
+    }
+
+    // Возвращает элементы как обычный SimpleVector, доступный только для чтения
+    const Vector& Get() const noexcept
+    {
+        if(block_ == nullptr)
+        {
+            static const Vector empty;
+            return empty;
+        }
+        return block_->vector;
+    }
+
+    // Сколько объектов разделяют буфер. Для пустого вектора без буфера - 0
+    size_t UseCount() const noexcept
+    {
+        return block_ == nullptr ? 0 : block_->refs.load(std::memory_order_acquire);
+    }
+
+    size_t GetSize() const noexcept
+    {
+        return Get().GetSize();
+    }
+
+    size_t GetCapacity() const noexcept
+    {
+        return Get().GetCapacity();
+    }
+
+    bool IsEmpty() const noexcept
+    {
+        return Get().IsEmpty();
+    }
+
+    const Type& operator[](size_t index) const noexcept
+    {
+        return Get()[index];
+    }
+
+    // Отделяет вектор, если буфер общий
+    Type& operator[](size_t index)
+    {
+        assert(index < GetSize());
+        return Mutate([index](Vector& v) -> Type& { return v[index]; });
+    }
+
+    const Type& At(size_t index) const
+    {
+        return Get().At(index);
+    }
+
+    Type& At(size_t index)
+    {
+        Get().At(index);
+        return (*this)[index];
+    }
+
+    ConstIterator begin() const noexcept
+    {
+        return Get().Data();
+    }
+
+    ConstIterator end() const noexcept
+    {
+        return Get().Data() + GetSize();
+    }
+
+    ConstIterator cbegin() const noexcept
+    {
+        return Get().Data();
+    }
+
+    ConstIterator cend() const noexcept
+    {
+        return Get().Data() + GetSize();
+    }
+
+    // Отделяет вектор, если буфер общий
+    Iterator begin()
+    {
+        return Mutate([](Vector& v) { return v.Data(); });
+    }
+
+    Iterator end()
+    {
+        return Mutate([](Vector& v) { return v.Data() + v.GetSize(); });
+    }
+
+    template <typename... Args>
+    Type& EmplaceBack(Args&&... args)
+    {
+        return Mutate([&](Vector& v) -> Type& { return v.EmplaceBack(std::forward<Args>(args)...); });
+    }
+
+    void PushBack(const Type& value)
+    {
+        EmplaceBack(value);
+    }
+
+    void PushBack(Type&& value)
+    {
+        EmplaceBack(std::move(value));
+    }
+
+    void PopBack()
+    {
+        assert(!IsEmpty());
+        Mutate([](Vector& v) { v.PopBack(); });
+    }
+
+    // pos может указывать в общий буфер: после отделения он пересчитывается в новый
+    Iterator Insert(ConstIterator pos, const Type& value)
+    {
+        const size_t index = IndexOf(pos);
+        return Mutate([&](Vector& v) { v.Insert(v.cbegin() + index, value); return v.Data() + index; });
+    }
+
+    Iterator Insert(ConstIterator pos, Type&& value)
+    {
+        const size_t index = IndexOf(pos);
+        return Mutate([&](Vector& v) { v.Insert(v.cbegin() + index, std::move(value)); return v.Data() + index; });
+    }
+
+    Iterator Insert(ConstIterator pos, size_t count, const Type& value)
+    {
+        const size_t index = IndexOf(pos);
+        return Mutate([&](Vector& v) { v.Insert(v.cbegin() + index, count, value); return v.Data() + index; });
+    }
+
+    Iterator Erase(ConstIterator pos)
+    {
+        const size_t index = IndexOf(pos);
+        return Mutate([index](Vector& v) { v.Erase(v.cbegin() + index); return v.Data() + index; });
+    }
+
+    Iterator Erase(ConstIterator first, ConstIterator last)
+    {
+        const size_t index = IndexOf(first);
+        const size_t count = static_cast<size_t>(last - first);
+        return Mutate([index, count](Vector& v) {
+            v.Erase(v.cbegin() + index, v.cbegin() + index + count);
+            return v.Data() + index;
+        });
+    }
+
+    void Resize(size_t new_size)
+    {
+        Mutate([new_size](Vector& v) { v.Resize(new_size); });
+    }
+
+    void Reserve(size_t new_capacity)
+    {
+        Mutate([new_capacity](Vector& v) { v.Reserve(new_capacity); });
+    }
+
+    // Общий буфер не копируется, а просто отпускается
+    void Clear() noexcept
+    {
+        if(UseCount() > 1)
+        {
+            Release(std::exchange(block_, nullptr));
+        }
+        else if(block_ != nullptr)
+        {
+            block_->vector.Clear();
+        }
+    }
+
+    void swap(SharedSimpleVector& other) noexcept
+    {
+        std::swap(block_, other.block_);
+    }
+
+private:
+    // Отпускает блок при выходе из области видимости
+    struct BlockHolder {
+        ~BlockHolder()
+        {
+            Release(block);
+        }
+        Block* block;
+    };
+
+    static Block* MakeBlock(Vector&& v)
+    {
+        BlockAllocator alloc(v.GetAllocator());
+        Block* block = BlockTraits::allocate(alloc, 1);
+        try
+        {
+            BlockTraits::construct(alloc, block, std::move(v));
+        }
+        catch(...)
+        {
+            BlockTraits::deallocate(alloc, block, 1);
+            throw;
+        }
+        return block;
+    }
+
+    // Последний владелец разрушает блок. acq_rel упорядочивает чтения прежних
+    // владельцев перед разрушением, а acquire в Detach - перед записью нового владельца
+    static void Release(Block* block) noexcept
+    {
+        if(block != nullptr && block->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            BlockAllocator alloc(block->vector.GetAllocator());
+            BlockTraits::destroy(alloc, block);
+            BlockTraits::deallocate(alloc, block, 1);
+        }
+    }
+
+    size_t IndexOf(ConstIterator pos) const noexcept
+    {
+        assert(pos >= cbegin() && pos <= cend());
+        return static_cast<size_t>(pos - cbegin());
+    }
+
+    // Делает буфер собственным и вызывает f для него. Прежний общий блок отпускается
+    // только после f, потому что аргументы f могут ссылаться на его элементы
+    template <typename F>
+    decltype(auto) Mutate(F f)
+    {
+        BlockHolder shared{nullptr};
+        if(block_ == nullptr)
+        {
+            block_ = MakeBlock(Vector());
+        }
+        else if(block_->refs.load(std::memory_order_acquire) != 1)
+        {
+            Block* copy = MakeBlock(Vector(block_->vector));
+            shared.block = std::exchange(block_, copy);
+        }
+        return f(block_->vector);
+    }
+
+    Block* block_ = nullptr;
+};
+
+template <typename Type, typename Allocator>
+bool operator==(const SharedSimpleVector<Type, Allocator>& lhs, const SharedSimpleVector<Type, Allocator>& rhs) {
+    return lhs.Get() == rhs.Get();
+}
+
+template <typename Type, typename Allocator>
+bool operator!=(const SharedSimpleVector<Type, Allocator>& lhs, const SharedSimpleVector<Type, Allocator>& rhs) {
+    return !(lhs == rhs);
+}
+
+template <typename Type, typename Allocator>
+bool operator<(const SharedSimpleVector<Type, Allocator>& lhs, const SharedSimpleVector<Type, Allocator>& rhs) {
+    return lhs.Get() < rhs.Get();
+}
+
+template <typename Type, typename Allocator>
+bool operator>(const SharedSimpleVector<Type, Allocator>& lhs, const SharedSimpleVector<Type, Allocator>& rhs) {
+    return lhs.Get() > rhs.Get();
+}
+
+template <typename Type, typename Allocator>
+bool operator<=(const SharedSimpleVector<Type, Allocator>& lhs, const SharedSimpleVector<Type, Allocator>& rhs) {
+    return lhs.Get() <= rhs.Get();
+}
+
+template <typename Type, typename Allocator>
+bool operator>=(const SharedSimpleVector<Type, Allocator>& lhs, const SharedSimpleVector<Type, Allocator>& rhs) {
+    return lhs.Get() >= rhs.Get();
+}
+
+#if defined(__cpp_impl_three_way_comparison) && defined(__cpp_lib_three_way_comparison)
+template <typename Type, typename Allocator>
+SynthThreeWayResult<Type> operator<=>(const SharedSimpleVector<Type, Allocator>& lhs,
+                                      const SharedSimpleVector<Type, Allocator>& rhs) {
+    return lhs.Get() <=> rhs.Get();
+}
+#endif
@@ -0,0 +1,883 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include "constexpr_support.h"
+
+#if defined(__cpp_impl_three_way_comparison)
+#include <compare>
+#endif
+#if __has_include(<bit>)
+#include <bit>
+#endif
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define SIMPLE_VECTOR_X86_SIMD 1
+#include <immintrin.h>
+#else
+#define SIMPLE_VECTOR_X86_SIMD 0
+#endif
+
+// Векторные ядра для сравнения и поиска в массивах целых чисел. Ядра для AVX2 и SSE4.2
+// собираются атрибутом target, а нужное выбирается при первом вызове по возможностям
+// процессора, так что бинарник, собранный без -mavx2, всё равно использует AVX2.
+// На других архитектурах и компиляторах остаются скалярные циклы.
+//
+// Поверх ядер построены алгоритмы Range*, которыми пользуются контейнеры. Для прочих
+// типов и при вычислении констант они сводятся к обычным алгоритмам из <algorithm>
+
+// Набор инструкций, которым пользуются ядра
+enum class SimdLevel {
+    kScalar,
+    kSse42,
+    kAvx2,
+};
+
+// Объекты типа равны тогда и только тогда, когда равны их байты.
+// Для float и double это не так из-за -0.0 и NaN
+template <typename T>
+inline constexpr bool kIsBitwiseComparable = std::is_integral_v<T> || std::is_enum_v<T> || std::is_pointer_v<T>;
+
+// Для типа есть векторные Find/Count и min/max. В AVX2 нет сравнения 64-битных
+// чисел на меньше-больше, поэтому min/max для них остаются скалярными
+template <typename T>
+inline constexpr bool kHasSimdSearch = std::is_integral_v<T>;
+
+template <typename T>
+inline constexpr bool kHasSimdMinMax = std::is_integral_v<T> && !std::is_same_v<T, bool> && sizeof(T) <= 4;
+
+// Поразрядная операция над массивами слов: dest = dest op source.
+// kAndNot оставляет биты dest, которых нет в source
+enum class BitOp {
+    kAnd,
+    kOr,
+    kXor,
+    kAndNot,
+};
+
+namespace simd_detail {
+
+inline SimdLevel DetectSimdLevel() noexcept
+{
+#if SIMPLE_VECTOR_X86_SIMD
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2"))
+    {
+        return SimdLevel::kAvx2;
+    }
+    if(__builtin_cpu_supports("sse4.2"))
+    {
+        return SimdLevel::kSse42;
+    }
+#endif
+    return SimdLevel::kScalar;
+}
+
+inline std::atomic<SimdLevel>& ActiveSimdLevel() noexcept
+{
+    static std::atomic<SimdLevel> level = DetectSimdLevel();
+    return level;
+}
+
+// Скалярные версии ядер. Они же обрабатывают хвосты, не заполняющие регистр
+
+inline size_t MismatchBytesScalar(const unsigned char* lhs, const unsigned char* rhs, size_t count) noexcept
+{
+    return static_cast<size_t>(std::mismatch(lhs, lhs + count, rhs).first - lhs);
+}
+
+template <typename T>
+size_t FindScalar(const T* data, size_t count, T value) noexcept
+{
+    return static_cast<size_t>(std::find(data, data + count, value) - data);
+}
+
+template <typename T>
+size_t CountScalar(const T* data, size_t count, T value) noexcept
+{
+    return static_cast<size_t>(std::count(data, data + count, value));
+}
+
+template <typename T>
+std::pair<T, T> MinMaxScalar(const T* data, size_t count, std::pair<T, T> bounds) noexcept
+{
+    for(size_t i = 0; i < count; ++i)
+    {
+        bounds.first = std::min(bounds.first, data[i]);
+        bounds.second = std::max(bounds.second, data[i]);
+    }
+    return bounds;
+}
+
+// Число единичных битов. Без popcnt в целевой архитектуре std::popcount
+// сводится к тем же сложениям по маскам
+inline unsigned PopCount64(std::uint64_t word) noexcept
+{
+#if defined(__cpp_lib_bitops)
+    return static_cast<unsigned>(std::popcount(word));
+#else
+    word = word - ((word >> 1) & 0x5555555555555555ull);
+    word = (word & 0x3333333333333333ull) + ((word >> 2) & 0x3333333333333333ull);
+    word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    return static_cast<unsigned>((word * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+// Номер младшего единичного бита ненулевого слова
+inline unsigned CountTrailingZeros64(std::uint64_t word) noexcept
+{
+#if defined(__cpp_lib_bitops)
+    return static_cast<unsigned>(std::countr_zero(word));
+#else
+    unsigned bit = 0;
+    while((word & 1) == 0)
+    {
+        word >>= 1;
+        ++bit;
+    }
+    return bit;
+#endif
+}
+
+inline size_t PopCountScalar(const std::uint64_t* words, size_t count) noexcept
+{
+    size_t bits = 0;
+    for(size_t i = 0; i < count; ++i)
+    {
+        bits += PopCount64(words[i]);
+    }
+    return bits;
+}
+
+template <BitOp Op>
+constexpr std::uint64_t ApplyBitOp(std::uint64_t dest, std::uint64_t source) noexcept
+{
+    if constexpr (Op == BitOp::kAnd) return dest & source;
+    else if constexpr (Op == BitOp::kOr) return dest | source;
+    else if constexpr (Op == BitOp::kXor) return dest ^ source;
+    else return dest & ~source;
+}
+
+// Сумма с нарастающим итогом: values[i] = start + (values[0] + ... + values[i]) + i * step
+inline void PrefixSumScalar(std::uint64_t* values, size_t count, std::uint64_t start, std::uint64_t step) noexcept
+{
+    // Переполнение по модулю 2^64 даёт тот же результат, что и без него
+    std::uint64_t sum = start - step;
+    for(size_t i = 0; i < count; ++i)
+    {
+        sum += values[i] + step;
+        values[i] = sum;
+    }
+}
+
+template <BitOp Op>
+void BitwiseScalar(std::uint64_t* dest, const std::uint64_t* source, size_t count) noexcept
+{
+    for(size_t i = 0; i < count; ++i)
+    {
+        dest[i] = ApplyBitOp<Op>(dest[i], source[i]);
+    }
+}
+
+#if SIMPLE_VECTOR_X86_SIMD
+
+// AVX2: 32 байта за итерацию
+
+template <typename T>
+__attribute__((target("avx2"))) inline __m256i Avx2Broadcast(T value) noexcept
+{
+    if constexpr (sizeof(T) == 1) return _mm256_set1_epi8(static_cast<char>(value));
+    else if constexpr (sizeof(T) == 2) return _mm256_set1_epi16(static_cast<short>(value));
+    else if constexpr (sizeof(T) == 4) return _mm256_set1_epi32(static_cast<int>(value));
+    else return _mm256_set1_epi64x(static_cast<long long>(value));
+}
+
+template <typename T>
+__attribute__((target("avx2"))) inline __m256i Avx2Equal(__m256i lhs, __m256i rhs) noexcept
+{
+    if constexpr (sizeof(T) == 1) return _mm256_cmpeq_epi8(lhs, rhs);
+    else if constexpr (sizeof(T) == 2) return _mm256_cmpeq_epi16(lhs, rhs);
+    else if constexpr (sizeof(T) == 4) return _mm256_cmpeq_epi32(lhs, rhs);
+    else return _mm256_cmpeq_epi64(lhs, rhs);
+}
+
+template <typename T>
+__attribute__((target("avx2"))) inline __m256i Avx2Min(__m256i lhs, __m256i rhs) noexcept
+{
+    if constexpr (std::is_signed_v<T>)
+    {
+        if constexpr (sizeof(T) == 1) return _mm256_min_epi8(lhs, rhs);
+        else if constexpr (sizeof(T) == 2) return _mm256_min_epi16(lhs, rhs);
+        else return _mm256_min_epi32(lhs, rhs);
+    }
+    else
+    {
+        if constexpr (sizeof(T) == 1) return _mm256_min_epu8(lhs, rhs);
+        else if constexpr (sizeof(T) == 2) return _mm256_min_epu16(lhs, rhs);
+        else return _mm256_min_epu32(lhs, rhs);
+    }
+}
+
+template <typename T>
+__attribute__((target("avx2"))) inline __m256i Avx2Max(__m256i lhs, __m256i rhs) noexcept
+{
+    if constexpr (std::is_signed_v<T>)
+    {
+        if constexpr (sizeof(T) == 1) return _mm256_max_epi8(lhs, rhs);
+        else if constexpr (sizeof(T) == 2) return _mm256_max_epi16(lhs, rhs);
+        else return _mm256_max_epi32(lhs, rhs);
+    }
+    else
+    {
+        if constexpr (sizeof(T) == 1) return _mm256_max_epu8(lhs, rhs);
+        else if constexpr (sizeof(T) == 2) return _mm256_max_epu16(lhs, rhs);
+        else return _mm256_max_epu32(lhs, rhs);
+    }
+}
+
+__attribute__((target("avx2"))) inline size_t MismatchBytesAvx2(const unsigned char* lhs, const unsigned char* rhs,
+                                                                size_t count) noexcept
+{
+    size_t i = 0;
+    for(; i + 32 <= count; i += 32)
+    {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + i));
+        const auto equal = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b)));
+        if(equal != 0xFFFFFFFFu)
+        {
+            return i + static_cast<size_t>(__builtin_ctz(~equal));
+        }
+    }
+    return i + MismatchBytesScalar(lhs + i, rhs + i, count - i);
+}
+
+template <typename T>
+__attribute__((target("avx2"))) size_t FindAvx2(const T* data, size_t count, T value) noexcept
+{
+    constexpr size_t kLanes = 32 / sizeof(T);
+    const __m256i needle = Avx2Broadcast(value);
+    size_t i = 0;
+    for(; i + kLanes <= count; i += kLanes)
+    {
+        const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        const auto found = static_cast<unsigned>(_mm256_movemask_epi8(Avx2Equal<T>(block, needle)));
+        if(found != 0)
+        {
+            return i + static_cast<size_t>(__builtin_ctz(found)) / sizeof(T);
+        }
+    }
+    return i + FindScalar(data + i, count - i, value);
+}
+
+// Каждый совпавший элемент ставит в маске sizeof(T) битов
+template <typename T>
+__attribute__((target("avx2"))) size_t CountAvx2(const T* data, size_t count, T value) noexcept
+{
+    constexpr size_t kLanes = 32 / sizeof(T);
+    const __m256i needle = Avx2Broadcast(value);
+    size_t bits = 0;
+    size_t i = 0;
+    for(; i + kLanes <= count; i += kLanes)
+    {
+        const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        bits += static_cast<size_t>(__builtin_popcount(
+            static_cast<unsigned>(_mm256_movemask_epi8(Avx2Equal<T>(block, needle)))));
+    }
+    return bits / sizeof(T) + CountScalar(data + i, count - i, value);
+}
+
+template <typename T>
+__attribute__((target("avx2"))) std::pair<T, T> MinMaxAvx2(const T* data, size_t count) noexcept
+{
+    constexpr size_t kLanes = 32 / sizeof(T);
+    std::pair<T, T> bounds(data[0], data[0]);
+    if(count < kLanes)
+    {
+        return MinMaxScalar(data, count, bounds);
+    }
+    __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+    __m256i high = low;
+    size_t i = kLanes;
+    for(; i + kLanes <= count; i += kLanes)
+    {
+        const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        low = Avx2Min<T>(low, block);
+        high = Avx2Max<T>(high, block);
+    }
+    alignas(32) T lows[kLanes];
+    alignas(32) T highs[kLanes];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lows), low);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(highs), high);
+    bounds = MinMaxScalar(lows, kLanes, bounds);
+    bounds = MinMaxScalar(highs, kLanes, bounds);
+    return MinMaxScalar(data + i, count - i, bounds);
+}
+
+// Подсчёт битов без popcnt над отдельными словами: каждый полубайт заменяется числом
+// его битов через pshufb, а суммы байтов копятся в четырёх 64-битных счётчиках
+__attribute__((target("avx2,popcnt"))) inline size_t PopCountAvx2(const std::uint64_t* words, size_t count) noexcept
+{
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low_mask = _mm256_set1_epi8(0x0F);
+    __m256i total = _mm256_setzero_si256();
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4)
+    {
+        const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + i));
+        const __m256i low = _mm256_and_si256(block, low_mask);
+        const __m256i high = _mm256_and_si256(_mm256_srli_epi16(block, 4), low_mask);
+        const __m256i bytes = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, low), _mm256_shuffle_epi8(lookup, high));
+        total = _mm256_add_epi64(total, _mm256_sad_epu8(bytes, _mm256_setzero_si256()));
+    }
+    alignas(32) std::uint64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), total);
+    size_t bits = static_cast<size_t>(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+    for(; i < count; ++i)
+    {
+        bits += static_cast<size_t>(__builtin_popcountll(words[i]));
+    }
+    return bits;
+}
+
+// Префиксные суммы четырёх соседних чисел внутри регистра
+__attribute__((target("avx2"))) inline __m256i Avx2PrefixSum4(__m256i x) noexcept
+{
+    // [a, b, c, d] -> [a, a+b, c, c+d] -> [a, a+b, a+b+c, a+b+c+d]
+    x = _mm256_add_epi64(x, _mm256_slli_si256(x, 8));
+    const __m256i low_total = _mm256_permute4x64_epi64(x, _MM_SHUFFLE(1, 1, 1, 1));
+    return _mm256_add_epi64(x, _mm256_blend_epi32(_mm256_setzero_si256(), low_total, 0xF0));
+}
+
+// По восемь чисел: суммы двух регистров считаются независимо, а в цепочку зависимостей
+// между итерациями попадает только одно сложение с переносом
+__attribute__((target("avx2"))) inline void PrefixSumAvx2(std::uint64_t* values, size_t count, std::uint64_t start,
+                                                          std::uint64_t step) noexcept
+{
+    const __m256i steps = _mm256_set1_epi64x(static_cast<long long>(step));
+    __m256i carry = _mm256_set1_epi64x(static_cast<long long>(start - step));
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8)
+    {
+        auto* first = reinterpret_cast<__m256i*>(values + i);
+        const __m256i low = Avx2PrefixSum4(_mm256_add_epi64(_mm256_loadu_si256(first), steps));
+        const __m256i high = Avx2PrefixSum4(_mm256_add_epi64(_mm256_loadu_si256(first + 1), steps));
+        const __m256i low_total = _mm256_permute4x64_epi64(low, _MM_SHUFFLE(3, 3, 3, 3));
+        const __m256i high_total = _mm256_permute4x64_epi64(high, _MM_SHUFFLE(3, 3, 3, 3));
+        _mm256_storeu_si256(first, _mm256_add_epi64(low, carry));
+        _mm256_storeu_si256(first + 1, _mm256_add_epi64(high, _mm256_add_epi64(carry, low_total)));
+        carry = _mm256_add_epi64(carry, _mm256_add_epi64(low_total, high_total));
+    }
+    const auto sum = static_cast<std::uint64_t>(_mm256_extract_epi64(carry, 0));
+    PrefixSumScalar(values + i, count - i, sum + step, step);
+}
+
+template <BitOp Op>
+__attribute__((target("avx2"))) inline __m256i Avx2BitOp(__m256i dest, __m256i source) noexcept
+{
+    if constexpr (Op == BitOp::kAnd) return _mm256_and_si256(dest, source);
+    else if constexpr (Op == BitOp::kOr) return _mm256_or_si256(dest, source);
+    else if constexpr (Op == BitOp::kXor) return _mm256_xor_si256(dest, source);
+    else return _mm256_andnot_si256(source, dest);
+}
+
+template <BitOp Op>
+__attribute__((target("avx2"))) void BitwiseAvx2(std::uint64_t* dest, const std::uint64_t* source, size_t count) noexcept
+{
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4)
+    {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dest + i));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i), Avx2BitOp<Op>(a, b));
+    }
+    BitwiseScalar<Op>(dest + i, source + i, count - i);
+}
+
+// SSE4.2: 16 байт за итерацию
+
+template <typename T>
+__attribute__((target("sse4.2"))) inline __m128i Sse42Broadcast(T value) noexcept
+{
+    if constexpr (sizeof(T) == 1) return _mm_set1_epi8(static_cast<char>(value));
+    else if constexpr (sizeof(T) == 2) return _mm_set1_epi16(static_cast<short>(value));
+    else if constexpr (sizeof(T) == 4) return _mm_set1_epi32(static_cast<int>(value));
+    else return _mm_set1_epi64x(static_cast<long long>(value));
+}
+
+template <typename T>
+__attribute__((target("sse4.2"))) inline __m128i Sse42Equal(__m128i lhs, __m128i rhs) noexcept
+{
+    if constexpr (sizeof(T) == 1) return _mm_cmpeq_epi8(lhs, rhs);
+    else if constexpr (sizeof(T) == 2) return _mm_cmpeq_epi16(lhs, rhs);
+    else if constexpr (sizeof(T) == 4) return _mm_cmpeq_epi32(lhs, rhs);
+    else return _mm_cmpeq_epi64(lhs, rhs);
+}
+
+template <typename T>
+__attribute__((target("sse4.2"))) inline __m128i Sse42Min(__m128i lhs, __m128i rhs) noexcept
+{
+    if constexpr (std::is_signed_v<T>)
+    {
+        if constexpr (sizeof(T) == 1) return _mm_min_epi8(lhs, rhs);
+        else if constexpr (sizeof(T) == 2) return _mm_min_epi16(lhs, rhs);
+        else return _mm_min_epi32(lhs, rhs);
+    }
+    else
+    {
+        if constexpr (sizeof(T) == 1) return _mm_min_epu8(lhs, rhs);
+        else if constexpr (sizeof(T) == 2) return _mm_min_epu16(lhs, rhs);
+        else return _mm_min_epu32(lhs, rhs);
+    }
+}
+
+template <typename T>
+__attribute__((target("sse4.2"))) inline __m128i Sse42Max(__m128i lhs, __m128i rhs) noexcept
+{
+    if constexpr (std::is_signed_v<T>)
+    {
+        if constexpr (sizeof(T) == 1) return _mm_max_epi8(lhs, rhs);
+        else if constexpr (sizeof(T) == 2) return _mm_max_epi16(lhs, rhs);
+        else return _mm_max_epi32(lhs, rhs);
+    }
+    else
+    {
+        if constexpr (sizeof(T) == 1) return _mm_max_epu8(lhs, rhs);
+        else if constexpr (sizeof(T) == 2) return _mm_max_epu16(lhs, rhs);
+        else return _mm_max_epu32(lhs, rhs);
+    }
+}
+
+__attribute__((target("sse4.2"))) inline size_t MismatchBytesSse42(const unsigned char* lhs, const unsigned char* rhs,
+                                                                   size_t count) noexcept
+{
+    size_t i = 0;
+    for(; i + 16 <= count; i += 16)
+    {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + i));
+        const auto equal = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)));
+        if(equal != 0xFFFFu)
+        {
+            return i + static_cast<size_t>(__builtin_ctz(~equal));
+        }
+    }
+    return i + MismatchBytesScalar(lhs + i, rhs + i, count - i);
+}
+
+template <typename T>
+__attribute__((target("sse4.2"))) size_t FindSse42(const T* data, size_t count, T value) noexcept
+{
+    constexpr size_t kLanes = 16 / sizeof(T);
+    const __m128i needle = Sse42Broadcast(value);
+    size_t i = 0;
+    for(; i + kLanes <= count; i += kLanes)
+    {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        const auto found = static_cast<unsigned>(_mm_movemask_epi8(Sse42Equal<T>(block, needle)));
+        if(found != 0)
+        {
+            return i + static_cast<size_t>(__builtin_ctz(found)) / sizeof(T);
+        }
+    }
+    return i + FindScalar(data + i, count - i, value);
+}
+
+template <typename T>
+__attribute__((target("sse4.2"))) size_t CountSse42(const T* data, size_t count, T value) noexcept
+{
+    constexpr size_t kLanes = 16 / sizeof(T);
+    const __m128i needle = Sse42Broadcast(value);
+    size_t bits = 0;
+    size_t i = 0;
+    for(; i + kLanes <= count; i += kLanes)
+    {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        bits += static_cast<size_t>(__builtin_popcount(
+            static_cast<unsigned>(_mm_movemask_epi8(Sse42Equal<T>(block, needle)))));
+    }
+    return bits / sizeof(T) + CountScalar(data + i, count - i, value);
+}
+
+template <typename T>
+__attribute__((target("sse4.2"))) std::pair<T, T> MinMaxSse42(const T* data, size_t count) noexcept
+{
+    constexpr size_t kLanes = 16 / sizeof(T);
+    std::pair<T, T> bounds(data[0], data[0]);
+    if(count < kLanes)
+    {
+        return MinMaxScalar(data, count, bounds);
+    }
+    __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    __m128i high = low;
+    size_t i = kLanes;
+    for(; i + kLanes <= count; i += kLanes)
+    {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        low = Sse42Min<T>(low, block);
+        high = Sse42Max<T>(high, block);
+    }
+    alignas(16) T lows[kLanes];
+    alignas(16) T highs[kLanes];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lows), low);
+    _mm_store_si128(reinterpret_cast<__m128i*>(highs), high);
+    bounds = MinMaxScalar(lows, kLanes, bounds);
+    bounds = MinMaxScalar(highs, kLanes, bounds);
+    return MinMaxScalar(data + i, count - i, bounds);
+}
+
+
+// Процессоры с SSE4.2 умеют popcnt, так что слова считаются по одному инструкцией
+__attribute__((target("sse4.2,popcnt"))) inline size_t PopCountSse42(const std::uint64_t* words, size_t count) noexcept
+{
+    size_t bits = 0;
+    for(size_t i = 0; i < count; ++i)
+    {
+        bits += static_cast<size_t>(__builtin_popcountll(words[i]));
+    }
+    return bits;
+}
+
+template <BitOp Op>
+__attribute__((target("sse4.2"))) inline __m128i Sse42BitOp(__m128i dest, __m128i source) noexcept
+{
+    if constexpr (Op == BitOp::kAnd) return _mm_and_si128(dest, source);
+    else if constexpr (Op == BitOp::kOr) return _mm_or_si128(dest, source);
+    else if constexpr (Op == BitOp::kXor) return _mm_xor_si128(dest, source);
+    else return _mm_andnot_si128(source, dest);
+}
+
+template <BitOp Op>
+__attribute__((target("sse4.2"))) void BitwiseSse42(std::uint64_t* dest, const std::uint64_t* source, size_t count) noexcept
+{
+    size_t i = 0;
+    for(; i + 2 <= count; i += 2)
+    {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dest + i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), Sse42BitOp<Op>(a, b));
+    }
+    BitwiseScalar<Op>(dest + i, source + i, count - i);
+}
+
+#endif // SIMPLE_VECTOR_X86_SIMD
+
+// Диспетчеры: выбирают ядро по текущему уровню
+
+// Возвращает номер первого различающегося байта или count
+inline size_t MismatchBytes(const void* lhs, const void* rhs, size_t count) noexcept
+{
+    const auto* a = static_cast<const unsigned char*>(lhs);
+    const auto* b = static_cast<const unsigned char*>(rhs);
+#if SIMPLE_VECTOR_X86_SIMD
+    switch(ActiveSimdLevel().load(std::memory_order_relaxed))
+    {
+    case SimdLevel::kAvx2:
+        return MismatchBytesAvx2(a, b, count);
+    case SimdLevel::kSse42:
+        return MismatchBytesSse42(a, b, count);
+    case SimdLevel::kScalar:
+        break;
+    }
+#endif
+    return MismatchBytesScalar(a, b, count);
+}
+
+template <typename T>
+size_t Find(const T* data, size_t count, T value) noexcept
+{
+#if SIMPLE_VECTOR_X86_SIMD
+    switch(ActiveSimdLevel().load(std::memory_order_relaxed))
+    {
+    case SimdLevel::kAvx2:
+        return FindAvx2(data, count, value);
+    case SimdLevel::kSse42:
+        return FindSse42(data, count, value);
+    case SimdLevel::kScalar:
+        break;
+    }
+#endif
+    return FindScalar(data, count, value);
+}
+
+template <typename T>
+size_t Count(const T* data, size_t count, T value) noexcept
+{
+#if SIMPLE_VECTOR_X86_SIMD
+    switch(ActiveSimdLevel().load(std::memory_order_relaxed))
+    {
+    case SimdLevel::kAvx2:
+        return CountAvx2(data, count, value);
+    case SimdLevel::kSse42:
+        return CountSse42(data, count, value);
+    case SimdLevel::kScalar:
+        break;
+    }
+#endif
+    return CountScalar(data, count, value);
+}
+
+// Наименьшее и наибольшее значения непустого массива
+template <typename T>
+std::pair<T, T> MinMax(const T* data, size_t count) noexcept
+{
+#if SIMPLE_VECTOR_X86_SIMD
+    switch(ActiveSimdLevel().load(std::memory_order_relaxed))
+    {
+    case SimdLevel::kAvx2:
+        return MinMaxAvx2(data, count);
+    case SimdLevel::kSse42:
+        return MinMaxSse42(data, count);
+    case SimdLevel::kScalar:
+        break;
+    }
+#endif
+    return MinMaxScalar(data, count, std::pair<T, T>(data[0], data[0]));
+}
+
+// Число единичных битов в массиве слов
+inline size_t PopCount(const std::uint64_t* words, size_t count) noexcept
+{
+#if SIMPLE_VECTOR_X86_SIMD
+    switch(ActiveSimdLevel().load(std::memory_order_relaxed))
+    {
+    case SimdLevel::kAvx2:
+        return PopCountAvx2(words, count);
+    case SimdLevel::kSse42:
+        return PopCountSse42(words, count);
+    case SimdLevel::kScalar:
+        break;
+    }
+#endif
+    return PopCountScalar(words, count);
+}
+
+// values[i] = start + (values[0] + ... + values[i]) + i * step
+inline void PrefixSum(std::uint64_t* values, size_t count, std::uint64_t start, std::uint64_t step) noexcept
+{
+#if SIMPLE_VECTOR_X86_SIMD
+    if(ActiveSimdLevel().load(std::memory_order_relaxed) == SimdLevel::kAvx2)
+    {
+        return PrefixSumAvx2(values, count, start, step);
+    }
+#endif
+    PrefixSumScalar(values, count, start, step);
+}
+
+// dest[i] = dest[i] op source[i] для count слов
+template <BitOp Op>
+void Bitwise(std::uint64_t* dest, const std::uint64_t* source, size_t count) noexcept
+{
+#if SIMPLE_VECTOR_X86_SIMD
+    switch(ActiveSimdLevel().load(std::memory_order_relaxed))
+    {
+    case SimdLevel::kAvx2:
+        return BitwiseAvx2<Op>(dest, source, count);
+    case SimdLevel::kSse42:
+        return BitwiseSse42<Op>(dest, source, count);
+    case SimdLevel::kScalar:
+        break;
+    }
+#endif
+    BitwiseScalar<Op>(dest, source, count);
+}
+
+} // namespace simd_detail
+
+// Текущий набор инструкций: лучший из поддерживаемых процессором, если его не ограничили
+inline SimdLevel GetSimdLevel() noexcept
+{
+    return simd_detail::ActiveSimdLevel().load(std::memory_order_relaxed);
+}
+
+// Ограничивает набор инструкций, например чтобы проверить в тестах все ветви.
+// Уровень выше поддерживаемого процессором не включается
+inline void SetSimdLevel(SimdLevel level) noexcept
+{
+    simd_detail::ActiveSimdLevel().store(std::min(level, simd_detail::DetectSimdLevel()), std::memory_order_relaxed);
+}
+
+// Алгоритмы над массивами [first, first + count)
+
+template <typename T>
+SIMPLE_VECTOR_CONSTEXPR bool RangeEqual(const T* lhs, const T* rhs, size_t count)
+{
+    if constexpr (kIsBitwiseComparable<T>)
+    {
+        if(!IsConstantEvaluated())
+        {
+            return count == 0 || std::memcmp(lhs, rhs, count * sizeof(T)) == 0;
+        }
+    }
+    return std::equal(lhs, lhs + count, rhs);
+}
+
+// Номер первого элемента, на котором массивы различаются, или count
+template <typename T>
+SIMPLE_VECTOR_CONSTEXPR size_t RangeMismatch(const T* lhs, const T* rhs, size_t count)
+{
+    if constexpr (kIsBitwiseComparable<T>)
+    {
+        if(!IsConstantEvaluated())
+        {
+            return simd_detail::MismatchBytes(lhs, rhs, count * sizeof(T)) / sizeof(T);
+        }
+    }
+    return static_cast<size_t>(std::mismatch(lhs, lhs + count, rhs).first - lhs);
+}
+
+// Лексикографически сравнивает массивы за один проход. Возвращает отрицательное число,
+// ноль или положительное число, если lhs меньше, равен или больше rhs. Нужен только operator<
+template <typename T>
+SIMPLE_VECTOR_CONSTEXPR int RangeCompare(const T* lhs, size_t lhs_size, const T* rhs, size_t rhs_size)
+{
+    const size_t common = std::min(lhs_size, rhs_size);
+    if constexpr (kIsBitwiseComparable<T>)
+    {
+        const size_t i = RangeMismatch(lhs, rhs, common);
+        if(i != common)
+        {
+            return lhs[i] < rhs[i] ? -1 : 1;
+        }
+    }
+    else
+    {
+        for(size_t i = 0; i < common; ++i)
+        {
+            if(lhs[i] < rhs[i])
+            {
+                return -1;
+            }
+            if(rhs[i] < lhs[i])
+            {
+                return 1;
+            }
+        }
+    }
+    return lhs_size < rhs_size ? -1 : (rhs_size < lhs_size ? 1 : 0);
+}
+
+#if defined(__cpp_impl_three_way_comparison) && defined(__cpp_lib_three_way_comparison)
+
+// Трёхстороннее сравнение элементов. Для типов без operator<=> строится из operator<,
+// как это делают стандартные контейнеры
+template <typename T>
+constexpr auto SynthThreeWay(const T& lhs, const T& rhs)
+{
+    if constexpr (std::three_way_comparable<T>)
+    {
+        return lhs <=> rhs;
+    }
+    else
+    {
+        if(lhs < rhs)
+        {
+            return std::weak_ordering::less;
+        }
+        if(rhs < lhs)
+        {
+            return std::weak_ordering::greater;
+        }
+        return std::weak_ordering::equivalent;
+    }
+}
+
+template <typename T>
+using SynthThreeWayResult = decltype(SynthThreeWay(std::declval<const T&>(), std::declval<const T&>()));
+
+template <typename T>
+SIMPLE_VECTOR_CONSTEXPR SynthThreeWayResult<T> RangeCompareThreeWay(const T* lhs, size_t lhs_size, const T* rhs, size_t rhs_size)
+{
+    const size_t common = std::min(lhs_size, rhs_size);
+    if constexpr (kIsBitwiseComparable<T>)
+    {
+        const size_t i = RangeMismatch(lhs, rhs, common);
+        if(i != common)
+        {
+            return lhs[i] <=> rhs[i];
+        }
+    }
+    else
+    {
+        for(size_t i = 0; i < common; ++i)
+        {
+            if(auto order = SynthThreeWay(lhs[i], rhs[i]); order != 0)
+            {
+                return order;
+            }
+        }
+    }
+    return lhs_size <=> rhs_size;
+}
+
+#endif
+
+// Указатель на первый элемент, равный value, или first + count
+template <typename T>
+SIMPLE_VECTOR_CONSTEXPR const T* RangeFind(const T* first, size_t count, const T& value)
+{
+    if constexpr (kHasSimdSearch<T>)
+    {
+        if(!IsConstantEvaluated())
+        {
+            return first + simd_detail::Find(first, count, value);
+        }
+    }
+    return std::find(first, first + count, value);
+}
+
+template <typename T>
+SIMPLE_VECTOR_CONSTEXPR size_t RangeCount(const T* first, size_t count, const T& value)
+{
+    if constexpr (kHasSimdSearch<T>)
+    {
+        if(!IsConstantEvaluated())
+        {
+            return simd_detail::Count(first, count, value);
+        }
+    }
+    return static_cast<size_t>(std::count(first, first + count, value));
+}
+
+// Указатель на первый наименьший элемент или first + count для пустого массива.
+// Векторная версия находит значение минимума, а затем ищет его первое вхождение
+template <typename T>
+SIMPLE_VECTOR_CONSTEXPR const T* RangeMinElement(const T* first, size_t count)
+{
+    if constexpr (kHasSimdMinMax<T>)
+    {
+        if(!IsConstantEvaluated())
+        {
+            if(count == 0)
+            {
+                return first;
+            }
+            return RangeFind(first, count, simd_detail::MinMax(first, count).first);
+        }
+    }
+    return std::min_element(first, first + count);
+}
+
+// Указатель на первый наибольший элемент или first + count для пустого массива
+template <typename T>
+SIMPLE_VECTOR_CONSTEXPR const T* RangeMaxElement(const T* first, size_t count)
+{
+    if constexpr (kHasSimdMinMax<T>)
+    {
+        if(!IsConstantEvaluated())
+        {
+            if(count == 0)
+            {
+                return first;
+            }
+            return RangeFind(first, count, simd_detail::MinMax(first, count).second);
+        }
+    }
+    return std::max_element(first, first + count);
+}
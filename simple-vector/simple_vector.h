@@ -8,15 +8,25 @@
 #include <algorithm>
 #include <iterator>
 #include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
 #include "array_ptr.h"
+#include "constexpr_support.h"
+#include "growth_policy.h"
+#include "hardening.h"
+#include "relocation.h"
+#include "simd_kernels.h"
+#include "simple_vector_stats.h"
+#include "simple_vector_view.h"
 
 class SaveReserve
 {
 public:
-    SaveReserve(size_t capacity)
+    constexpr SaveReserve(size_t capacity)
     : capacity_(capacity)
     {}
-    size_t GetCapacity() const
+    constexpr size_t GetCapacity() const
     {
         return capacity_;
     }
@@ -24,149 +34,356 @@ private:
     size_t capacity_ = 0;
 };
 
-SaveReserve Reserve(size_t capacity)
+constexpr SaveReserve Reserve(size_t capacity)
 {
     return SaveReserve(capacity);
 }
 
+// Буфер, который SimpleVector::Release отдаёт владельцу, а SimpleVector::Adopt забирает:
+// capacity ячеек, выделенных аллокатором вектора, из которых живы первые size
 template <typename Type>
+struct SimpleVectorBuffer {
+    Type* data = nullptr;
+    size_t size = 0;
+    size_t capacity = 0;
+};
+
+// Категория итератора It не ниже Category. Для типов, не являющихся итераторами, ложно
+template <typename It, typename Category, typename = void>
+inline constexpr bool kIsIteratorOf = false;
+
+template <typename It, typename Category>
+inline constexpr bool kIsIteratorOf<It, Category, std::void_t<typename std::iterator_traits<It>::iterator_category>>
+    = std::is_convertible_v<typename std::iterator_traits<It>::iterator_category, Category>;
+
+// Allocator совместим с std::allocator_traits, в том числе с std::pmr::polymorphic_allocator:
+// вектор с аллокатором монотонного ресурса освобождается вместе с ресурсом.
+// GrowthPolicy выбирает вместимость при росте и, если умеет, уменьшает буфер
+// опустевшего вектора (см. growth_policy.h)
+template <typename Type, typename Allocator = std::allocator<Type>, typename GrowthPolicy = DoublingGrowth>
 class SimpleVector {
+    using AllocTraits = std::allocator_traits<Allocator>;
+
 public:
+#if SIMPLE_VECTOR_HAS_CHECKED_ITERATORS
+    using Iterator = hardening_detail::CheckedIterator<SimpleVector, Type>;
+    using ConstIterator = hardening_detail::CheckedIterator<SimpleVector, const Type>;
+#else
+    // Без проверок итераторы - сырые указатели, и цена у них та же
     using Iterator = Type*;
     using ConstIterator = const Type*;
+#endif
+    using AllocatorType = Allocator;
+    using GrowthPolicyType = GrowthPolicy;
 
     SimpleVector() noexcept = default;
 
+    // Создаёт пустой вектор, который будет выделять память через alloc
+    SIMPLE_VECTOR_CONSTEXPR explicit SimpleVector(const Allocator& alloc) noexcept
+    : vector_(alloc)
+    {}
+
     // Создаёт вектор из size элементов, инициализированных значением по умолчанию
-    explicit SimpleVector(size_t size){
-        if(size == 0)
-        {
-            return;
-        }
-        vector_ = ArrayPtr<Type> (new Type[size]());
+    SIMPLE_VECTOR_CONSTEXPR explicit SimpleVector(size_t size, const Allocator& alloc = Allocator())
+    : vector_(size, alloc)
+    {
+        UninitializedValueConstructN(vector_.GetAllocator(), vector_.GetRawPtr(), size);
         capacity_ = size;
         size_ = size;
+        stats_.Allocated(capacity_, false);
+        AnnotateNew();
     }
 
     //конструктор копирования
-    explicit SimpleVector(const SimpleVector& other) 
-    : size_(other.size_)
-    , capacity_(other.capacity_)
+    SIMPLE_VECTOR_CONSTEXPR explicit SimpleVector(const SimpleVector& other) 
+    : SimpleVector(other, AllocTraits::select_on_container_copy_construction(other.vector_.GetAllocator()))
+    {}
+
+    // Копирует other, выделяя память через alloc
+    SIMPLE_VECTOR_CONSTEXPR SimpleVector(const SimpleVector& other, const Allocator& alloc)
+    : vector_(other.capacity_, alloc)
     {   
-        vector_ = ArrayPtr<Type> (new Type[other.capacity_]());
-        std::copy(other.begin(), other.end(), begin());
+        UninitializedCopy(vector_.GetAllocator(), other.Data(), other.Data() + other.size_, vector_.GetRawPtr());
+        size_ = other.size_;
+        capacity_ = other.capacity_;
+        stats_.Allocated(capacity_, false);
+        AnnotateNew();
     }
 
     // Создаёт вектор из size элементов, инициализированных значением value
-    SimpleVector(size_t size, const Type& value)
-    : size_(size)
-    , capacity_(size)
+    SIMPLE_VECTOR_CONSTEXPR SimpleVector(size_t size, const Type& value, const Allocator& alloc = Allocator())
+    : vector_(size, alloc)
     {
-        vector_ = ArrayPtr<Type> (new Type[size]());
-        std::fill(begin(), end(), value);
+        UninitializedFillN(vector_.GetAllocator(), vector_.GetRawPtr(), size, value);
+        size_ = size;
+        capacity_ = size;
+        stats_.Allocated(capacity_, false);
+        AnnotateNew();
     }
 
     // Создаёт вектор из std::initializer_list
-    SimpleVector(std::initializer_list<Type> init)
-    : size_(init.size())
-    , capacity_(init.size())
+    SIMPLE_VECTOR_CONSTEXPR SimpleVector(std::initializer_list<Type> init, const Allocator& alloc = Allocator())
+    : vector_(init.size(), alloc)
     {
-        vector_ = ArrayPtr<Type> (new Type[init.size()]());
-        std::move(init.begin(), init.end(), begin());
+        UninitializedCopy(vector_.GetAllocator(), init.begin(), init.end(), vector_.GetRawPtr());
+        size_ = init.size();
+        capacity_ = init.size();
+        stats_.Allocated(capacity_, false);
     }
 
     //Конструктор перемещения
-    SimpleVector(SimpleVector &&other)
+    SIMPLE_VECTOR_CONSTEXPR SimpleVector(SimpleVector &&other) noexcept
+    : vector_(std::move(other.vector_))
+    , size_(std::exchange(other.size_, 0))
+    , capacity_(std::exchange(other.capacity_, 0))
+    , stats_(other.stats_)
     {
-        vector_.swap(other.vector_);
-        std::swap(this->size_, other.size_);
-        std::swap(this->capacity_, other.capacity_);
+        other.Invalidate();
+    }
+
+    // Перемещает other в вектор с аллокатором alloc. Если аллокаторы не равны,
+    // буфер забрать нельзя, и элементы переносятся по одному
+    SIMPLE_VECTOR_CONSTEXPR SimpleVector(SimpleVector &&other, const Allocator& alloc)
+    : vector_(alloc)
+    {
+        if(alloc == other.vector_.GetAllocator())
+        {
+            StealFrom(other);
+            return;
+        }
+        ArrayPtr<Type, Allocator> temp(other.size_, alloc);
+        UninitializedCopy(temp.GetAllocator(), std::make_move_iterator(other.Data()), std::make_move_iterator(other.Data() + other.size_), temp.GetRawPtr());
+        vector_ = std::move(temp);
+        size_ = other.size_;
+        capacity_ = other.size_;
+        stats_.Allocated(capacity_, false);
+    }
+
+    // Создаёт вектор из элементов диапазона [first, last)
+    // Для прямых итераторов память выделяется один раз
+    template <typename InputIt, typename = std::enable_if_t<kIsIteratorOf<InputIt, std::input_iterator_tag>>>
+    SIMPLE_VECTOR_CONSTEXPR SimpleVector(InputIt first, InputIt last, const Allocator& alloc = Allocator())
+    : vector_(alloc)
+    {
+        if constexpr (kIsIteratorOf<InputIt, std::forward_iterator_tag>)
+        {
+            const auto count = static_cast<size_t>(std::distance(first, last));
+            ArrayPtr<Type, Allocator> temp(count, alloc);
+            UninitializedCopy(temp.GetAllocator(), first, last, temp.GetRawPtr());
+            vector_ = std::move(temp);
+            size_ = count;
+            capacity_ = count;
+            stats_.Allocated(capacity_, false);
+            AnnotateNew();
+        }
+        else
+        {
+            Append(first, last);
+        }
     }
 
     //Резервирующий конструктор
-    SimpleVector(const SaveReserve &res)
+    SIMPLE_VECTOR_CONSTEXPR SimpleVector(const SaveReserve &res, const Allocator& alloc = Allocator())
+    : vector_(alloc)
+    {
+        Reserve(res.GetCapacity());
+    }
+
+    // Разрушает только живые элементы [0, size_), ячейки за ними не создавались
+    SIMPLE_VECTOR_CONSTEXPR ~SimpleVector()
+    {
+        DestroyRange(vector_.GetAllocator(), Data(), Data() + size_);
+        // ASan требует снять пометки до того, как буфер вернётся аллокатору
+        AnnotateDelete();
+    }
+
+    // Возвращает копию аллокатора вектора
+    SIMPLE_VECTOR_CONSTEXPR Allocator GetAllocator() const noexcept
+    {
+        return vector_.GetAllocator();
+    }
+
+    // Забирает во владение буфер data на capacity ячеек, выделенный аллокатором вектора,
+    // в котором живы элементы [0, size) - например, полученный от Release или из C API.
+    // Прежние элементы и буфер вектора освобождаются
+    SIMPLE_VECTOR_CONSTEXPR void Adopt(Type* data, size_t size, size_t capacity) noexcept
+    {
+        SIMPLE_VECTOR_CHECK(size <= capacity && (data != nullptr || capacity == 0), "Adopted buffer is invalid");
+        // Не Clear: политика с уменьшением перевыделила бы буфер, который сейчас уйдёт
+        DestroyRange(vector_.GetAllocator(), Data(), Data() + size_);
+        AnnotateSize(size_, 0);
+        size_ = 0;
+        DiscardBuffer();
+        // Чужой буфер для статистики - то же, что выделенный вектором
+        stats_.Allocated(capacity, capacity_ != 0);
+        vector_ = ArrayPtr<Type, Allocator>(data, capacity, vector_.GetAllocator());
+        size_ = size;
+        capacity_ = capacity;
+        Invalidate();
+        AnnotateNew();
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR void Adopt(SimpleVectorBuffer<Type> buffer) noexcept
+    {
+        Adopt(buffer.data, buffer.size, buffer.capacity);
+    }
+
+    // Отдаёт буфер вызывающему и оставляет вектор пустым. Новый владелец должен
+    // разрушить элементы [0, size) и освободить буфер аллокатором вектора
+    [[nodiscard]] SIMPLE_VECTOR_CONSTEXPR SimpleVectorBuffer<Type> Release() noexcept
     {
-        vector_ = ArrayPtr<Type>();
+        AnnotateDelete();
+        Invalidate();
+        SimpleVectorBuffer<Type> buffer{vector_.Release(), size_, capacity_};
         size_ = 0;
         capacity_ = 0;
-        Reserve(res.GetCapacity());
+        return buffer;
+    }
+
+    // Невладеющий вид на count элементов, начиная с first, без копирования.
+    // Выбрасывает std::out_of_range, если участок выходит за конец вектора
+    SIMPLE_VECTOR_CONSTEXPR SimpleVectorView<Type> Slice(size_t first, size_t count)
+    {
+        return SimpleVectorView<Type>(Data(), size_).Slice(first, count);
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR SimpleVectorView<const Type> Slice(size_t first, size_t count) const
+    {
+        return SimpleVectorView<const Type>(Data(), size_).Slice(first, count);
+    }
+
+    // Направляет статистику этого вектора в stats вместо общих счётчиков типа.
+    // Объект stats должен жить дольше вектора; вектор, созданный перемещением, пишет туда же.
+    // Доступно, только если статистика для Type включена (см. simple_vector_stats.h)
+    void SetStats(SimpleVectorStats& stats) noexcept
+    {
+        static_assert(kEnableSimpleVectorStats<Type>, "SimpleVector stats are disabled for this type");
+        stats_.Attach(stats);
+    }
+
+    SimpleVectorStats& GetStats() const noexcept
+    {
+        static_assert(kEnableSimpleVectorStats<Type>, "SimpleVector stats are disabled for this type");
+        return stats_.Get();
     }
 
     //Резервирует память размером new_capacity ячеек
     //Если текущая емкость вектора больше новой, то емкость не меняется
-    void Reserve(size_t new_capacity)
+    SIMPLE_VECTOR_CONSTEXPR void Reserve(size_t new_capacity)
     {
         if(new_capacity > capacity_)
         {
-            ArrayPtr<Type> temp(new Type[new_capacity]);
-            std::copy(begin(), end(), temp.GetRawPtr());
-            std::fill(std::next(temp.GetRawPtr(), static_cast<int>(size_)), std::next(temp.GetRawPtr(), static_cast<int>(new_capacity)), std::move(Type()));
-            vector_ = std::move(temp);
-            capacity_ = new_capacity;
+            Reallocate(new_capacity);
+        }
+    }
+
+    // Уменьшает вместимость до размера, освобождая запас. Пустой вектор отдаёт буфер целиком.
+    // Если перенос элементов бросит исключение, вектор не изменится
+    SIMPLE_VECTOR_CONSTEXPR void ShrinkToFit()
+    {
+        if(capacity_ > size_)
+        {
+            Reallocate(size_);
         }
     }
 
-    SimpleVector<Type>& operator=(const SimpleVector& rhs)
+    SIMPLE_VECTOR_CONSTEXPR SimpleVector& operator=(const SimpleVector& rhs)
     {
-        if(begin() != rhs.begin())
+        if(this != &rhs)
         {
-            SimpleVector<Type> rhs_copy(rhs);
-            swap(rhs_copy);
+            // Копия строится сразу нужным аллокатором, а затем забирается перемещением
+            SimpleVector rhs_copy(rhs, AllocTraits::propagate_on_container_copy_assignment::value
+                                           ? rhs.vector_.GetAllocator()
+                                           : vector_.GetAllocator());
+            *this = std::move(rhs_copy);
         }
         return *this;
     }
 
-    SimpleVector<Type>& operator=(SimpleVector&& other)
+    SIMPLE_VECTOR_CONSTEXPR SimpleVector& operator=(SimpleVector&& other) noexcept(AllocTraits::propagate_on_container_move_assignment::value
+                                                           || AllocTraits::is_always_equal::value)
     {
         if(this == &other)
         {
             return *this;
         }
-        vector_.swap(other.vector_);
-        std::swap(this->size_, other.size_);
-        std::swap(this->capacity_, other.capacity_);
+        if constexpr (AllocTraits::propagate_on_container_move_assignment::value || AllocTraits::is_always_equal::value)
+        {
+            StealFrom(other);
+        }
+        else if(vector_.GetAllocator() == other.vector_.GetAllocator())
+        {
+            StealFrom(other);
+        }
+        else
+        {
+            // Буфер other освобождается чужим ресурсом, поэтому элементы переносятся в наш
+            SimpleVector temp(std::move(other), vector_.GetAllocator());
+            StealFrom(temp);
+        }
         return *this;
     }
 
     //Перемещает содержимое объектов
-    void swap(SimpleVector& other) noexcept
+    SIMPLE_VECTOR_CONSTEXPR void swap(SimpleVector& other) noexcept
     {
         vector_.swap(other.vector_);
         std::swap(capacity_, other.capacity_);
         std::swap(size_, other.size_);
+        // Итераторы помнят вектор, а не буфер, поэтому после обмена недействительны
+        Invalidate();
+        other.Invalidate();
     }
 
     // Возвращает количество элементов в массиве
-    size_t GetSize() const noexcept {
+    SIMPLE_VECTOR_CONSTEXPR size_t GetSize() const noexcept {
         return size_;
     }
 
     // Возвращает вместимость массива
-    size_t GetCapacity() const noexcept {
+    SIMPLE_VECTOR_CONSTEXPR size_t GetCapacity() const noexcept {
         return capacity_;
     }
 
     // Сообщает, пустой ли массив
-    bool IsEmpty() const noexcept {
+    SIMPLE_VECTOR_CONSTEXPR bool IsEmpty() const noexcept {
         return (size_==0);
     }
 
+    // Возвращает указатель на первый элемент. В отличие от begin() это всегда сырой
+    // указатель, в том числе в режиме CHECKED
+    SIMPLE_VECTOR_CONSTEXPR Type* Data() noexcept {
+        return vector_.GetRawPtr();
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR const Type* Data() const noexcept {
+        return vector_.GetRawPtr();
+    }
+
+#if SIMPLE_VECTOR_HAS_CHECKED_ITERATORS
+    // Поколение буфера: растёт при каждой смене буфера, по нему итераторы узнают,
+    // что стали недействительными. Есть только в режиме CHECKED
+    SIMPLE_VECTOR_CONSTEXPR std::uint64_t GetGeneration() const noexcept {
+        return generation_;
+    }
+#endif
+
     // Возвращает ссылку на элемент с индексом index
-    Type& operator[](size_t index) noexcept {
-        assert(index < size_);
+    SIMPLE_VECTOR_CONSTEXPR Type& operator[](size_t index) noexcept {
+        SIMPLE_VECTOR_CHECK(index < size_, "Index is out of range");
         return vector_.GetRawPtr()[index];
     }
 
     // Возвращает константную ссылку на элемент с индексом index
-    const Type& operator[](size_t index) const noexcept {
-        assert(index < size_);
+    SIMPLE_VECTOR_CONSTEXPR const Type& operator[](size_t index) const noexcept {
+        SIMPLE_VECTOR_CHECK(index < size_, "Index is out of range");
         const Type& link = vector_.GetRawPtr()[index];
         return link;
     }
 
     // Возвращает константную ссылку на элемент с индексом index
     // Выбрасывает исключение std::out_of_range, если index >= size
-    Type& At(size_t index) {
+    SIMPLE_VECTOR_CONSTEXPR Type& At(size_t index) {
         if(index >= size_)
         {
             throw std::out_of_range("Index is out of range");
@@ -176,7 +393,7 @@ public:
 
     // Возвращает константную ссылку на элемент с индексом index
     // Выбрасывает исключение std::out_of_range, если index >= size
-    const Type& At(size_t index) const {
+    SIMPLE_VECTOR_CONSTEXPR const Type& At(size_t index) const {
         if(index >= size_)
         {
             throw std::out_of_range("Index is out of range");
@@ -185,181 +402,689 @@ public:
         return link;
     }
 
-    // Обнуляет размер массива, не изменяя его вместимость
-    void Clear() noexcept {
+    // Обнуляет размер массива. Вместимость не меняется, если политика роста
+    // не уменьшает буфер; при политике с уменьшением большой буфер освобождается
+    SIMPLE_VECTOR_CONSTEXPR void Clear() noexcept {
+        DestroyRange(vector_.GetAllocator(), Data(), Data() + size_);
+        AnnotateSize(size_, 0);
         size_ = 0;
+        ShrinkIfSparse();
     }
 
     // Изменяет размер массива.
     // При увеличении размера новые элементы получают значение по умолчанию для типа Type
-    void Resize(size_t new_size) {
+    SIMPLE_VECTOR_CONSTEXPR void Resize(size_t new_size) {
         if(new_size > capacity_)
         {
-            SimpleVector<Type> temp(new_size * 2);
-            std::move(begin(), end(), temp.begin());
-            swap(temp);
-            capacity_ = new_size * 2;
-            size_ = new_size;
+            Reserve(NextCapacity(new_size));
         }
-        else if(new_size > size_ && new_size <= capacity_)
+        if(new_size > size_)
         {
-            std::fill(std::next(begin(), static_cast<int>(size_)), std::next(begin(), static_cast<int>(new_size)), 0);
+            GrowthAnnotation annotation(*this, new_size);
+            UninitializedValueConstructN(vector_.GetAllocator(), Data() + size_, new_size - size_);
             size_ = new_size;
         }
         else
         {
+            DestroyRange(vector_.GetAllocator(), Data() + new_size, Data() + size_);
+            AnnotateSize(size_, new_size);
             size_ = new_size;
         }
+        ShrinkIfSparse();
     }
 
     // Возвращает итератор на начало массива
     // Для пустого массива может быть равен (или не равен) nullptr
-    Iterator begin() noexcept {
-        return vector_.GetRawPtr();
+    SIMPLE_VECTOR_CONSTEXPR Iterator begin() noexcept {
+        return MakeIterator(Data());
     }
 
     // Возвращает итератор на элемент, следующий за последним
     // Для пустого массива может быть равен (или не равен) nullptr
-    Iterator end() noexcept {
-        if(vector_.GetRawPtr() == nullptr)
-        {
-            return nullptr;
-        }
-        return &vector_.GetRawPtr()[size_];
+    SIMPLE_VECTOR_CONSTEXPR Iterator end() noexcept {
+        return MakeIterator(Data() + size_);
     }
 
     // Возвращает константный итератор на начало массива
     // Для пустого массива может быть равен (или не равен) nullptr
-    ConstIterator begin() const noexcept {
-        const Type* ptr = vector_.GetRawPtr();
-        return ptr;
+    SIMPLE_VECTOR_CONSTEXPR ConstIterator begin() const noexcept {
+        return MakeIterator(Data());
     }
 
     // Возвращает итератор на элемент, следующий за последним
     // Для пустого массива может быть равен (или не равен) nullptr
-    ConstIterator end() const noexcept {
-        if(vector_.GetRawPtr() == nullptr)
-        {
-            return nullptr;
-        }
-        const Type* ptr = &(vector_.GetRawPtr()[size_]);
-        return ptr;
+    SIMPLE_VECTOR_CONSTEXPR ConstIterator end() const noexcept {
+        return MakeIterator(Data() + size_);
     }
 
     // Возвращает константный итератор на начало массива
     // Для пустого массива может быть равен (или не равен) nullptr
-    ConstIterator cbegin() const noexcept {
-        const Type* const ptr = vector_.GetRawPtr();
-        return ptr;
+    SIMPLE_VECTOR_CONSTEXPR ConstIterator cbegin() const noexcept {
+        return MakeIterator(Data());
     }
 
     // Возвращает итератор на элемент, следующий за последним
     // Для пустого массива может быть равен (или не равен) nullptr
-    ConstIterator cend() const noexcept {
-        if(vector_.GetRawPtr() == nullptr)
+    SIMPLE_VECTOR_CONSTEXPR ConstIterator cend() const noexcept {
+        return MakeIterator(Data() + size_);
+    }
+
+    // Возвращает итератор на первый элемент, равный value, или end().
+    // Для целых чисел поиск идёт векторными инструкциями
+    SIMPLE_VECTOR_CONSTEXPR Iterator Find(const Type& value) noexcept {
+        return MakeIterator(Data() + (RangeFind(std::as_const(*this).Data(), size_, value) - Data()));
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR ConstIterator Find(const Type& value) const noexcept {
+        return MakeIterator(RangeFind(Data(), size_, value));
+    }
+
+    // Возвращает количество элементов, равных value
+    SIMPLE_VECTOR_CONSTEXPR size_t Count(const Type& value) const noexcept {
+        return RangeCount(Data(), size_, value);
+    }
+
+    // Возвращает итератор на первый наименьший элемент или end() для пустого вектора
+    SIMPLE_VECTOR_CONSTEXPR ConstIterator MinElement() const noexcept {
+        return MakeIterator(RangeMinElement(Data(), size_));
+    }
+
+    // Возвращает итератор на первый наибольший элемент или end() для пустого вектора
+    SIMPLE_VECTOR_CONSTEXPR ConstIterator MaxElement() const noexcept {
+        return MakeIterator(RangeMaxElement(Data(), size_));
+    }
+
+    // Создаёт элемент в конце вектора из аргументов args, без промежуточных копий
+    // Возвращает ссылку на созданный элемент
+    template <typename... Args>
+    SIMPLE_VECTOR_CONSTEXPR Type& EmplaceBack(Args&&... args)
+    {
+        if(size_ == capacity_)
         {
-            return nullptr;
+            return *ReallocateAndEmplace(size_, std::forward<Args>(args)...);
         }
-        const Type* const ptr = &(vector_.GetRawPtr()[size_]);
-        return ptr;
+        Type* slot = Data() + size_;
+        GrowthAnnotation annotation(*this, size_ + 1);
+        ConstructAt(vector_.GetAllocator(), slot, std::forward<Args>(args)...);
+        ++size_;
+        return *slot;
     }
 
-    void PushBack(const Type& element)
+    SIMPLE_VECTOR_CONSTEXPR void PushBack(const Type& element)
     {
-        size_t index = size_;
-        this->Resize(size_+1);
-        this->At(index) = element;
+        EmplaceBack(element);
     }
 
-    void PushBack(Type&& element)
+    SIMPLE_VECTOR_CONSTEXPR void PushBack(Type&& element)
     {
-        size_t index = size_;
-        this->Resize(size_+1);
-        this->At(index) = std::move(element);
+        EmplaceBack(std::move(element));
     }
 
-    void PopBack() noexcept
+    SIMPLE_VECTOR_CONSTEXPR void PopBack() noexcept
     {
-        assert(size_ != 0);
+        SIMPLE_VECTOR_CHECK(size_ != 0, "PopBack on empty vector");
         --size_;
+        DestroyAt(vector_.GetAllocator(), Data() + size_);
+        AnnotateSize(size_ + 1, size_);
+        ShrinkIfSparse();
     }
 
-    Iterator Erase(ConstIterator pos)
+    SIMPLE_VECTOR_CONSTEXPR Iterator Erase(ConstIterator pos)
     {
-        int64_t index = std::distance(cbegin(), pos);
-        assert(index < static_cast<int64_t>(size_) && index >= 0);
-        for(size_t i = static_cast<size_t>(index); i < size_- 1; ++i)
+        const size_t index = IndexOf(pos);
+        SIMPLE_VECTOR_CHECK(index < size_, "Erase position is out of range");
+        Type* it = Data() + index;
+        Type* last = Data() + size_;
+        stats_.Shifted(static_cast<size_t>(last - it - 1));
+        if constexpr (kIsTriviallyRelocatable<Type>)
+        {
+            DestroyAt(vector_.GetAllocator(), it);
+            RelocateOverlapping(it + 1, static_cast<size_t>(last - it - 1), it);
+        }
+        else
         {
-            this->At(i) = std::move(this->At(i + 1));
+            std::move(it + 1, last, it);
+            DestroyAt(vector_.GetAllocator(), last - 1);
         }
+        AnnotateSize(size_, size_ - 1);
         --size_;
-        Iterator it = std::next(begin(), index);
-        return it;
+        ShrinkIfSparse();
+        return MakeIterator(Data() + index);
+    }
+
+    // Создаёт элемент из аргументов args перед позицией pos
+    // Аргументы могут ссылаться на элементы самого вектора
+    template <typename... Args>
+    SIMPLE_VECTOR_CONSTEXPR Iterator Emplace(ConstIterator pos, Args&&... args)
+    {
+        const size_t index = IndexOf(pos);
+        SIMPLE_VECTOR_CHECK(index <= size_, "Insert position is out of range");
+        if(index == size_)
+        {
+            return MakeIterator(&EmplaceBack(std::forward<Args>(args)...));
+        }
+        if(size_ == capacity_)
+        {
+            return ReallocateAndEmplace(index, std::forward<Args>(args)...);
+        }
+        // Сюда попадает только непустой вектор, так что буфер выделен
+        assert(vector_);
+        Type* iter = Data() + index;
+        Type* last = Data() + size_;
+        stats_.Shifted(static_cast<size_t>(last - iter));
+        // Значение создаётся до сдвига, пока ссылки в args ещё указывают на свои элементы
+        Type value(std::forward<Args>(args)...);
+        GrowthAnnotation annotation(*this, size_ + 1);
+        if constexpr (kIsTriviallyRelocatable<Type>)
+        {
+            // Хвост сдвигается одним memmove, на освободившееся место переносится value
+            const size_t tail = static_cast<size_t>(last - iter);
+            RelocateOverlapping(iter, tail, iter + 1);
+            try
+            {
+                ConstructAt(vector_.GetAllocator(), iter, std::move(value));
+            }
+            catch(...)
+            {
+                RelocateOverlapping(iter + 1, tail, iter);
+                throw;
+            }
+        }
+        else
+        {
+            // Последний элемент переезжает в сырую ячейку, остальные сдвигаются присваиванием
+            ConstructAt(vector_.GetAllocator(), last, std::move(*(last - 1)));
+            std::move_backward(iter, last - 1, last);
+            *iter = std::move(value);
+        }
+        ++size_;
+        return MakeIterator(iter);
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR Iterator Insert(ConstIterator pos, const Type& value)
+    {
+        return Emplace(pos, value);
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR Iterator Insert(ConstIterator pos, Type&& value)
+    {
+        return Emplace(pos, std::move(value));
     }
 
-    Iterator Insert(ConstIterator pos, const Type& value)
+    // Вставляет count копий value перед pos. Хвост сдвигается один раз
+    // value может ссылаться на элемент самого вектора
+    SIMPLE_VECTOR_CONSTEXPR Iterator Insert(ConstIterator pos, size_t count, const Type& value)
     {
-        int64_t index = std::distance(cbegin(), pos);
-        assert(index <= static_cast<int64_t>(size_) && index >= 0);
-        size_t size_before = size_;
-        Resize(size_ + 1);
-        Iterator iter = begin() + index;
-        std::copy_backward(iter, begin() + size_before, end());
-        *iter = value;
-        return iter;
+        const Type copy(value);
+        return InsertWith(pos, count,
+            [&](Type* dest, size_t, size_t n) {
+                UninitializedFillN(vector_.GetAllocator(), dest, n, copy);
+            },
+            [&](Type* dest, size_t, size_t n) {
+                std::fill_n(dest, n, copy);
+            });
     }
 
-    Iterator Insert(ConstIterator pos, Type&& value)
+    // Вставляет элементы диапазона [first, last) перед pos и возвращает итератор на первый из них.
+    // Для прямых итераторов вектор растёт не более одного раза, хвост сдвигается один раз.
+    // Как и у std::vector, [first, last) не должен указывать внутрь самого вектора
+    template <typename InputIt, typename = std::enable_if_t<kIsIteratorOf<InputIt, std::input_iterator_tag>>>
+    SIMPLE_VECTOR_CONSTEXPR Iterator Insert(ConstIterator pos, InputIt first, InputIt last)
     {
-        int64_t index = std::distance(cbegin(), pos);
-        assert(index <= static_cast<int64_t>(size_) && index >= 0);
-        size_t size_before = size_;
-        Resize(size_ + 1);
-        Iterator iter = begin() + index;
-        std::move_backward(iter, begin() + size_before, end());
-        *iter = std::move(value);
-        return iter;
+        if constexpr (kIsIteratorOf<InputIt, std::forward_iterator_tag>)
+        {
+            const auto count = static_cast<size_t>(std::distance(first, last));
+            return InsertWith(pos, count,
+                [&](Type* dest, size_t offset, size_t n) {
+                    auto from = std::next(first, static_cast<std::ptrdiff_t>(offset));
+                    UninitializedCopy(vector_.GetAllocator(), from, std::next(from, static_cast<std::ptrdiff_t>(n)), dest);
+                },
+                [&](Type* dest, size_t offset, size_t n) {
+                    std::copy_n(std::next(first, static_cast<std::ptrdiff_t>(offset)), n, dest);
+                });
+        }
+        else
+        {
+            // Однопроходный диапазон: длина заранее неизвестна, поэтому элементы
+            // добавляются в конец и затем одним поворотом переезжают на место
+            const size_t index = IndexOf(pos);
+            SIMPLE_VECTOR_CHECK(index <= size_, "Insert position is out of range");
+            const size_t old_size = size_;
+            for(; first != last; ++first)
+            {
+                EmplaceBack(*first);
+            }
+            std::rotate(Data() + index, Data() + old_size, Data() + size_);
+            stats_.Shifted(old_size - index);
+            return MakeIterator(Data() + index);
+        }
+    }
+
+    // Добавляет элементы [first, last) в конец вектора
+    template <typename InputIt, typename = std::enable_if_t<kIsIteratorOf<InputIt, std::input_iterator_tag>>>
+    SIMPLE_VECTOR_CONSTEXPR void Append(InputIt first, InputIt last)
+    {
+        Insert(cend(), first, last);
+    }
+
+    // Добавляет в конец вектора все элементы range
+    template <typename Range>
+    SIMPLE_VECTOR_CONSTEXPR void Append(const Range& range)
+    {
+        Append(std::begin(range), std::end(range));
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR void Append(std::initializer_list<Type> init)
+    {
+        Append(init.begin(), init.end());
+    }
+
+    // Дописывает count элементов, которые construct(alloc, dest, count) создаёт прямо
+    // в сырой памяти за концом вектора. construct обязан либо создать все count элементов,
+    // либо разрушить созданные и выбросить исключение - тогда вектор не меняется
+    template <typename Construct>
+    SIMPLE_VECTOR_CONSTEXPR void AppendConstructed(size_t count, Construct construct)
+    {
+        if(count > AllocTraits::max_size(vector_.GetAllocator()) - size_)
+        {
+            throw std::length_error("SimpleVector is too long");
+        }
+        if(size_ + count > capacity_)
+        {
+            Reserve(NextCapacity(size_ + count));
+        }
+        GrowthAnnotation annotation(*this, size_ + count);
+        construct(vector_.GetAllocator(), Data() + size_, count);
+        size_ += count;
+    }
+
+    // Удаляет элементы [first, last) и возвращает итератор на элемент, следовавший за ними
+    // Хвост сдвигается один раз
+    SIMPLE_VECTOR_CONSTEXPR Iterator Erase(ConstIterator first, ConstIterator last)
+    {
+        const size_t index = IndexOf(first);
+        const size_t end_index = IndexOf(last);
+        SIMPLE_VECTOR_CHECK(index <= end_index && end_index <= size_, "Erase range is out of range");
+        const size_t count = end_index - index;
+        Type* it = Data() + index;
+        if(count == 0)
+        {
+            return MakeIterator(it);
+        }
+        Type* old_end = Data() + size_;
+        stats_.Shifted(static_cast<size_t>(old_end - it) - count);
+        if constexpr (kIsTriviallyRelocatable<Type>)
+        {
+            DestroyRange(vector_.GetAllocator(), it, it + count);
+            RelocateOverlapping(it + count, static_cast<size_t>(old_end - it) - count, it);
+        }
+        else
+        {
+            std::move(it + count, old_end, it);
+            DestroyRange(vector_.GetAllocator(), old_end - count, old_end);
+        }
+        AnnotateSize(size_, size_ - count);
+        size_ -= count;
+        ShrinkIfSparse();
+        return MakeIterator(Data() + index);
     }
 
-    
 
 private:
-    ArrayPtr<Type> vector_;
+    // Вместимость, до которой нужно расти, чтобы вместить required элементов
+    SIMPLE_VECTOR_CONSTEXPR size_t NextCapacity(size_t required) const noexcept
+    {
+        const size_t max_size = AllocTraits::max_size(vector_.GetAllocator());
+        return std::min(GrowthPolicy::NextCapacity(capacity_, required, sizeof(Type)), std::max(required, max_size));
+    }
+
+    // Переносит элементы в новый буфер на new_capacity ячеек (new_capacity >= size_)
+    SIMPLE_VECTOR_CONSTEXPR void Reallocate(size_t new_capacity)
+    {
+        ArrayPtr<Type, Allocator> temp(new_capacity, vector_.GetAllocator());
+        UninitializedRelocate(vector_.GetAllocator(), Data(), Data() + size_, temp.GetRawPtr());
+        stats_.Allocated(new_capacity, capacity_ != 0);
+        stats_.Relocated(size_, kRelocatesByCopy<Type>);
+        DiscardBuffer();
+        vector_ = std::move(temp);
+        capacity_ = new_capacity;
+        AnnotateNew();
+    }
+
+    // Уменьшает буфер, если этого просит политика роста. Возвращает true, если буфер
+    // сменился. Уменьшение - только оптимизация, так что при нехватке памяти или
+    // исключении при переносе буфер остаётся прежним
+    SIMPLE_VECTOR_CONSTEXPR bool ShrinkIfSparse() noexcept
+    {
+        if constexpr (kGrowthShrinks<GrowthPolicy>)
+        {
+            const size_t target = GrowthPolicy::ShrinkCapacity(capacity_, size_, sizeof(Type));
+            if(target < capacity_)
+            {
+                try
+                {
+                    Reallocate(std::max(target, size_));
+                    return true;
+                }
+                catch(...)
+                {
+                }
+            }
+        }
+        return false;
+    }
+
+    // Выделяет буфер, в котором хватит места ещё на count элементов
+    SIMPLE_VECTOR_CONSTEXPR ArrayPtr<Type, Allocator> AllocateForGrowth(size_t count)
+    {
+        // Первое условие всегда ложно, но без него компилятор не знает, что
+        // size_ + count не переполняется, и предупреждает о memcpy на невозможном пути
+        const size_t max_size = AllocTraits::max_size(vector_.GetAllocator());
+        if(size_ > max_size || count > max_size - size_)
+        {
+            throw std::length_error("SimpleVector is too long");
+        }
+        return ArrayPtr<Type, Allocator>(NextCapacity(size_ + count), vector_.GetAllocator());
+    }
+
+    // Переносит элементы в новый буфер temp так, чтобы между [0, index) и [index, size_)
+    // остался промежуток [index, index + gap), где уже созданы новые элементы.
+    // Если перенос не удался, новые элементы разрушаются, а вектор остаётся прежним
+    SIMPLE_VECTOR_CONSTEXPR void RelocateAround(ArrayPtr<Type, Allocator>& temp, size_t index, size_t gap)
+    {
+        Allocator& alloc = vector_.GetAllocator();
+        Type* new_data = temp.GetRawPtr();
+        if constexpr (kIsTriviallyRelocatable<Type>)
+        {
+            UninitializedRelocate(alloc, Data(), Data() + index, new_data);
+            UninitializedRelocate(alloc, Data() + index, Data() + size_, new_data + index + gap);
+        }
+        else
+        {
+            try
+            {
+                UninitializedMoveIfNoexcept(alloc, Data(), Data() + index, new_data);
+                try
+                {
+                    UninitializedMoveIfNoexcept(alloc, Data() + index, Data() + size_, new_data + index + gap);
+                }
+                catch(...)
+                {
+                    DestroyRange(alloc, new_data, new_data + index);
+                    throw;
+                }
+            }
+            catch(...)
+            {
+                DestroyRange(alloc, new_data + index, new_data + index + gap);
+                throw;
+            }
+            DestroyRange(alloc, Data(), Data() + size_);
+        }
+        stats_.Allocated(temp.GetSize(), capacity_ != 0);
+        stats_.Relocated(size_, kRelocatesByCopy<Type>);
+        DiscardBuffer();
+        capacity_ = temp.GetSize();
+        vector_ = std::move(temp);
+        size_ += gap;
+        AnnotateNew();
+    }
+
+    // Медленный путь вставки: выделяет новый буфер, создаёт в нём элемент с индексом index
+    // и переносит вокруг него старые элементы. Новый элемент создаётся первым, чтобы args
+    // могли ссылаться на элементы вектора
+    template <typename... Args>
+    SIMPLE_VECTOR_CONSTEXPR Iterator ReallocateAndEmplace(size_t index, Args&&... args)
+    {
+        ArrayPtr<Type, Allocator> temp = AllocateForGrowth(1);
+        ConstructAt(vector_.GetAllocator(), temp.GetRawPtr() + index, std::forward<Args>(args)...);
+        RelocateAround(temp, index, 1);
+        return MakeIterator(Data() + index);
+    }
+
+    // Общая часть вставки count элементов перед pos.
+    // construct(dest, offset, n) создаёт в сырой памяти dest новые элементы с номерами
+    // [offset, offset + n), assign(dest, offset, n) присваивает их уже живым элементам
+    template <typename Construct, typename Assign>
+    SIMPLE_VECTOR_CONSTEXPR Iterator InsertWith(ConstIterator pos, size_t count, Construct construct, Assign assign)
+    {
+        const size_t index = IndexOf(pos);
+        SIMPLE_VECTOR_CHECK(index <= size_, "Insert position is out of range");
+        if(count == 0)
+        {
+            return MakeIterator(Data() + index);
+        }
+        if(count > capacity_ - size_)
+        {
+            ArrayPtr<Type, Allocator> temp = AllocateForGrowth(count);
+            construct(temp.GetRawPtr() + index, 0, count);
+            RelocateAround(temp, index, count);
+            return MakeIterator(Data() + index);
+        }
+
+        Allocator& alloc = vector_.GetAllocator();
+        Type* iter = Data() + index;
+        Type* old_end = Data() + size_;
+        const size_t elems_after = size_ - index;
+        GrowthAnnotation annotation(*this, size_ + count);
+        stats_.Shifted(elems_after);
+        if constexpr (kIsTriviallyRelocatable<Type>)
+        {
+            RelocateOverlapping(iter, elems_after, iter + count);
+            try
+            {
+                construct(iter, 0, count);
+            }
+            catch(...)
+            {
+                RelocateOverlapping(iter + count, elems_after, iter);
+                throw;
+            }
+            size_ += count;
+        }
+        else if(elems_after > count)
+        {
+            // Последние count элементов переезжают в сырую память, остальной хвост сдвигается присваиванием
+            UninitializedCopy(alloc, std::make_move_iterator(old_end - count), std::make_move_iterator(old_end), old_end);
+            size_ += count;
+            std::move_backward(iter, old_end - count, old_end);
+            assign(iter, 0, count);
+        }
+        else
+        {
+            // Новые элементы выходят за старый конец: их часть создаётся сразу в сырой памяти
+            construct(old_end, elems_after, count - elems_after);
+            size_ += count - elems_after;
+            UninitializedCopy(alloc, std::make_move_iterator(iter), std::make_move_iterator(old_end), iter + count);
+            size_ += elems_after;
+            assign(iter, 0, elems_after);
+        }
+        return MakeIterator(iter);
+    }
+
+    // Уничтожает свои элементы и забирает буфер other. Аллокаторы должны быть равны,
+    // либо аллокатор other должен переезжать при перемещающем присваивании
+    SIMPLE_VECTOR_CONSTEXPR void StealFrom(SimpleVector& other) noexcept
+    {
+        // Не Clear: политика с уменьшением перевыделила бы буфер, который сейчас уйдёт
+        DestroyRange(vector_.GetAllocator(), Data(), Data() + size_);
+        AnnotateSize(size_, 0);
+        size_ = 0;
+        // Наш буфер освобождается или, при равных аллокаторах, достаётся other пустым
+        DiscardBuffer();
+        vector_ = std::move(other.vector_);
+        size_ = std::exchange(other.size_, 0);
+        capacity_ = vector_.GetSize();
+        other.capacity_ = other.vector_.GetSize();
+        Invalidate();
+        other.Invalidate();
+        other.AnnotateNew();
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR Iterator MakeIterator(Type* ptr) noexcept
+    {
+#if SIMPLE_VECTOR_HAS_CHECKED_ITERATORS
+        return Iterator(ptr, this);
+#else
+        return ptr;
+#endif
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR ConstIterator MakeIterator(const Type* ptr) const noexcept
+    {
+#if SIMPLE_VECTOR_HAS_CHECKED_ITERATORS
+        return ConstIterator(ptr, this);
+#else
+        return ptr;
+#endif
+    }
+
+    // Номер позиции pos. В режиме CHECKED pos обязан быть действительным итератором этого вектора
+    SIMPLE_VECTOR_CONSTEXPR size_t IndexOf(ConstIterator pos) const noexcept
+    {
+#if SIMPLE_VECTOR_HAS_CHECKED_ITERATORS
+        return static_cast<size_t>(pos.Unwrap(this) - Data());
+#else
+        return static_cast<size_t>(pos - Data());
+#endif
+    }
+
+    // Делает недействительными все итераторы вектора. Вызывается при смене буфера
+    SIMPLE_VECTOR_CONSTEXPR void Invalidate() noexcept
+    {
+#if SIMPLE_VECTOR_HAS_CHECKED_ITERATORS
+        ++generation_;
+#endif
+    }
+
+    // Под ASan делает доступными ячейки [0, new_size) вместо [0, old_size).
+    // Без проверок и при вычислении констант ничего не делает
+    SIMPLE_VECTOR_CONSTEXPR void MarkSize(size_t old_size, size_t new_size) noexcept
+    {
+#if SIMPLE_VECTOR_HAS_CHECKED_ITERATORS
+        if(!IsConstantEvaluated() && capacity_ != 0)
+        {
+            Type* data = Data();
+            hardening_detail::AnnotateContiguous(data, data + capacity_, data + old_size, data + new_size);
+        }
+#else
+        (void)old_size;
+        (void)new_size;
+#endif
+    }
+
+    // Сообщает, что живых элементов стало new_size вместо old_size. В режиме CHECKED
+    // освободившиеся ячейки заполняются kPoisonByte и закрываются для ASan
+    SIMPLE_VECTOR_CONSTEXPR void AnnotateSize(size_t old_size, size_t new_size) noexcept
+    {
+#if SIMPLE_VECTOR_HAS_CHECKED_ITERATORS
+        if(!IsConstantEvaluated() && new_size < old_size)
+        {
+            hardening_detail::PoisonFill(static_cast<void*>(Data() + new_size), (old_size - new_size) * sizeof(Type));
+        }
+#endif
+        MarkSize(old_size, new_size);
+    }
+
+    // Только что полученный буфер целиком доступен, закрываем его хвост [size_, capacity_)
+    SIMPLE_VECTOR_CONSTEXPR void AnnotateNew() noexcept
+    {
+        AnnotateSize(capacity_, size_);
+    }
+
+    // Снимает пометки с буфера перед тем, как он уйдёт из вектора
+    SIMPLE_VECTOR_CONSTEXPR void AnnotateDelete() noexcept
+    {
+        MarkSize(size_, capacity_);
+    }
+
+    // Готовит к освобождению буфер, из которого элементы уже перенесены или разрушены:
+    // снимает пометки и заполняет его kPoisonByte, а итераторы в него делает недействительными
+    SIMPLE_VECTOR_CONSTEXPR void DiscardBuffer() noexcept
+    {
+        AnnotateDelete();
+        Invalidate();
+#if SIMPLE_VECTOR_HAS_CHECKED_ITERATORS
+        if(!IsConstantEvaluated() && capacity_ != 0)
+        {
+            hardening_detail::PoisonFill(static_cast<void*>(Data()), capacity_ * sizeof(Type));
+        }
+#endif
+    }
+
+    // На время роста на месте открывает ячейки до reach, а по выходу, в том числе
+    // по исключению, закрывает всё за фактическим size_
+    class GrowthAnnotation {
+    public:
+        SIMPLE_VECTOR_CONSTEXPR GrowthAnnotation(SimpleVector& owner, size_t reach) noexcept
+            : owner_(owner)
+            , reach_(reach)
+        {
+            owner_.MarkSize(owner_.size_, reach_);
+        }
+
+        GrowthAnnotation(const GrowthAnnotation&) = delete;
+        GrowthAnnotation& operator=(const GrowthAnnotation&) = delete;
+
+        SIMPLE_VECTOR_CONSTEXPR ~GrowthAnnotation()
+        {
+            owner_.AnnotateSize(reach_, owner_.size_);
+        }
+
+    private:
+        SimpleVector& owner_;
+        size_t reach_;
+    };
+
+    ArrayPtr<Type, Allocator> vector_;
     size_t size_ = 0;
     size_t capacity_ = 0;
+#if SIMPLE_VECTOR_HAS_CHECKED_ITERATORS
+    std::uint64_t generation_ = 0;
+#endif
+    // Пуст, если статистика для Type не включена
+    [[no_unique_address]] SimpleVectorStatsRecorder<Type> stats_;
 };
 
 
-template <typename Type>
-bool operator==(const SimpleVector<Type>& lhs, const SimpleVector<Type>& rhs) {
+template <typename Type, typename Allocator, typename Growth>
+SIMPLE_VECTOR_CONSTEXPR bool operator==(const SimpleVector<Type, Allocator, Growth>& lhs, const SimpleVector<Type, Allocator, Growth>& rhs) {
     if(lhs.GetSize() == rhs.GetSize())
     {
-        return std::equal(lhs.cbegin(), lhs.cend(), rhs.cbegin(), rhs.cend());
+        return RangeEqual(lhs.Data(), rhs.Data(), lhs.GetSize());
     }
     return false;
 }
 
-template <typename Type>
-bool operator!=(const SimpleVector<Type>& lhs, const SimpleVector<Type>& rhs) {
+template <typename Type, typename Allocator, typename Growth>
+SIMPLE_VECTOR_CONSTEXPR bool operator!=(const SimpleVector<Type, Allocator, Growth>& lhs, const SimpleVector<Type, Allocator, Growth>& rhs) {
     return !(lhs == rhs);
 }
 
-template <typename Type>
-bool operator<(const SimpleVector<Type>& lhs, const SimpleVector<Type>& rhs) {
-    return std::lexicographical_compare(lhs.cbegin(), lhs.cend(), rhs.cbegin(), rhs.cend());
+// Все отношения порядка проходят векторы один раз
+template <typename Type, typename Allocator, typename Growth>
+SIMPLE_VECTOR_CONSTEXPR bool operator<(const SimpleVector<Type, Allocator, Growth>& lhs, const SimpleVector<Type, Allocator, Growth>& rhs) {
+    return RangeCompare(lhs.Data(), lhs.GetSize(), rhs.Data(), rhs.GetSize()) < 0;
 }
 
-template <typename Type>
-bool operator>(const SimpleVector<Type>& lhs, const SimpleVector<Type>& rhs) {
-    return (!(lhs < rhs) && (lhs != rhs));
+template <typename Type, typename Allocator, typename Growth>
+SIMPLE_VECTOR_CONSTEXPR bool operator>(const SimpleVector<Type, Allocator, Growth>& lhs, const SimpleVector<Type, Allocator, Growth>& rhs) {
+    return RangeCompare(lhs.Data(), lhs.GetSize(), rhs.Data(), rhs.GetSize()) > 0;
 }
 
-template <typename Type>
-bool operator<=(const SimpleVector<Type>& lhs, const SimpleVector<Type>& rhs) {
-    return !(lhs > rhs);
+template <typename Type, typename Allocator, typename Growth>
+SIMPLE_VECTOR_CONSTEXPR bool operator<=(const SimpleVector<Type, Allocator, Growth>& lhs, const SimpleVector<Type, Allocator, Growth>& rhs) {
+    return RangeCompare(lhs.Data(), lhs.GetSize(), rhs.Data(), rhs.GetSize()) <= 0;
 }
 
-template <typename Type>
-bool operator>=(const SimpleVector<Type>& lhs, const SimpleVector<Type>& rhs) {
-    return !(lhs<rhs);
+template <typename Type, typename Allocator, typename Growth>
+SIMPLE_VECTOR_CONSTEXPR bool operator>=(const SimpleVector<Type, Allocator, Growth>& lhs, const SimpleVector<Type, Allocator, Growth>& rhs) {
+    return RangeCompare(lhs.Data(), lhs.GetSize(), rhs.Data(), rhs.GetSize()) >= 0;
+}
+
+#if defined(__cpp_impl_three_way_comparison) && defined(__cpp_lib_three_way_comparison)
+template <typename Type, typename Allocator, typename Growth>
+SIMPLE_VECTOR_CONSTEXPR SynthThreeWayResult<Type> operator<=>(const SimpleVector<Type, Allocator, Growth>& lhs, const SimpleVector<Type, Allocator, Growth>& rhs) {
+    return RangeCompareThreeWay(lhs.Data(), lhs.GetSize(), rhs.Data(), rhs.GetSize());
 }
+#endif
@@ -0,0 +1,474 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "simple_vector.h"
+
+// Двоичный формат SimpleVector тривиально копируемых элементов.
+//
+// Файл - это последовательность записей "заголовок + элементы". Заголовок занимает
+// 32 байта, поэтому элементы начинаются с выровненного смещения. Поля заголовка и
+// элементы хранятся в порядке байтов записавшей машины; byte_order позволяет читателю
+// распознать чужой порядок. Для арифметических типов он переворачивается при чтении,
+// для прочих типов такое чтение запрещено.
+//
+// Контрольная сумма - Checksum64 от байтов элементов в том виде, в каком они лежат
+// в файле. Она считается по 8-байтным словам и почти не замедляет запись и чтение
+//
+// Запись вектора - один writev из заголовка и элементов, без промежуточных буферов.
+// Чтение - read заголовка и read элементов прямо в память вектора кусками не больше
+// kReadChunkBytes, так что испорченный счётчик в заголовке не заставит выделить
+// память под несуществующие элементы. У обычного файла счётчик сверяется с его размером.
+// Несколько векторов пишутся одним writev (WriteSimpleVectors), а читаются
+// последовательными вызовами ReadSimpleVector
+
+inline constexpr std::uint32_t kSimpleVectorFormatVersion = 1;
+inline constexpr std::uint32_t kSimpleVectorByteOrderMark = 0x01020304;
+
+struct SimpleVectorFileHeader {
+    char magic[4] = {'S', 'V', 'E', 'C'};
+    std::uint32_t byte_order = kSimpleVectorByteOrderMark;
+    std::uint32_t version = kSimpleVectorFormatVersion;
+    std::uint32_t element_size = 0;
+    std::uint64_t count = 0;
+    std::uint64_t checksum = 0;
+};
+
+static_assert(sizeof(SimpleVectorFileHeader) == 32 && std::is_trivially_copyable_v<SimpleVectorFileHeader>);
+
+// Потоковая 64-битная контрольная сумма. Байты собираются в слова little-endian,
+// слова раскладываются по четырём независимым полосам и перемешиваются с ними
+// умножением. Полосы не ждут друг друга, поэтому сумма считается со скоростью
+// памяти. Результат не зависит ни от порядка байтов машины, ни от того,
+// какими кусками подаются данные
+class Checksum64 {
+public:
+    void Update(const void* data, size_t bytes) noexcept
+    {
+        if(bytes == 0)
+        {
+            return;
+        }
+        const auto* input = static_cast<const unsigned char*>(data);
+        total_ += bytes;
+        if(pending_size_ != 0)
+        {
+            const size_t take = std::min(bytes, kStripe - pending_size_);
+            std::memcpy(pending_ + pending_size_, input, take);
+            pending_size_ += take;
+            input += take;
+            bytes -= take;
+            if(pending_size_ < kStripe)
+            {
+                return;
+            }
+            MixStripe(pending_);
+            pending_size_ = 0;
+        }
+        for(; bytes >= kStripe; input += kStripe, bytes -= kStripe)
+        {
+            MixStripe(input);
+        }
+        if(bytes != 0)
+        {
+            std::memcpy(pending_, input, bytes);
+            pending_size_ = bytes;
+        }
+    }
+
+    std::uint64_t Finish() const noexcept
+    {
+        unsigned char tail[kStripe] = {};
+        std::memcpy(tail, pending_, pending_size_);
+        std::uint64_t state = total_;
+        for(size_t lane = 0; lane < kLanes; ++lane)
+        {
+            state = Mix(state, lanes_[lane]);
+            state = Mix(state, LoadWord(tail + lane * 8));
+        }
+        return state ^ (state >> 32);
+    }
+
+private:
+    static constexpr size_t kLanes = 4;
+    static constexpr size_t kStripe = kLanes * 8;
+    static constexpr std::uint64_t kPrime = 0x9E3779B97F4A7C15ULL;
+
+    static std::uint64_t LoadWord(const unsigned char* bytes) noexcept
+    {
+        std::uint64_t word;
+        std::memcpy(&word, bytes, sizeof(word));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        word = __builtin_bswap64(word);
+#endif
+        return word;
+    }
+
+    static std::uint64_t Mix(std::uint64_t state, std::uint64_t word) noexcept
+    {
+        state = (state ^ word) * kPrime;
+        return state ^ (state >> 29);
+    }
+
+    void MixStripe(const unsigned char* stripe) noexcept
+    {
+        for(size_t lane = 0; lane < kLanes; ++lane)
+        {
+            lanes_[lane] = Mix(lanes_[lane], LoadWord(stripe + lane * 8));
+        }
+    }
+
+    std::uint64_t lanes_[kLanes] = {0x243F6A8885A308D3ULL, 0x13198A2E03707344ULL,
+                                    0xA4093822299F31D0ULL, 0x082EFA98EC4E6C89ULL};
+    std::uint64_t total_ = 0;
+    unsigned char pending_[kStripe] = {};
+    size_t pending_size_ = 0;
+};
+
+namespace io_detail {
+
+[[noreturn]] inline void ThrowSystemError(const char* what)
+{
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+// Пишет все части, продолжая после частичной записи и прерываний сигналом
+inline void WriteAll(int fd, iovec* parts, size_t count)
+{
+    while(count != 0)
+    {
+        const int batch = static_cast<int>(std::min<size_t>(count, IOV_MAX));
+        const ssize_t written = ::writev(fd, parts, batch);
+        if(written < 0)
+        {
+            if(errno == EINTR)
+            {
+                continue;
+            }
+            ThrowSystemError("writev");
+        }
+        auto left = static_cast<size_t>(written);
+        while(count != 0 && left >= parts->iov_len)
+        {
+            left -= parts->iov_len;
+            ++parts;
+            --count;
+        }
+        if(count != 0)
+        {
+            parts->iov_base = static_cast<char*>(parts->iov_base) + left;
+            parts->iov_len -= left;
+        }
+    }
+}
+
+// Читает ровно bytes байтов. Выбрасывает std::runtime_error, если файл кончился раньше
+inline void ReadExact(int fd, void* data, size_t bytes)
+{
+    auto* output = static_cast<char*>(data);
+    while(bytes != 0)
+    {
+        // Linux читает за один вызов не больше 2 ГБ
+        const ssize_t got = ::read(fd, output, std::min<size_t>(bytes, size_t{1} << 30));
+        if(got < 0)
+        {
+            if(errno == EINTR)
+            {
+                continue;
+            }
+            ThrowSystemError("read");
+        }
+        if(got == 0)
+        {
+            throw std::runtime_error("Unexpected end of SimpleVector file");
+        }
+        output += got;
+        bytes -= static_cast<size_t>(got);
+    }
+}
+
+// Элементы читаются в вектор кусками такого размера
+inline constexpr size_t kReadChunkBytes = size_t{1} << 20;
+
+// Сколько байтов обычного файла осталось после текущей позиции. У каналов, сокетов
+// и прочих дескрипторов без размера возвращает std::nullopt
+inline std::optional<std::uint64_t> RemainingFileBytes(int fd)
+{
+    struct stat info;
+    if(::fstat(fd, &info) != 0)
+    {
+        ThrowSystemError("fstat");
+    }
+    if(!S_ISREG(info.st_mode))
+    {
+        return std::nullopt;
+    }
+    const off_t offset = ::lseek(fd, 0, SEEK_CUR);
+    if(offset < 0)
+    {
+        ThrowSystemError("lseek");
+    }
+    return offset < info.st_size ? static_cast<std::uint64_t>(info.st_size - offset) : 0;
+}
+
+template <typename T>
+T ByteSwap(T value) noexcept
+{
+    unsigned char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    std::reverse(bytes, bytes + sizeof(T));
+    std::memcpy(&value, bytes, sizeof(T));
+    return value;
+}
+
+// Закрывает файловый дескриптор при выходе из области видимости
+class FileCloser {
+public:
+    explicit FileCloser(int fd) noexcept
+    : fd_(fd)
+    {}
+
+    FileCloser(const FileCloser&) = delete;
+    FileCloser& operator=(const FileCloser&) = delete;
+
+    ~FileCloser()
+    {
+        ::close(fd_);
+    }
+
+private:
+    int fd_;
+};
+
+inline int OpenFile(const std::string& path, int flags)
+{
+    const int fd = ::open(path.c_str(), flags | O_CLOEXEC, 0644);
+    if(fd < 0)
+    {
+        throw std::system_error(errno, std::generic_category(), "open " + path);
+    }
+    return fd;
+}
+
+template <typename Type, typename Allocator, typename Growth>
+SimpleVectorFileHeader MakeHeader(const SimpleVector<Type, Allocator, Growth>& v) noexcept
+{
+    SimpleVectorFileHeader header;
+    header.element_size = sizeof(Type);
+    header.count = v.GetSize();
+    Checksum64 checksum;
+    checksum.Update(v.Data(), v.GetSize() * sizeof(Type));
+    header.checksum = checksum.Finish();
+    return header;
+}
+
+} // namespace io_detail
+
+// Читает вектор из файла по частям, складывая каждую часть в один и тот же SimpleVector.
+// Если вместимости вектора хватает на часть, память не перевыделяется.
+// Контрольная сумма проверяется, когда прочитана последняя часть
+template <typename Type>
+class SimpleVectorReader {
+    static_assert(std::is_trivially_copyable_v<Type>, "Only trivially copyable elements can be read as bytes");
+
+public:
+    // Читает и проверяет заголовок. Выбрасывает std::runtime_error, если заголовок
+    // повреждён, описывает элементы другого размера или, для обычного файла,
+    // обещает больше элементов, чем в файле осталось байтов
+    explicit SimpleVectorReader(int fd)
+    : fd_(fd)
+    {
+        io_detail::ReadExact(fd_, &header_, sizeof(header_));
+        if(std::memcmp(header_.magic, SimpleVectorFileHeader().magic, sizeof(header_.magic)) != 0)
+        {
+            throw std::runtime_error("Not a SimpleVector file");
+        }
+        if(header_.byte_order != kSimpleVectorByteOrderMark)
+        {
+            if(header_.byte_order != io_detail::ByteSwap(kSimpleVectorByteOrderMark))
+            {
+                throw std::runtime_error("Corrupted SimpleVector file header");
+            }
+            swapped_ = true;
+            header_.byte_order = kSimpleVectorByteOrderMark;
+            header_.version = io_detail::ByteSwap(header_.version);
+            header_.element_size = io_detail::ByteSwap(header_.element_size);
+            header_.count = io_detail::ByteSwap(header_.count);
+            header_.checksum = io_detail::ByteSwap(header_.checksum);
+        }
+        if(header_.version == 0 || header_.version > kSimpleVectorFormatVersion)
+        {
+            throw std::runtime_error("Unsupported SimpleVector file version");
+        }
+        if(header_.element_size != sizeof(Type))
+        {
+            throw std::runtime_error("SimpleVector file holds elements of another size");
+        }
+        if(swapped_ && !std::is_arithmetic_v<Type>)
+        {
+            throw std::runtime_error("SimpleVector file was written with another byte order");
+        }
+        remaining_ = header_.count;
+        if(const auto bytes = io_detail::RemainingFileBytes(fd_))
+        {
+            if(remaining_ > *bytes / sizeof(Type))
+            {
+                throw std::runtime_error("SimpleVector file is shorter than its header says");
+            }
+            size_checked_ = true;
+        }
+        if(remaining_ == 0 && checksum_.Finish() != header_.checksum)
+        {
+            throw std::runtime_error("SimpleVector file checksum mismatch");
+        }
+    }
+
+    const SimpleVectorFileHeader& GetHeader() const noexcept
+    {
+        return header_;
+    }
+
+    // Сколько элементов ещё не прочитано
+    size_t GetRemaining() const noexcept
+    {
+        return remaining_;
+    }
+
+    // Подтвердил ли размер файла, что все GetRemaining() элементов в нём есть.
+    // Для каналов и сокетов счётчик из заголовка проверить нельзя
+    bool IsSizeChecked() const noexcept
+    {
+        return size_checked_;
+    }
+
+    // Заменяет содержимое chunk следующими не более чем max_count элементами.
+    // Возвращает false, если элементы кончились. Выбрасывает std::runtime_error,
+    // если после последней части не сошлась контрольная сумма
+    template <typename Allocator, typename Growth>
+    bool ReadChunk(SimpleVector<Type, Allocator, Growth>& chunk, size_t max_count)
+    {
+        chunk.Clear();
+        return AppendChunk(chunk, max_count);
+    }
+
+    // Как ReadChunk, но дописывает элементы в конец chunk
+    template <typename Allocator, typename Growth>
+    bool AppendChunk(SimpleVector<Type, Allocator, Growth>& chunk, size_t max_count)
+    {
+        if(remaining_ == 0)
+        {
+            return false;
+        }
+        const size_t count = std::min<std::uint64_t>(remaining_, max_count);
+        chunk.AppendConstructed(count, [this](Allocator&, Type* dest, size_t n) {
+            io_detail::ReadExact(fd_, dest, n * sizeof(Type));
+            checksum_.Update(dest, n * sizeof(Type));
+            if(swapped_)
+            {
+                std::transform(dest, dest + n, dest, io_detail::ByteSwap<Type>);
+            }
+        });
+        remaining_ -= count;
+        if(remaining_ == 0 && checksum_.Finish() != header_.checksum)
+        {
+            throw std::runtime_error("SimpleVector file checksum mismatch");
+        }
+        return true;
+    }
+
+private:
+    int fd_;
+    SimpleVectorFileHeader header_;
+    std::uint64_t remaining_ = 0;
+    Checksum64 checksum_;
+    bool swapped_ = false;
+    bool size_checked_ = false;
+};
+
+// Записывает вектор в файловый дескриптор одним writev
+template <typename Type, typename Allocator, typename Growth>
+void WriteSimpleVector(int fd, const SimpleVector<Type, Allocator, Growth>& v)
+{
+    static_assert(std::is_trivially_copyable_v<Type>, "Only trivially copyable elements can be written as bytes");
+    SimpleVectorFileHeader header = io_detail::MakeHeader(v);
+    iovec parts[2] = {
+        {&header, sizeof(header)},
+        {const_cast<Type*>(v.Data()), v.GetSize() * sizeof(Type)},
+    };
+    io_detail::WriteAll(fd, parts, 2);
+}
+
+// Записывает подряд все векторы из vectors, отдавая их системе пачками через writev
+template <typename Range>
+void WriteSimpleVectors(int fd, const Range& vectors)
+{
+    std::vector<SimpleVectorFileHeader> headers;
+    for(const auto& v : vectors)
+    {
+        headers.push_back(io_detail::MakeHeader(v));
+    }
+    std::vector<iovec> parts;
+    parts.reserve(headers.size() * 2);
+    size_t index = 0;
+    for(const auto& v : vectors)
+    {
+        using Type = std::remove_const_t<std::remove_pointer_t<decltype(v.Data())>>;
+        static_assert(std::is_trivially_copyable_v<Type>, "Only trivially copyable elements can be written as bytes");
+        parts.push_back({&headers[index++], sizeof(SimpleVectorFileHeader)});
+        parts.push_back({const_cast<Type*>(v.Data()), v.GetSize() * sizeof(Type)});
+    }
+    io_detail::WriteAll(fd, parts.data(), parts.size());
+}
+
+// Заменяет содержимое v следующим вектором из файлового дескриптора
+template <typename Type, typename Allocator, typename Growth>
+void ReadSimpleVector(int fd, SimpleVector<Type, Allocator, Growth>& v)
+{
+    SimpleVectorReader<Type> reader(fd);
+    v.Clear();
+    // Память под все элементы сразу выделяется, только если их наличие подтвердил
+    // размер файла; иначе вектор растёт по мере того, как элементы действительно приходят
+    if(reader.IsSizeChecked())
+    {
+        v.Reserve(reader.GetRemaining());
+    }
+    const size_t chunk = std::max<size_t>(io_detail::kReadChunkBytes / sizeof(Type), 1);
+    while(reader.AppendChunk(v, chunk))
+    {
+    }
+}
+
+// Записывает вектор в файл path, заменяя его содержимое
+template <typename Type, typename Allocator, typename Growth>
+void SaveSimpleVector(const std::string& path, const SimpleVector<Type, Allocator, Growth>& v)
+{
+    const int fd = io_detail::OpenFile(path, O_WRONLY | O_CREAT | O_TRUNC);
+    io_detail::FileCloser closer(fd);
+    WriteSimpleVector(fd, v);
+}
+
+// Заменяет содержимое v первым вектором из файла path
+template <typename Type, typename Allocator, typename Growth>
+void LoadSimpleVector(const std::string& path, SimpleVector<Type, Allocator, Growth>& v)
+{
+    const int fd = io_detail::OpenFile(path, O_RDONLY);
+    io_detail::FileCloser closer(fd);
+    ReadSimpleVector(fd, v);
+}
@@ -0,0 +1,227 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+#include <type_traits>
+
+// Статистика выделений и перемещений SimpleVector включается на этапе компиляции:
+// для всех типов - макросом SIMPLE_VECTOR_STATS=1, для отдельного типа - специализацией
+//     template <>
+//     struct EnableSimpleVectorStats<MyType> : std::true_type {};
+// Без неё SimpleVector не хранит и не считает ничего: счётчики - пустой объект,
+// вызовы которого компилятор выбрасывает
+#ifndef SIMPLE_VECTOR_STATS
+#define SIMPLE_VECTOR_STATS 0
+#endif
+
+template <typename T>
+struct EnableSimpleVectorStats : std::bool_constant<SIMPLE_VECTOR_STATS != 0> {};
+
+template <typename T>
+inline constexpr bool kEnableSimpleVectorStats = EnableSimpleVectorStats<T>::value;
+
+// Событие, о котором сообщает обратный вызов SimpleVectorStats
+enum class StatsEvent {
+    // Выделен буфер для пустого вектора; amount - байты
+    kAllocation,
+    // Буфер заменён большим; amount - байты нового буфера
+    kReallocation,
+    // Элементы перенесены в новый буфер; amount - их количество
+    kRelocation,
+    // Insert или Erase сдвинули хвост; amount - число сдвинутых элементов
+    kShift,
+};
+
+// Значения счётчиков на один момент
+struct SimpleVectorStatsSnapshot {
+    // Все выделения буфера, включая перевыделения
+    std::uint64_t allocations = 0;
+    // Выделения, заменившие уже существующий буфер
+    std::uint64_t reallocations = 0;
+    std::uint64_t bytes_allocated = 0;
+    // Наибольшая вместимость, которую выделял вектор
+    std::uint64_t peak_capacity = 0;
+    // Элементы, перенесённые в новый буфер при росте
+    std::uint64_t elements_relocated = 0;
+    // Из них перенесённые копированием, потому что перемещение могло бросить исключение
+    std::uint64_t elements_copied = 0;
+    // Сколько элементов в сумме сдвинули Insert и Erase
+    std::uint64_t shift_distance = 0;
+};
+
+// Счётчики одного или нескольких векторов. Обновляются атомарно и без упорядочивания,
+// так что один объект могут разделять векторы из разных потоков
+class SimpleVectorStats {
+public:
+    using Callback = void (*)(StatsEvent event, std::uint64_t amount, void* context);
+
+    // Общие счётчики всех векторов с элементами типа T, у которых не задан свой объект
+    template <typename T>
+    static SimpleVectorStats& ForType() noexcept;
+
+    // Обратный вызов получает каждое событие после обновления счётчиков, например,
+    // чтобы передать его в систему метрик. Задаётся до того, как векторы начнут
+    // писать в этот объект; nullptr отключает вызовы
+    void SetCallback(Callback callback, void* context = nullptr) noexcept
+    {
+        context_ = context;
+        callback_.store(callback, std::memory_order_release);
+    }
+
+    SimpleVectorStatsSnapshot GetSnapshot() const noexcept
+    {
+        SimpleVectorStatsSnapshot result;
+        result.allocations = allocations_.load(std::memory_order_relaxed);
+        result.reallocations = reallocations_.load(std::memory_order_relaxed);
+        result.bytes_allocated = bytes_allocated_.load(std::memory_order_relaxed);
+        result.peak_capacity = peak_capacity_.load(std::memory_order_relaxed);
+        result.elements_relocated = elements_relocated_.load(std::memory_order_relaxed);
+        result.elements_copied = elements_copied_.load(std::memory_order_relaxed);
+        result.shift_distance = shift_distance_.load(std::memory_order_relaxed);
+        return result;
+    }
+
+    void Reset() noexcept
+    {
+        for(auto* counter : {&allocations_, &reallocations_, &bytes_allocated_, &peak_capacity_,
+                             &elements_relocated_, &elements_copied_, &shift_distance_})
+        {
+            counter->store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void RecordAllocation(std::uint64_t capacity, std::uint64_t bytes, bool reallocation) noexcept
+    {
+        allocations_.fetch_add(1, std::memory_order_relaxed);
+        if(reallocation)
+        {
+            reallocations_.fetch_add(1, std::memory_order_relaxed);
+        }
+        bytes_allocated_.fetch_add(bytes, std::memory_order_relaxed);
+        std::uint64_t peak = peak_capacity_.load(std::memory_order_relaxed);
+        while(peak < capacity && !peak_capacity_.compare_exchange_weak(peak, capacity, std::memory_order_relaxed))
+        {
+        }
+        Notify(reallocation ? StatsEvent::kReallocation : StatsEvent::kAllocation, bytes);
+    }
+
+    void RecordRelocation(std::uint64_t count, bool copied) noexcept
+    {
+        elements_relocated_.fetch_add(count, std::memory_order_relaxed);
+        if(copied)
+        {
+            elements_copied_.fetch_add(count, std::memory_order_relaxed);
+        }
+        Notify(StatsEvent::kRelocation, count);
+    }
+
+    void RecordShift(std::uint64_t distance) noexcept
+    {
+        shift_distance_.fetch_add(distance, std::memory_order_relaxed);
+        Notify(StatsEvent::kShift, distance);
+    }
+
+private:
+    void Notify(StatsEvent event, std::uint64_t amount) const noexcept
+    {
+        if(Callback callback = callback_.load(std::memory_order_acquire))
+        {
+            callback(event, amount, context_);
+        }
+    }
+
+    std::atomic<std::uint64_t> allocations_ = 0;
+    std::atomic<std::uint64_t> reallocations_ = 0;
+    std::atomic<std::uint64_t> bytes_allocated_ = 0;
+    std::atomic<std::uint64_t> peak_capacity_ = 0;
+    std::atomic<std::uint64_t> elements_relocated_ = 0;
+    std::atomic<std::uint64_t> elements_copied_ = 0;
+    std::atomic<std::uint64_t> shift_distance_ = 0;
+    std::atomic<Callback> callback_ = nullptr;
+    void* context_ = nullptr;
+};
+
+namespace stats_detail {
+
+// Инициализируется статически, так что обращение не проверяет флаг инициализации
+template <typename T>
+inline SimpleVectorStats type_stats;
+
+} // namespace stats_detail
+
+template <typename T>
+SimpleVectorStats& SimpleVectorStats::ForType() noexcept
+{
+    return stats_detail::type_stats<T>;
+}
+
+// Печатает счётчики одной строкой вида "allocations=3 reallocations=2 ..."
+inline std::ostream& operator<<(std::ostream& out, const SimpleVectorStatsSnapshot& stats)
+{
+    return out << "allocations=" << stats.allocations
+               << " reallocations=" << stats.reallocations
+               << " bytes_allocated=" << stats.bytes_allocated
+               << " peak_capacity=" << stats.peak_capacity
+               << " elements_relocated=" << stats.elements_relocated
+               << " elements_copied=" << stats.elements_copied
+               << " shift_distance=" << stats.shift_distance;
+}
+
+// Печатает строку "label: <счётчики>" - например, после прогона бенчмарка
+inline void DumpStats(std::ostream& out, std::string_view label, const SimpleVectorStats& stats)
+{
+    out << label << ": " << stats.GetSnapshot() << '\n';
+}
+
+// Счётчики внутри SimpleVector<T>. Выключенный вариант пуст, его методы ничего не делают
+template <typename T, bool Enabled = kEnableSimpleVectorStats<T>>
+class SimpleVectorStatsRecorder {
+public:
+    constexpr void Allocated(size_t, bool) const noexcept {}
+    constexpr void Relocated(size_t, bool) const noexcept {}
+    constexpr void Shifted(size_t) const noexcept {}
+};
+
+template <typename T>
+class SimpleVectorStatsRecorder<T, true> {
+public:
+    void Allocated(size_t capacity, bool reallocation) const noexcept
+    {
+        if(capacity != 0)
+        {
+            stats_->RecordAllocation(capacity, capacity * sizeof(T), reallocation);
+        }
+    }
+
+    void Relocated(size_t count, bool copied) const noexcept
+    {
+        if(count != 0)
+        {
+            stats_->RecordRelocation(count, copied);
+        }
+    }
+
+    void Shifted(size_t distance) const noexcept
+    {
+        if(distance != 0)
+        {
+            stats_->RecordShift(distance);
+        }
+    }
+
+    void Attach(SimpleVectorStats& stats) noexcept
+    {
+        stats_ = &stats;
+    }
+
+    SimpleVectorStats& Get() const noexcept
+    {
+        return *stats_;
+    }
+
+private:
+    SimpleVectorStats* stats_ = &SimpleVectorStats::ForType<T>();
+};
@@ -0,0 +1,239 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#if __has_include(<span>)
+#include <span>
+#endif
+#include "constexpr_support.h"
+#include "simd_kernels.h"
+
+namespace view_detail {
+
+template <typename Container, typename = void>
+struct BeginPointer {};
+
+template <typename Container>
+struct BeginPointer<Container, std::void_t<decltype(std::declval<Container&>().begin())>> {
+    using Type = decltype(std::declval<Container&>().begin());
+
+    static constexpr Type Get(Container& container) noexcept
+    {
+        return container.begin();
+    }
+};
+
+// Начало элементов контейнера: Data(), если он есть, иначе begin(). У SimpleVector в режиме
+// проверок (см. hardening.h) begin() - проверяемый итератор, а Data() - всегда указатель
+template <typename Container, typename = void>
+struct DataPointer : BeginPointer<Container> {};
+
+template <typename Container>
+struct DataPointer<Container, std::void_t<decltype(std::declval<Container&>().Data())>> {
+    using Type = decltype(std::declval<Container&>().Data());
+
+    static constexpr Type Get(Container& container) noexcept
+    {
+        return container.Data();
+    }
+};
+
+// Container хранит элементы подряд: его начало - указатель, приводимый к T*, а размер даёт GetSize()
+template <typename Container, typename T, typename = void>
+inline constexpr bool kIsContiguousOf = false;
+
+template <typename Container, typename T>
+inline constexpr bool kIsContiguousOf<Container, T, std::void_t<decltype(std::declval<Container&>().GetSize()),
+                                                               typename DataPointer<Container>::Type>>
+    = std::is_pointer_v<typename DataPointer<Container>::Type>
+      && std::is_convertible_v<typename DataPointer<Container>::Type, T*>;
+
+} // namespace view_detail
+
+// Невладеющий вид на непрерывный участок элементов - SimpleVector, StaticSimpleVector,
+// части буфера или std::span. Это пара указатель и размер: копируется бесплатно, а Slice
+// выделяет подучасток без копирования элементов. Вид на const T только читает.
+//
+// Вид не продлевает жизнь данных: после роста или разрушения вектора он недействителен
+template <typename T>
+class SimpleVectorView {
+public:
+    using Iterator = T*;
+    using ConstIterator = const T*;
+    using ValueType = std::remove_const_t<T>;
+
+    constexpr SimpleVectorView() noexcept = default;
+
+    constexpr SimpleVectorView(T* data, size_t size) noexcept
+    : data_(data)
+    , size_(size)
+    {}
+
+    // Вид на все элементы контейнера
+    template <typename Container, typename = std::enable_if_t<view_detail::kIsContiguousOf<Container, T>
+                                                              && !std::is_same_v<std::decay_t<Container>, SimpleVectorView>>>
+    constexpr SimpleVectorView(Container& container) noexcept
+    : data_(view_detail::DataPointer<Container>::Get(container))
+    , size_(container.GetSize())
+    {}
+
+    // Вид на изменяемые элементы приводится к виду только для чтения
+    template <typename U, typename = std::enable_if_t<std::is_convertible_v<U*, T*> && !std::is_same_v<U, T>>>
+    constexpr SimpleVectorView(SimpleVectorView<U> other) noexcept
+    : data_(other.begin())
+    , size_(other.GetSize())
+    {}
+
+#if defined(__cpp_lib_span)
+    constexpr SimpleVectorView(std::span<T> span) noexcept
+    : data_(span.data())
+    , size_(span.size())
+    {}
+
+    constexpr operator std::span<T>() const noexcept
+    {
+        return {data_, size_};
+    }
+#endif
+
+    constexpr size_t GetSize() const noexcept
+    {
+        return size_;
+    }
+
+    constexpr bool IsEmpty() const noexcept
+    {
+        return size_ == 0;
+    }
+
+    constexpr T* Data() const noexcept
+    {
+        return data_;
+    }
+
+    constexpr T& operator[](size_t index) const noexcept
+    {
+        assert(index < size_);
+        return data_[index];
+    }
+
+    // Выбрасывает исключение std::out_of_range, если index >= size
+    constexpr T& At(size_t index) const
+    {
+        if(index >= size_)
+        {
+            throw std::out_of_range("Index is out of range");
+        }
+        return data_[index];
+    }
+
+    constexpr Iterator begin() const noexcept
+    {
+        return data_;
+    }
+
+    constexpr Iterator end() const noexcept
+    {
+        return data_ + size_;
+    }
+
+    constexpr ConstIterator cbegin() const noexcept
+    {
+        return data_;
+    }
+
+    constexpr ConstIterator cend() const noexcept
+    {
+        return data_ + size_;
+    }
+
+    // Вид на count элементов, начиная с first. Выбрасывает std::out_of_range,
+    // если участок выходит за конец
+    constexpr SimpleVectorView Slice(size_t first, size_t count) const
+    {
+        if(first > size_ || count > size_ - first)
+        {
+            throw std::out_of_range("Index is out of range");
+        }
+        return SimpleVectorView(data_ + first, count);
+    }
+
+    // Вид на элементы от first до конца
+    constexpr SimpleVectorView Slice(size_t first) const
+    {
+        if(first > size_)
+        {
+            throw std::out_of_range("Index is out of range");
+        }
+        return SimpleVectorView(data_ + first, size_ - first);
+    }
+
+    // Поиск и подсчёт идут теми же векторными ядрами, что и у SimpleVector
+    SIMPLE_VECTOR_CONSTEXPR Iterator Find(const ValueType& value) const noexcept
+    {
+        return data_ + (RangeFind<ValueType>(data_, size_, value) - data_);
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR size_t Count(const ValueType& value) const noexcept
+    {
+        return RangeCount<ValueType>(data_, size_, value);
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR Iterator MinElement() const noexcept
+    {
+        return data_ + (RangeMinElement<ValueType>(data_, size_) - data_);
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR Iterator MaxElement() const noexcept
+    {
+        return data_ + (RangeMaxElement<ValueType>(data_, size_) - data_);
+    }
+
+    // Сравнения принимают виды по значению, поэтому вид сравнивается и с SimpleVector
+    friend SIMPLE_VECTOR_CONSTEXPR bool operator==(SimpleVectorView lhs, SimpleVectorView rhs)
+    {
+        return lhs.size_ == rhs.size_ && RangeEqual<ValueType>(lhs.data_, rhs.data_, lhs.size_);
+    }
+
+    friend SIMPLE_VECTOR_CONSTEXPR bool operator!=(SimpleVectorView lhs, SimpleVectorView rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+    friend SIMPLE_VECTOR_CONSTEXPR bool operator<(SimpleVectorView lhs, SimpleVectorView rhs)
+    {
+        return RangeCompare<ValueType>(lhs.data_, lhs.size_, rhs.data_, rhs.size_) < 0;
+    }
+
+    friend SIMPLE_VECTOR_CONSTEXPR bool operator>(SimpleVectorView lhs, SimpleVectorView rhs)
+    {
+        return RangeCompare<ValueType>(lhs.data_, lhs.size_, rhs.data_, rhs.size_) > 0;
+    }
+
+    friend SIMPLE_VECTOR_CONSTEXPR bool operator<=(SimpleVectorView lhs, SimpleVectorView rhs)
+    {
+        return RangeCompare<ValueType>(lhs.data_, lhs.size_, rhs.data_, rhs.size_) <= 0;
+    }
+
+    friend SIMPLE_VECTOR_CONSTEXPR bool operator>=(SimpleVectorView lhs, SimpleVectorView rhs)
+    {
+        return RangeCompare<ValueType>(lhs.data_, lhs.size_, rhs.data_, rhs.size_) >= 0;
+    }
+
+#if defined(__cpp_impl_three_way_comparison) && defined(__cpp_lib_three_way_comparison)
+    friend SIMPLE_VECTOR_CONSTEXPR SynthThreeWayResult<ValueType> operator<=>(SimpleVectorView lhs, SimpleVectorView rhs)
+    {
+        return RangeCompareThreeWay<ValueType>(lhs.data_, lhs.size_, rhs.data_, rhs.size_);
+    }
+#endif
+
+private:
+    T* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+template <typename Container>
+SimpleVectorView(Container&) -> SimpleVectorView<std::remove_pointer_t<typename view_detail::DataPointer<Container>::Type>>;
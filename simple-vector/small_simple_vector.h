@@ -0,0 +1,510 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <initializer_list>
+#include <utility>
+#include <stdexcept>
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include "array_ptr.h"
+#include "relocation.h"
+#include "simd_kernels.h"
+#include "simple_vector.h"
+
+// Вектор, который хранит до N элементов прямо внутри объекта и обращается к куче,
+// только когда элементов становится больше N. Интерфейс совпадает с SimpleVector.
+// Пока вектор встроенный, его перемещение и обмен переносят не более N элементов;
+// после переезда в кучу они сводятся к обмену указателями, как у SimpleVector
+template <typename Type, size_t N, typename Allocator = std::allocator<Type>>
+class SmallSimpleVector {
+    static_assert(N > 0, "Inline capacity must be positive");
+    using AllocTraits = std::allocator_traits<Allocator>;
+
+public:
+    using Iterator = Type*;
+    using ConstIterator = const Type*;
+    using AllocatorType = Allocator;
+
+    // Сколько элементов помещается в объект без выделения памяти
+    static constexpr size_t kInlineCapacity = N;
+    // Во сколько раз увеличивается вместимость, когда для нового элемента нет места
+    static constexpr size_t kGrowthFactor = 2;
+
+    SmallSimpleVector() noexcept = default;
+
+    explicit SmallSimpleVector(const Allocator& alloc) noexcept
+    : heap_(alloc)
+    {}
+
+    // Создаёт вектор из size элементов, инициализированных значением по умолчанию
+    explicit SmallSimpleVector(size_t size, const Allocator& alloc = Allocator())
+    : heap_(alloc)
+    {
+        Reserve(size);
+        UninitializedValueConstructN(GetAlloc(), data_, size);
+        size_ = size;
+    }
+
+    // Создаёт вектор из size элементов, инициализированных значением value
+    SmallSimpleVector(size_t size, const Type& value, const Allocator& alloc = Allocator())
+    : heap_(alloc)
+    {
+        Reserve(size);
+        UninitializedFillN(GetAlloc(), data_, size, value);
+        size_ = size;
+    }
+
+    // Создаёт вектор из std::initializer_list
+    SmallSimpleVector(std::initializer_list<Type> init, const Allocator& alloc = Allocator())
+    : heap_(alloc)
+    {
+        Reserve(init.size());
+        UninitializedCopy(GetAlloc(), init.begin(), init.end(), data_);
+        size_ = init.size();
+    }
+
+    //конструктор копирования
+    explicit SmallSimpleVector(const SmallSimpleVector& other)
+    : SmallSimpleVector(other, AllocTraits::select_on_container_copy_construction(other.heap_.GetAllocator()))
+    {}
+
+    // Копирует other, выделяя память через alloc
+    SmallSimpleVector(const SmallSimpleVector& other, const Allocator& alloc)
+    : heap_(alloc)
+    {
+        Reserve(other.size_);
+        UninitializedCopy(GetAlloc(), other.begin(), other.end(), data_);
+        size_ = other.size_;
+    }
+
+    //Конструктор перемещения
+    SmallSimpleVector(SmallSimpleVector&& other) noexcept(std::is_nothrow_move_constructible_v<Type>)
+    : heap_(other.heap_.GetAllocator())
+    {
+        MoveFrom(other);
+    }
+
+    //Резервирующий конструктор
+    SmallSimpleVector(const SaveReserve& res, const Allocator& alloc = Allocator())
+    : heap_(alloc)
+    {
+        Reserve(res.GetCapacity());
+    }
+
+    ~SmallSimpleVector()
+    {
+        DestroyRange(GetAlloc(), begin(), end());
+    }
+
+    SmallSimpleVector& operator=(const SmallSimpleVector& rhs)
+    {
+        if(this != &rhs)
+        {
+            SmallSimpleVector rhs_copy(rhs, AllocTraits::propagate_on_container_copy_assignment::value
+                                                ? rhs.heap_.GetAllocator()
+                                                : heap_.GetAllocator());
+            *this = std::move(rhs_copy);
+        }
+        return *this;
+    }
+
+    // Если аллокаторы не переезжают и не равны, MoveFrom выделяет память, поэтому
+    // присваивание не бросает, только когда аллокатор переезжает или всегда равен
+    SmallSimpleVector& operator=(SmallSimpleVector&& other) noexcept(std::is_nothrow_move_constructible_v<Type>
+                                                                    && (AllocTraits::propagate_on_container_move_assignment::value
+                                                                        || AllocTraits::is_always_equal::value))
+    {
+        if(this != &other)
+        {
+            Clear();
+            MoveFrom(other);
+        }
+        return *this;
+    }
+
+    // Обменивает содержимое. Если оба вектора в куче, обмениваются только указатели.
+    // Иначе элементы переносятся присваиванием, которое при разных аллокаторах выделяет
+    // память, поэтому обмен не бросает, только когда аллокатор переезжает или всегда равен
+    void swap(SmallSimpleVector& other) noexcept(std::is_nothrow_move_constructible_v<Type>
+                                                 && (AllocTraits::propagate_on_container_swap::value
+                                                     || AllocTraits::is_always_equal::value))
+    {
+        if(!IsInline() && !other.IsInline())
+        {
+            heap_.swap(other.heap_);
+            std::swap(data_, other.data_);
+            std::swap(size_, other.size_);
+            std::swap(capacity_, other.capacity_);
+            return;
+        }
+        SmallSimpleVector temp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(temp);
+    }
+
+    Allocator GetAllocator() const noexcept
+    {
+        return heap_.GetAllocator();
+    }
+
+    // Возвращает количество элементов в массиве
+    size_t GetSize() const noexcept {
+        return size_;
+    }
+
+    // Возвращает вместимость массива. Она не бывает меньше N
+    size_t GetCapacity() const noexcept {
+        return capacity_;
+    }
+
+    // Сообщает, пустой ли массив
+    bool IsEmpty() const noexcept {
+        return size_ == 0;
+    }
+
+    // Сообщает, хранятся ли элементы внутри объекта, а не в куче
+    bool IsInline() const noexcept {
+        return !heap_;
+    }
+
+    // Возвращает ссылку на элемент с индексом index
+    Type& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return data_[index];
+    }
+
+    // Возвращает константную ссылку на элемент с индексом index
+    const Type& operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return data_[index];
+    }
+
+    // Возвращает ссылку на элемент с индексом index
+    // Выбрасывает исключение std::out_of_range, если index >= size
+    Type& At(size_t index) {
+        if(index >= size_)
+        {
+            throw std::out_of_range("Index is out of range");
+        }
+        return data_[index];
+    }
+
+    // Возвращает константную ссылку на элемент с индексом index
+    // Выбрасывает исключение std::out_of_range, если index >= size
+    const Type& At(size_t index) const {
+        if(index >= size_)
+        {
+            throw std::out_of_range("Index is out of range");
+        }
+        return data_[index];
+    }
+
+    // Обнуляет размер массива, не изменяя его вместимость
+    void Clear() noexcept {
+        DestroyRange(GetAlloc(), begin(), end());
+        size_ = 0;
+    }
+
+    // Резервирует память размером new_capacity ячеек
+    // Если текущая емкость вектора больше новой, то емкость не меняется
+    void Reserve(size_t new_capacity)
+    {
+        if(new_capacity > capacity_)
+        {
+            ArrayPtr<Type, Allocator> temp(new_capacity, GetAlloc());
+            UninitializedRelocate(GetAlloc(), begin(), end(), temp.GetRawPtr());
+            AdoptHeap(temp);
+        }
+    }
+
+    // Изменяет размер массива.
+    // При увеличении размера новые элементы получают значение по умолчанию для типа Type
+    void Resize(size_t new_size) {
+        if(new_size > capacity_)
+        {
+            Reserve(NextCapacity(new_size));
+        }
+        if(new_size > size_)
+        {
+            UninitializedValueConstructN(GetAlloc(), begin() + size_, new_size - size_);
+        }
+        else
+        {
+            DestroyRange(GetAlloc(), begin() + new_size, end());
+        }
+        size_ = new_size;
+    }
+
+    Iterator begin() noexcept {
+        return data_;
+    }
+
+    Iterator end() noexcept {
+        return data_ + size_;
+    }
+
+    ConstIterator begin() const noexcept {
+        return data_;
+    }
+
+    ConstIterator end() const noexcept {
+        return data_ + size_;
+    }
+
+    ConstIterator cbegin() const noexcept {
+        return data_;
+    }
+
+    ConstIterator cend() const noexcept {
+        return data_ + size_;
+    }
+
+    // Создаёт элемент в конце вектора из аргументов args
+    // Возвращает ссылку на созданный элемент
+    template <typename... Args>
+    Type& EmplaceBack(Args&&... args)
+    {
+        if(size_ == capacity_)
+        {
+            return *ReallocateAndEmplace(size_, std::forward<Args>(args)...);
+        }
+        Type* slot = data_ + size_;
+        ConstructAt(GetAlloc(), slot, std::forward<Args>(args)...);
+        ++size_;
+        return *slot;
+    }
+
+    void PushBack(const Type& element)
+    {
+        EmplaceBack(element);
+    }
+
+    void PushBack(Type&& element)
+    {
+        EmplaceBack(std::move(element));
+    }
+
+    void PopBack() noexcept
+    {
+        assert(size_ != 0);
+        --size_;
+        DestroyAt(GetAlloc(), data_ + size_);
+    }
+
+    Iterator Erase(ConstIterator pos)
+    {
+        int64_t index = std::distance(cbegin(), pos);
+        assert(index < static_cast<int64_t>(size_) && index >= 0);
+        Iterator it = begin() + index;
+        if constexpr (kIsTriviallyRelocatable<Type>)
+        {
+            DestroyAt(GetAlloc(), it);
+            RelocateOverlapping(it + 1, static_cast<size_t>(end() - it - 1), it);
+        }
+        else
+        {
+            std::move(it + 1, end(), it);
+            DestroyAt(GetAlloc(), end() - 1);
+        }
+        --size_;
+        return it;
+    }
+
+    // Создаёт элемент из аргументов args перед позицией pos
+    // Аргументы могут ссылаться на элементы самого вектора
+    template <typename... Args>
+    Iterator Emplace(ConstIterator pos, Args&&... args)
+    {
+        int64_t index = std::distance(cbegin(), pos);
+        assert(index <= static_cast<int64_t>(size_) && index >= 0);
+        if(size_ == capacity_)
+        {
+            return ReallocateAndEmplace(static_cast<size_t>(index), std::forward<Args>(args)...);
+        }
+        Iterator iter = begin() + index;
+        if(iter == end())
+        {
+            ConstructAt(GetAlloc(), iter, std::forward<Args>(args)...);
+        }
+        else
+        {
+            Type value(std::forward<Args>(args)...);
+            if constexpr (kIsTriviallyRelocatable<Type>)
+            {
+                const size_t tail = static_cast<size_t>(end() - iter);
+                RelocateOverlapping(iter, tail, iter + 1);
+                try
+                {
+                    ConstructAt(GetAlloc(), iter, std::move(value));
+                }
+                catch(...)
+                {
+                    RelocateOverlapping(iter + 1, tail, iter);
+                    throw;
+                }
+            }
+            else
+            {
+                ConstructAt(GetAlloc(), end(), std::move(*(end() - 1)));
+                std::move_backward(iter, end() - 1, end());
+                *iter = std::move(value);
+            }
+        }
+        ++size_;
+        return iter;
+    }
+
+    Iterator Insert(ConstIterator pos, const Type& value)
+    {
+        return Emplace(pos, value);
+    }
+
+    Iterator Insert(ConstIterator pos, Type&& value)
+    {
+        return Emplace(pos, std::move(value));
+    }
+
+private:
+    Type* InlineData() noexcept
+    {
+        return reinterpret_cast<Type*>(inline_);
+    }
+
+    Allocator& GetAlloc() noexcept
+    {
+        return heap_.GetAllocator();
+    }
+
+    size_t NextCapacity(size_t required) const noexcept
+    {
+        return std::max(required, capacity_ * kGrowthFactor);
+    }
+
+    // Делает буфер temp, в который уже перенесены элементы, хранилищем вектора.
+    // Прежний буфер в куче, если он был, освобождается вместе с temp
+    void AdoptHeap(ArrayPtr<Type, Allocator>& temp) noexcept
+    {
+        heap_.swap(temp);
+        data_ = heap_.GetRawPtr();
+        capacity_ = heap_.GetSize();
+    }
+
+    // Забирает элементы other в пустой вектор. Буфер в куче забирается целиком,
+    // если его сможет освободить наш аллокатор, иначе элементы переносятся по одному
+    void MoveFrom(SmallSimpleVector& other)
+    {
+        assert(size_ == 0);
+        const bool can_adopt = AllocTraits::propagate_on_container_move_assignment::value
+            || AllocTraits::is_always_equal::value
+            || GetAlloc() == other.GetAlloc();
+        if(!other.IsInline() && can_adopt)
+        {
+            heap_ = std::move(other.heap_);
+            data_ = heap_.GetRawPtr();
+            capacity_ = heap_.GetSize();
+            // При обмене буферами other может получить наш прежний буфер
+            other.data_ = other.heap_ ? other.heap_.GetRawPtr() : other.InlineData();
+            other.capacity_ = other.heap_ ? other.heap_.GetSize() : N;
+        }
+        else
+        {
+            Reserve(other.size_);
+            UninitializedRelocate(GetAlloc(), other.begin(), other.end(), data_);
+        }
+        size_ = std::exchange(other.size_, 0);
+    }
+
+    // Медленный путь вставки: выделяет буфер в куче, создаёт в нём элемент с индексом index
+    // и переносит вокруг него старые элементы
+    template <typename... Args>
+    Iterator ReallocateAndEmplace(size_t index, Args&&... args)
+    {
+        Allocator& alloc = GetAlloc();
+        ArrayPtr<Type, Allocator> temp(NextCapacity(size_ + 1), alloc);
+        Type* new_data = temp.GetRawPtr();
+        ConstructAt(alloc, new_data + index, std::forward<Args>(args)...);
+        if constexpr (kIsTriviallyRelocatable<Type>)
+        {
+            UninitializedRelocate(alloc, begin(), begin() + index, new_data);
+            UninitializedRelocate(alloc, begin() + index, end(), new_data + index + 1);
+        }
+        else
+        {
+            try
+            {
+                UninitializedMoveIfNoexcept(alloc, begin(), begin() + index, new_data);
+                try
+                {
+                    UninitializedMoveIfNoexcept(alloc, begin() + index, end(), new_data + index + 1);
+                }
+                catch(...)
+                {
+                    DestroyRange(alloc, new_data, new_data + index);
+                    throw;
+                }
+            }
+            catch(...)
+            {
+                DestroyAt(alloc, new_data + index);
+                throw;
+            }
+            DestroyRange(alloc, begin(), end());
+        }
+        AdoptHeap(temp);
+        ++size_;
+        return begin() + index;
+    }
+
+    // Пока heap_ пуст, data_ указывает на inline_
+    Type* data_ = InlineData();
+    size_t size_ = 0;
+    size_t capacity_ = N;
+    ArrayPtr<Type, Allocator> heap_;
+    alignas(Type) unsigned char inline_[N * sizeof(Type)];
+};
+
+
+template <typename Type, size_t N, typename Allocator>
+bool operator==(const SmallSimpleVector<Type, N, Allocator>& lhs, const SmallSimpleVector<Type, N, Allocator>& rhs) {
+    if(lhs.GetSize() == rhs.GetSize())
+    {
+        return RangeEqual(lhs.cbegin(), rhs.cbegin(), lhs.GetSize());
+    }
+    return false;
+}
+
+template <typename Type, size_t N, typename Allocator>
+bool operator!=(const SmallSimpleVector<Type, N, Allocator>& lhs, const SmallSimpleVector<Type, N, Allocator>& rhs) {
+    return !(lhs == rhs);
+}
+
+template <typename Type, size_t N, typename Allocator>
+bool operator<(const SmallSimpleVector<Type, N, Allocator>& lhs, const SmallSimpleVector<Type, N, Allocator>& rhs) {
+    return RangeCompare(lhs.cbegin(), lhs.GetSize(), rhs.cbegin(), rhs.GetSize()) < 0;
+}
+
+template <typename Type, size_t N, typename Allocator>
+bool operator>(const SmallSimpleVector<Type, N, Allocator>& lhs, const SmallSimpleVector<Type, N, Allocator>& rhs) {
+    return rhs < lhs;
+}
+
+template <typename Type, size_t N, typename Allocator>
+bool operator<=(const SmallSimpleVector<Type, N, Allocator>& lhs, const SmallSimpleVector<Type, N, Allocator>& rhs) {
+    return !(rhs < lhs);
+}
+
+template <typename Type, size_t N, typename Allocator>
+bool operator>=(const SmallSimpleVector<Type, N, Allocator>& lhs, const SmallSimpleVector<Type, N, Allocator>& rhs) {
+    return !(lhs < rhs);
+}
+
+#if defined(__cpp_impl_three_way_comparison) && defined(__cpp_lib_three_way_comparison)
+template <typename Type, size_t N, typename Allocator>
+SynthThreeWayResult<Type> operator<=>(const SmallSimpleVector<Type, N, Allocator>& lhs,
+                                      const SmallSimpleVector<Type, N, Allocator>& rhs) {
+    return RangeCompareThreeWay(lhs.cbegin(), lhs.GetSize(), rhs.cbegin(), rhs.GetSize());
+}
+#endif
@@ -0,0 +1,319 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#if __has_include(<span>)
+#include <span>
+#endif
+#include "aligned_allocator.h"
+#include "growth_policy.h"
+#include "simple_vector.h"
+
+// Вектор записей, разложенный по столбцам (structure of arrays): каждое поле хранится
+// в своём SimpleVector с буфером, выровненным по кеш-линии. Цикл по одному полю читает
+// только его столбец - непрерывный массив, как у отдельного SimpleVector<Field>,
+// который компилятор векторизует, а кеш и память не тратятся на соседние поля.
+//
+// Все столбцы всегда одного размера и растут вместе до одной вместимости.
+// Строка - прокси-ссылка std::tuple<Fields&...>: её можно разобрать structured binding
+// или присвоить кортеж. PushBack, Insert и Resize при исключении откатывают уже
+// изменённые столбцы, так что вектор остаётся прежним
+template <typename... Fields>
+class SoASimpleVector {
+    static_assert(sizeof...(Fields) != 0, "SoASimpleVector needs at least one field");
+
+    template <typename Field>
+    using ColumnAllocator = AlignedAllocator<Field, std::max<size_t>(64, alignof(Field))>;
+
+    using Indices = std::index_sequence_for<Fields...>;
+
+public:
+    template <size_t I>
+    using FieldType = std::tuple_element_t<I, std::tuple<Fields...>>;
+
+    template <size_t I>
+    using ColumnType = SimpleVector<FieldType<I>, ColumnAllocator<FieldType<I>>>;
+
+    using Value = std::tuple<Fields...>;
+    using Reference = std::tuple<Fields&...>;
+    using ConstReference = std::tuple<const Fields&...>;
+
+    // Сумма размеров полей - сколько байтов занимает одна строка во всех столбцах
+    static constexpr size_t kRowSize = (sizeof(Fields) + ...);
+
+    SoASimpleVector() noexcept = default;
+
+    // Создаёт size строк, поля которых инициализированы значением по умолчанию
+    explicit SoASimpleVector(size_t size)
+    {
+        Resize(size);
+    }
+
+    SoASimpleVector(std::initializer_list<Value> init)
+    {
+        Reserve(init.size());
+        for(const Value& row : init)
+        {
+            PushBack(row);
+        }
+    }
+
+    size_t GetSize() const noexcept
+    {
+        return std::get<0>(columns_).GetSize();
+    }
+
+    size_t GetCapacity() const noexcept
+    {
+        return std::get<0>(columns_).GetCapacity();
+    }
+
+    bool IsEmpty() const noexcept
+    {
+        return GetSize() == 0;
+    }
+
+    // Прокси-ссылка на строку index
+    Reference operator[](size_t index) noexcept
+    {
+        assert(index < GetSize());
+        return RowAt(index, Indices{});
+    }
+
+    ConstReference operator[](size_t index) const noexcept
+    {
+        assert(index < GetSize());
+        return RowAt(index, Indices{});
+    }
+
+    // Выбрасывает исключение std::out_of_range, если index >= size
+    Reference At(size_t index)
+    {
+        if(index >= GetSize())
+        {
+            throw std::out_of_range("Index is out of range");
+        }
+        return (*this)[index];
+    }
+
+    ConstReference At(size_t index) const
+    {
+        if(index >= GetSize())
+        {
+            throw std::out_of_range("Index is out of range");
+        }
+        return (*this)[index];
+    }
+
+    // Столбец поля I целиком - только для чтения, чтобы размеры столбцов не разошлись
+    template <size_t I>
+    const ColumnType<I>& Column() const noexcept
+    {
+        return std::get<I>(columns_);
+    }
+
+    // Начало столбца поля I; в нём GetSize() элементов
+    template <size_t I>
+    FieldType<I>* ColumnData() noexcept
+    {
+        return std::get<I>(columns_).Data();
+    }
+
+    template <size_t I>
+    const FieldType<I>* ColumnData() const noexcept
+    {
+        return std::get<I>(columns_).Data();
+    }
+
+#if defined(__cpp_lib_span)
+    template <size_t I>
+    std::span<FieldType<I>> ColumnSpan() noexcept
+    {
+        return {ColumnData<I>(), GetSize()};
+    }
+
+    template <size_t I>
+    std::span<const FieldType<I>> ColumnSpan() const noexcept
+    {
+        return {ColumnData<I>(), GetSize()};
+    }
+#endif
+
+    // Добавляет строку из значений полей, по одному аргументу на поле.
+    // Аргументы могут ссылаться на элементы самого вектора
+    template <typename... Args>
+    Reference EmplaceBack(Args&&... args)
+    {
+        static_assert(sizeof...(Args) == sizeof...(Fields), "EmplaceBack takes one argument per field");
+        if(GetSize() == GetCapacity())
+        {
+            // Рост переносит столбцы, так что строка сначала собирается отдельно
+            Value row(std::forward<Args>(args)...);
+            Reserve(NextCapacity(GetSize() + 1));
+            AppendRow(std::move(row), Indices{});
+        }
+        else
+        {
+            AppendRow(std::forward_as_tuple(std::forward<Args>(args)...), Indices{});
+        }
+        return (*this)[GetSize() - 1];
+    }
+
+    void PushBack(const Value& row)
+    {
+        std::apply([this](const Fields&... fields) { EmplaceBack(fields...); }, row);
+    }
+
+    void PushBack(Value&& row)
+    {
+        std::apply([this](Fields&... fields) { EmplaceBack(std::move(fields)...); }, row);
+    }
+
+    void PopBack() noexcept
+    {
+        assert(!IsEmpty());
+        std::apply([](auto&... columns) { (columns.PopBack(), ...); }, columns_);
+    }
+
+    // Вставляет строку перед строкой index, сдвигая хвост каждого столбца
+    void Insert(size_t index, Value row)
+    {
+        assert(index <= GetSize());
+        if(GetSize() == GetCapacity())
+        {
+            Reserve(NextCapacity(GetSize() + 1));
+        }
+        InsertRow(index, std::move(row), Indices{});
+    }
+
+    // Удаляет строку index
+    void Erase(size_t index)
+    {
+        assert(index < GetSize());
+        std::apply([index](auto&... columns) { (columns.Erase(columns.begin() + index), ...); }, columns_);
+    }
+
+    // Удаляет строки [first, last)
+    void Erase(size_t first, size_t last)
+    {
+        assert(first <= last && last <= GetSize());
+        std::apply([first, last](auto&... columns) {
+            (columns.Erase(columns.begin() + first, columns.begin() + last), ...);
+        }, columns_);
+    }
+
+    void Reserve(size_t capacity)
+    {
+        // Reserve не меняет элементы, так что частично выполненный рост безопасен
+        std::apply([capacity](auto&... columns) { (columns.Reserve(capacity), ...); }, columns_);
+    }
+
+    // Изменяет число строк. Новые поля получают значения по умолчанию
+    void Resize(size_t new_size)
+    {
+        if(new_size > GetCapacity())
+        {
+            Reserve(NextCapacity(new_size));
+        }
+        ResizeColumns(new_size, Indices{});
+    }
+
+    void Clear() noexcept
+    {
+        std::apply([](auto&... columns) { (columns.Clear(), ...); }, columns_);
+    }
+
+    void ShrinkToFit()
+    {
+        std::apply([](auto&... columns) { (columns.ShrinkToFit(), ...); }, columns_);
+    }
+
+    void swap(SoASimpleVector& other) noexcept
+    {
+        columns_.swap(other.columns_);
+    }
+
+    friend bool operator==(const SoASimpleVector& lhs, const SoASimpleVector& rhs)
+    {
+        return lhs.columns_ == rhs.columns_;
+    }
+
+    friend bool operator!=(const SoASimpleVector& lhs, const SoASimpleVector& rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+private:
+    size_t NextCapacity(size_t required) const noexcept
+    {
+        return DoublingGrowth::NextCapacity(GetCapacity(), required, kRowSize);
+    }
+
+    template <size_t... I>
+    Reference RowAt(size_t index, std::index_sequence<I...>) noexcept
+    {
+        return Reference(std::get<I>(columns_)[index]...);
+    }
+
+    template <size_t... I>
+    ConstReference RowAt(size_t index, std::index_sequence<I...>) const noexcept
+    {
+        return ConstReference(std::get<I>(columns_)[index]...);
+    }
+
+    // Дописывает поля row в столбцы, вместимости которых хватает. Если поле бросит
+    // исключение, уже дописанные поля удаляются
+    template <typename Row, size_t... I>
+    void AppendRow(Row&& row, std::index_sequence<I...>)
+    {
+        size_t done = 0;
+        try
+        {
+            ((std::get<I>(columns_).EmplaceBack(std::get<I>(std::forward<Row>(row))), ++done), ...);
+        }
+        catch(...)
+        {
+            ((I < done ? std::get<I>(columns_).PopBack() : void()), ...);
+            throw;
+        }
+    }
+
+    template <size_t... I>
+    void InsertRow(size_t index, Value&& row, std::index_sequence<I...>)
+    {
+        size_t done = 0;
+        try
+        {
+            ((std::get<I>(columns_).Insert(std::get<I>(columns_).begin() + index, std::get<I>(std::move(row))), ++done), ...);
+        }
+        catch(...)
+        {
+            ((I < done ? void(std::get<I>(columns_).Erase(std::get<I>(columns_).begin() + index)) : void()), ...);
+            throw;
+        }
+    }
+
+    template <size_t... I>
+    void ResizeColumns(size_t new_size, std::index_sequence<I...>)
+    {
+        const size_t old_size = GetSize();
+        size_t done = 0;
+        try
+        {
+            ((std::get<I>(columns_).Resize(new_size), ++done), ...);
+        }
+        catch(...)
+        {
+            ((I < done ? std::get<I>(columns_).Resize(old_size) : void()), ...);
+            throw;
+        }
+    }
+
+    std::tuple<SimpleVector<Fields, ColumnAllocator<Fields>>...> columns_;
+};
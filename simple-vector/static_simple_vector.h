@@ -0,0 +1,460 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "constexpr_support.h"
+#include "simd_kernels.h"
+#include "simple_vector.h"
+
+namespace static_vector_detail {
+
+// Ячейки тривиального типа - обычный массив, целиком инициализированный нулями.
+// Такое хранилище - литеральный тип, поэтому вектор может быть constexpr-переменной
+// и попасть в секцию данных только для чтения. Ячейки за концом вектора остаются живыми
+// объектами: создание элемента - присваивание, разрушение ничего не делает
+template <typename Type, size_t N, bool Trivial = std::is_trivial_v<Type>>
+struct Storage {
+    constexpr Type* Data() noexcept
+    {
+        return cells;
+    }
+
+    constexpr const Type* Data() const noexcept
+    {
+        return cells;
+    }
+
+    template <typename... Args>
+    constexpr void Construct(size_t index, Args&&... args)
+    {
+        cells[index] = Type(std::forward<Args>(args)...);
+    }
+
+    constexpr void Destroy(size_t) noexcept
+    {}
+
+    size_t size = 0;
+    Type cells[N == 0 ? 1 : N] = {};
+};
+
+// Для остальных типов - сырая память, в которой живут только элементы [0, size)
+template <typename Type, size_t N>
+struct Storage<Type, N, false> {
+    Storage() noexcept = default;
+
+    Storage(const Storage& other)
+    {
+        UninitializedCopy(alloc, other.Data(), other.Data() + other.size, Data());
+        size = other.size;
+    }
+
+    Storage(Storage&& other) noexcept(std::is_nothrow_move_constructible_v<Type>)
+    {
+        UninitializedCopy(alloc, std::make_move_iterator(other.Data()), std::make_move_iterator(other.Data() + other.size), Data());
+        size = other.size;
+    }
+
+    // Копия строится отдельно, так что при исключении вектор не меняется
+    Storage& operator=(const Storage& rhs)
+    {
+        if(this != &rhs)
+        {
+            Storage copy(rhs);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    Storage& operator=(Storage&& rhs) noexcept(std::is_nothrow_move_constructible_v<Type>)
+    {
+        if(this != &rhs)
+        {
+            DestroyRange(alloc, Data(), Data() + size);
+            size = 0;
+            UninitializedCopy(alloc, std::make_move_iterator(rhs.Data()), std::make_move_iterator(rhs.Data() + rhs.size), Data());
+            size = rhs.size;
+        }
+        return *this;
+    }
+
+    ~Storage()
+    {
+        DestroyRange(alloc, Data(), Data() + size);
+    }
+
+    Type* Data() noexcept
+    {
+        return std::launder(reinterpret_cast<Type*>(bytes));
+    }
+
+    const Type* Data() const noexcept
+    {
+        return std::launder(reinterpret_cast<const Type*>(bytes));
+    }
+
+    template <typename... Args>
+    void Construct(size_t index, Args&&... args)
+    {
+        ConstructAt(alloc, Data() + index, std::forward<Args>(args)...);
+    }
+
+    void Destroy(size_t index) noexcept
+    {
+        DestroyAt(alloc, Data() + index);
+    }
+
+    size_t size = 0;
+    [[no_unique_address]] std::allocator<Type> alloc;
+    alignas(Type) unsigned char bytes[sizeof(Type) * (N == 0 ? 1 : N)];
+};
+
+} // namespace static_vector_detail
+
+// Вектор с вместимостью N внутри самого объекта: кучу не трогает никогда. Интерфейс
+// повторяет SimpleVector, а превышение вместимости бросает std::length_error.
+//
+// Для тривиальных типов все операции constexpr, и вектор может быть constexpr-переменной.
+// Так таблицы строятся при компиляции: constexpr-функция заполняет SimpleVector или
+// сразу StaticSimpleVector, а результат копируется в StaticSimpleVector, который
+// компилятор кладёт в данные только для чтения и который не стоит ничего при запуске
+template <typename Type, size_t N>
+class StaticSimpleVector {
+public:
+    using Iterator = Type*;
+    using ConstIterator = const Type*;
+
+    static constexpr size_t kCapacity = N;
+
+    SIMPLE_VECTOR_CONSTEXPR StaticSimpleVector() noexcept = default;
+
+    // Создаёт вектор из size элементов, инициализированных значением по умолчанию
+    SIMPLE_VECTOR_CONSTEXPR explicit StaticSimpleVector(size_t size)
+    {
+        Resize(size);
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR StaticSimpleVector(size_t size, const Type& value)
+    {
+        CheckRoom(size);
+        for(size_t i = 0; i < size; ++i)
+        {
+            EmplaceBack(value);
+        }
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR StaticSimpleVector(std::initializer_list<Type> init)
+    : StaticSimpleVector(init.begin(), init.end())
+    {}
+
+    // Создаёт вектор из элементов [first, last) - например, из SimpleVector,
+    // заполненного при вычислении констант
+    template <typename InputIt, typename = std::enable_if_t<kIsIteratorOf<InputIt, std::input_iterator_tag>>>
+    SIMPLE_VECTOR_CONSTEXPR StaticSimpleVector(InputIt first, InputIt last)
+    {
+        for(; first != last; ++first)
+        {
+            EmplaceBack(*first);
+        }
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR size_t GetSize() const noexcept
+    {
+        return storage_.size;
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR size_t GetCapacity() const noexcept
+    {
+        return N;
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR bool IsEmpty() const noexcept
+    {
+        return storage_.size == 0;
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR Type& operator[](size_t index) noexcept
+    {
+        assert(index < storage_.size);
+        return storage_.Data()[index];
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR const Type& operator[](size_t index) const noexcept
+    {
+        assert(index < storage_.size);
+        return storage_.Data()[index];
+    }
+
+    // Выбрасывает исключение std::out_of_range, если index >= size
+    SIMPLE_VECTOR_CONSTEXPR Type& At(size_t index)
+    {
+        if(index >= storage_.size)
+        {
+            throw std::out_of_range("Index is out of range");
+        }
+        return storage_.Data()[index];
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR const Type& At(size_t index) const
+    {
+        if(index >= storage_.size)
+        {
+            throw std::out_of_range("Index is out of range");
+        }
+        return storage_.Data()[index];
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR Iterator begin() noexcept
+    {
+        return storage_.Data();
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR Iterator end() noexcept
+    {
+        return storage_.Data() + storage_.size;
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR ConstIterator begin() const noexcept
+    {
+        return storage_.Data();
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR ConstIterator end() const noexcept
+    {
+        return storage_.Data() + storage_.size;
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR ConstIterator cbegin() const noexcept
+    {
+        return begin();
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR ConstIterator cend() const noexcept
+    {
+        return end();
+    }
+
+    // Возвращает итератор на первый элемент, равный value, или end()
+    SIMPLE_VECTOR_CONSTEXPR ConstIterator Find(const Type& value) const noexcept
+    {
+        return RangeFind(cbegin(), storage_.size, value);
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR size_t Count(const Type& value) const noexcept
+    {
+        return RangeCount(cbegin(), storage_.size, value);
+    }
+
+    // Создаёт элемент в конце вектора. Элементы не переезжают, поэтому args
+    // могут ссылаться на элементы самого вектора
+    template <typename... Args>
+    SIMPLE_VECTOR_CONSTEXPR Type& EmplaceBack(Args&&... args)
+    {
+        CheckRoom(1);
+        storage_.Construct(storage_.size, std::forward<Args>(args)...);
+        return storage_.Data()[storage_.size++];
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR void PushBack(const Type& element)
+    {
+        EmplaceBack(element);
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR void PushBack(Type&& element)
+    {
+        EmplaceBack(std::move(element));
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR void PopBack() noexcept
+    {
+        assert(storage_.size != 0);
+        storage_.Destroy(--storage_.size);
+    }
+
+    // Создаёт элемент из аргументов args перед позицией pos
+    // Аргументы могут ссылаться на элементы самого вектора
+    template <typename... Args>
+    SIMPLE_VECTOR_CONSTEXPR Iterator Emplace(ConstIterator pos, Args&&... args)
+    {
+        const auto index = static_cast<size_t>(pos - cbegin());
+        assert(index <= storage_.size);
+        CheckRoom(1);
+        if(index == storage_.size)
+        {
+            return &EmplaceBack(std::forward<Args>(args)...);
+        }
+        // Значение создаётся до сдвига, пока ссылки в args ещё указывают на свои элементы
+        Type value(std::forward<Args>(args)...);
+        Type* data = storage_.Data();
+        storage_.Construct(storage_.size, std::move(data[storage_.size - 1]));
+        ++storage_.size;
+        std::move_backward(data + index, data + storage_.size - 2, data + storage_.size - 1);
+        data[index] = std::move(value);
+        return data + index;
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR Iterator Insert(ConstIterator pos, const Type& value)
+    {
+        return Emplace(pos, value);
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR Iterator Insert(ConstIterator pos, Type&& value)
+    {
+        return Emplace(pos, std::move(value));
+    }
+
+    // Вставляет count копий value перед pos
+    SIMPLE_VECTOR_CONSTEXPR Iterator Insert(ConstIterator pos, size_t count, const Type& value)
+    {
+        CheckRoom(count);
+        const Type copy(value);
+        return InsertAtEndAndRotate(pos, [&] {
+            for(size_t i = 0; i < count; ++i)
+            {
+                EmplaceBack(copy);
+            }
+        });
+    }
+
+    // Вставляет элементы [first, last) перед pos. Если они не поместятся, вектор не меняется
+    template <typename InputIt, typename = std::enable_if_t<kIsIteratorOf<InputIt, std::input_iterator_tag>>>
+    SIMPLE_VECTOR_CONSTEXPR Iterator Insert(ConstIterator pos, InputIt first, InputIt last)
+    {
+        return InsertAtEndAndRotate(pos, [&] {
+            for(; first != last; ++first)
+            {
+                EmplaceBack(*first);
+            }
+        });
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR Iterator Erase(ConstIterator pos)
+    {
+        return Erase(pos, pos + 1);
+    }
+
+    // Удаляет элементы [first, last) и возвращает итератор на элемент, следовавший за ними
+    SIMPLE_VECTOR_CONSTEXPR Iterator Erase(ConstIterator first, ConstIterator last)
+    {
+        const auto index = static_cast<size_t>(first - cbegin());
+        const auto count = static_cast<size_t>(last - first);
+        assert(index + count <= storage_.size);
+        Type* data = storage_.Data();
+        std::move(data + index + count, data + storage_.size, data + index);
+        for(size_t i = 0; i < count; ++i)
+        {
+            storage_.Destroy(--storage_.size);
+        }
+        return data + index;
+    }
+
+    // Изменяет размер. Новые элементы получают значение по умолчанию
+    SIMPLE_VECTOR_CONSTEXPR void Resize(size_t new_size)
+    {
+        if(new_size > storage_.size)
+        {
+            CheckRoom(new_size - storage_.size);
+        }
+        while(storage_.size < new_size)
+        {
+            EmplaceBack();
+        }
+        while(storage_.size > new_size)
+        {
+            PopBack();
+        }
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR void Clear() noexcept
+    {
+        while(storage_.size != 0)
+        {
+            storage_.Destroy(--storage_.size);
+        }
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR void swap(StaticSimpleVector& other)
+    {
+        std::swap(storage_, other.storage_);
+    }
+
+private:
+    // Выбрасывает std::length_error, если ещё count элементов не поместятся
+    SIMPLE_VECTOR_CONSTEXPR void CheckRoom(size_t count) const
+    {
+        if(count > N - storage_.size)
+        {
+            throw std::length_error("StaticSimpleVector is full");
+        }
+    }
+
+    // append дописывает новые элементы в конец, после чего они одним поворотом
+    // переезжают на место pos. Если append бросит исключение, дописанное удаляется
+    template <typename Append>
+    SIMPLE_VECTOR_CONSTEXPR Iterator InsertAtEndAndRotate(ConstIterator pos, Append append)
+    {
+        const auto index = static_cast<size_t>(pos - cbegin());
+        assert(index <= storage_.size);
+        const size_t old_size = storage_.size;
+        try
+        {
+            append();
+        }
+        catch(...)
+        {
+            while(storage_.size > old_size)
+            {
+                PopBack();
+            }
+            throw;
+        }
+        std::rotate(begin() + index, begin() + old_size, end());
+        return begin() + index;
+    }
+
+    static_vector_detail::Storage<Type, N> storage_;
+};
+
+template <typename Type, size_t N>
+SIMPLE_VECTOR_CONSTEXPR bool operator==(const StaticSimpleVector<Type, N>& lhs, const StaticSimpleVector<Type, N>& rhs) {
+    return lhs.GetSize() == rhs.GetSize() && RangeEqual(lhs.cbegin(), rhs.cbegin(), lhs.GetSize());
+}
+
+template <typename Type, size_t N>
+SIMPLE_VECTOR_CONSTEXPR bool operator!=(const StaticSimpleVector<Type, N>& lhs, const StaticSimpleVector<Type, N>& rhs) {
+    return !(lhs == rhs);
+}
+
+template <typename Type, size_t N>
+SIMPLE_VECTOR_CONSTEXPR bool operator<(const StaticSimpleVector<Type, N>& lhs, const StaticSimpleVector<Type, N>& rhs) {
+    return RangeCompare(lhs.cbegin(), lhs.GetSize(), rhs.cbegin(), rhs.GetSize()) < 0;
+}
+
+template <typename Type, size_t N>
+SIMPLE_VECTOR_CONSTEXPR bool operator>(const StaticSimpleVector<Type, N>& lhs, const StaticSimpleVector<Type, N>& rhs) {
+    return RangeCompare(lhs.cbegin(), lhs.GetSize(), rhs.cbegin(), rhs.GetSize()) > 0;
+}
+
+template <typename Type, size_t N>
+SIMPLE_VECTOR_CONSTEXPR bool operator<=(const StaticSimpleVector<Type, N>& lhs, const StaticSimpleVector<Type, N>& rhs) {
+    return RangeCompare(lhs.cbegin(), lhs.GetSize(), rhs.cbegin(), rhs.GetSize()) <= 0;
+}
+
+template <typename Type, size_t N>
+SIMPLE_VECTOR_CONSTEXPR bool operator>=(const StaticSimpleVector<Type, N>& lhs, const StaticSimpleVector<Type, N>& rhs) {
+    return RangeCompare(lhs.cbegin(), lhs.GetSize(), rhs.cbegin(), rhs.GetSize()) >= 0;
+}
+
+#if defined(__cpp_impl_three_way_comparison) && defined(__cpp_lib_three_way_comparison)
+template <typename Type, size_t N>
+SIMPLE_VECTOR_CONSTEXPR SynthThreeWayResult<Type> operator<=>(const StaticSimpleVector<Type, N>& lhs, const StaticSimpleVector<Type, N>& rhs) {
+    return RangeCompareThreeWay(lhs.cbegin(), lhs.GetSize(), rhs.cbegin(), rhs.GetSize());
+}
+#endif
@@ -1,9 +1,41 @@
 #pragma once
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
 #include <stdexcept>
 #include <iostream>
 #include <string>
+#include <sstream>
+#include <iterator>
+#include <list>
+#include <map>
+#include <numeric>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <memory_resource>
+#include <utility>
 #include "simple_vector.h"
+#include "small_simple_vector.h"
+#include "concurrent_simple_vector.h"
+#include "parallel_algorithms.h"
+#include "mapped_simple_vector.h"
+#include "simple_vector_io.h"
+#include "aligned_allocator.h"
+#include "shared_simple_vector.h"
+#include "simple_vector_stats.h"
+#include "segmented_simple_vector.h"
+#include "soa_simple_vector.h"
+#include "static_simple_vector.h"
+#include "simple_vector_view.h"
+#include "flat_containers.h"
+#include "bit_simple_vector.h"
+#include "gap_simple_vector.h"
+#include "packed_int_vector.h"
 
 // У функции, объявленной со спецификатором inline, может быть несколько
 // идентичных определений в разных единицах трансляции.
@@ -105,14 +137,14 @@ inline void Test1() {
         // Пустой вектор
         {
             SimpleVector<int> v;
-            assert(v.begin() == nullptr);
-            assert(v.end() == nullptr);
+            assert(v.Data() == nullptr);
+            assert(v.Data() + v.GetSize() == nullptr);
         }
 
         // Непустой вектор
         {
             SimpleVector<int> v(10, 42);
-            assert(v.begin());
+            assert(v.Data());
             assert(*v.begin() == 42);
             assert(v.end() == v.begin() + v.GetSize());
         }
@@ -360,4 +392,2496 @@ inline void Test4() {
         assert(v_for_move.At(0) == 3);
         assert(v_for_move.At(1) == 42);
     }
-}
\ No newline at end of file
+}
+
+// Тип без конструктора по умолчанию, считающий живые экземпляры
+struct CountedItem {
+    explicit CountedItem(int v)
+    : value(v)
+    {
+        ++alive;
+    }
+    CountedItem(const CountedItem& other)
+    : value(other.value)
+    {
+        ++alive;
+    }
+    CountedItem(CountedItem&& other) noexcept
+    : value(other.value)
+    {
+        ++alive;
+    }
+    CountedItem& operator=(const CountedItem&) = default;
+    CountedItem& operator=(CountedItem&&) = default;
+    ~CountedItem()
+    {
+        --alive;
+    }
+
+    int value = 0;
+    inline static int alive = 0;
+};
+
+inline void Test5() {
+    // Reserve не создаёт элементы в запасной ёмкости
+    {
+        SimpleVector<CountedItem> v;
+        v.Reserve(1000);
+        assert(CountedItem::alive == 0);
+        v.PushBack(CountedItem(1));
+        v.PushBack(CountedItem(2));
+        assert(CountedItem::alive == 2);
+        v.Reserve(2000);
+        assert(CountedItem::alive == 2);
+        assert(v[1].value == 2);
+    }
+    assert(CountedItem::alive == 0);
+
+    // Insert, Erase, PopBack и Clear разрушают ровно живые элементы
+    {
+        SimpleVector<CountedItem> v;
+        for (int i = 0; i < 10; ++i) {
+            v.PushBack(CountedItem(i));
+        }
+        v.Insert(v.begin(), CountedItem(-1));
+        assert(v.GetSize() == 11 && CountedItem::alive == 11);
+        assert(v[0].value == -1 && v[10].value == 9);
+        v.Insert(v.begin() + 3, v[0]);
+        assert(v[3].value == -1 && CountedItem::alive == 12);
+        v.Erase(v.begin());
+        v.PopBack();
+        assert(v.GetSize() == 10 && CountedItem::alive == 10);
+        v.Clear();
+        assert(CountedItem::alive == 0);
+    }
+    assert(CountedItem::alive == 0);
+
+    // Resize вниз разрушает хвост, вверх - создаёт значения по умолчанию
+    {
+        SimpleVector<std::string> v{"a", "b", "c"};
+        v.Resize(1);
+        v.Resize(4);
+        assert(v[0] == "a");
+        assert(v[1].empty() && v[3].empty());
+    }
+}
+
+inline void Test6() {
+    using namespace std::literals;
+    // EmplaceBack создаёт элемент на месте из аргументов конструктора
+    {
+        SimpleVector<std::pair<std::string, int>> v;
+        auto& ref = v.EmplaceBack("one"s, 1);
+        assert(&ref == &v[0]);
+        v.EmplaceBack("two"s, 2);
+        assert(v.GetSize() == 2);
+        assert(v[1].first == "two"s && v[1].second == 2);
+    }
+
+    // Вместимость растёт геометрически и не меняется, пока хватает места
+    {
+        SimpleVector<int> v;
+        size_t reallocations = 0;
+        size_t capacity = v.GetCapacity();
+        for (int i = 0; i < 1000; ++i) {
+            v.PushBack(i);
+            if (v.GetCapacity() != capacity) {
+                ++reallocations;
+                assert(v.GetCapacity() >= capacity * 2);
+                capacity = v.GetCapacity();
+            }
+        }
+        assert(reallocations <= 11);
+        for (int i = 0; i < 1000; ++i) {
+            assert(v[i] == i);
+        }
+    }
+
+    // Аргумент может ссылаться на элемент самого вектора, в том числе при переаллокации
+    {
+        SimpleVector<std::string> v{"first"s, "second"s};
+        assert(v.GetSize() == v.GetCapacity());
+        v.PushBack(v[0]);
+        assert(v[2] == "first"s);
+        v.Emplace(v.begin(), v[1]);
+        assert((v == SimpleVector<std::string>{"second"s, "first"s, "second"s, "first"s}));
+        v.Reserve(10);
+        v.Emplace(v.begin() + 1, v[3]);
+        assert((v == SimpleVector<std::string>{"second"s, "first"s, "first"s, "second"s, "first"s}));
+    }
+
+    // Emplace в конец и в середину
+    {
+        SimpleVector<std::string> v;
+        v.Emplace(v.end(), 3, 'c');
+        v.Emplace(v.begin(), 1, 'a');
+        v.Emplace(v.begin() + 1, "bb"s);
+        assert((v == SimpleVector<std::string>{"a"s, "bb"s, "ccc"s}));
+    }
+}
+
+// Владеет объектом в куче и не хранит указателей на себя, поэтому тривиально перемещаем
+struct RelocatableBox {
+    explicit RelocatableBox(int v)
+    : value(std::make_unique<int>(v))
+    {}
+    std::unique_ptr<int> value;
+};
+
+template <>
+struct IsTriviallyRelocatable<RelocatableBox> : std::true_type {};
+
+inline void Test7() {
+    static_assert(kIsTriviallyRelocatable<int>);
+    static_assert(!kIsTriviallyRelocatable<std::string>);
+    static_assert(kIsTriviallyRelocatable<RelocatableBox>);
+
+    // Удаление и вставка в начало для тривиально копируемого типа
+    {
+        SimpleVector<int> v;
+        for (int i = 0; i < 100; ++i) {
+            v.PushBack(i);
+        }
+        v.Erase(v.begin());
+        v.Erase(v.end() - 1);
+        v.Insert(v.begin(), -1);
+        v.Insert(v.begin() + 50, -2);
+        assert(v.GetSize() == 100);
+        assert(v[0] == -1 && v[1] == 1 && v[50] == -2 && v[51] == 50 && v[99] == 98);
+    }
+
+    // Пользовательский тривиально перемещаемый тип только с перемещением
+    {
+        SimpleVector<RelocatableBox> v;
+        for (int i = 0; i < 10; ++i) {
+            v.EmplaceBack(i);
+        }
+        v.Reserve(100);
+        v.Insert(v.begin() + 3, RelocatableBox(42));
+        v.Erase(v.begin());
+        assert(v.GetSize() == 10);
+        assert(*v[0].value == 1 && *v[2].value == 42 && *v[9].value == 9);
+        v.Emplace(v.begin(), -1);
+        assert(*v[0].value == -1 && *v[1].value == 1);
+    }
+
+    // Типы, которые нельзя переносить побайтово, по-прежнему перемещаются поэлементно
+    {
+        SimpleVector<std::string> v{"a", "b", "c"};
+        v.Erase(v.begin());
+        v.Reserve(10);
+        v.Insert(v.begin(), "z");
+        assert((v == SimpleVector<std::string>{"z", "b", "c"}));
+    }
+}
+
+inline void Test8() {
+    using PmrStrings = SimpleVector<std::pmr::string, std::pmr::polymorphic_allocator<std::pmr::string>>;
+
+    // Память вектора и вложенных строк берётся из монотонного ресурса
+    {
+        std::pmr::monotonic_buffer_resource arena;
+        PmrStrings v(&arena);
+        for (int i = 0; i < 100; ++i) {
+            v.EmplaceBack("a rather long string that does not fit into SSO");
+            v.EmplaceBack(40, 'x');
+        }
+        v.Emplace(v.begin(), "front");
+        v.Erase(v.begin() + 1);
+        v.Resize(250);
+        assert(v.GetAllocator().resource() == &arena);
+        for (size_t i = 0; i < v.GetSize(); ++i) {
+            assert(v[i].get_allocator().resource() == &arena);
+        }
+        assert(v[0] == "front" && v[1].size() == 40 && v[249].empty());
+    }
+
+    // Копирование и перемещение между разными ресурсами не переносят аллокатор
+    {
+        std::pmr::monotonic_buffer_resource arena1;
+        std::pmr::monotonic_buffer_resource arena2;
+        PmrStrings v1({"one", "two"}, &arena1);
+        PmrStrings v2(&arena2);
+        v2 = v1;
+        assert(v2 == v1);
+        assert(v2.GetAllocator().resource() == &arena2);
+        assert(v2[0].get_allocator().resource() == &arena2);
+
+        PmrStrings v3(&arena2);
+        v3 = std::move(v1);
+        assert(v3.GetAllocator().resource() == &arena2);
+        assert(v3[1] == "two" && v3[1].get_allocator().resource() == &arena2);
+
+        PmrStrings v4(std::move(v3));
+        assert(v4.GetAllocator().resource() == &arena2);
+        assert(v4.GetSize() == 2 && v3.IsEmpty());
+
+        PmrStrings v5(v4, &arena1);
+        assert(v5 == v4 && v5.GetAllocator().resource() == &arena1);
+    }
+}
+
+inline void Test9() {
+    using namespace std::literals;
+    using SmallInts = SmallSimpleVector<int, 4>;
+
+    // Базовые операции, как у SimpleVector
+    {
+        SmallInts v;
+        assert(v.IsEmpty() && v.IsInline());
+        assert(v.GetCapacity() == SmallInts::kInlineCapacity);
+
+        SmallInts v1(3, 42);
+        assert(v1.GetSize() == 3 && v1[2] == 42 && v1.IsInline());
+
+        SmallInts v2{1, 2, 3};
+        v2.PushBack(5);
+        assert(v2.IsInline());
+        v2.Insert(v2.begin() + 1, 4);
+        assert(!v2.IsInline());
+        assert((v2 == SmallInts{1, 4, 2, 3, 5}));
+        v2.Erase(v2.begin());
+        v2.PopBack();
+        assert((v2 == SmallInts{4, 2, 3}));
+
+        try {
+            v2.At(3);
+            assert(false);
+        } catch (const std::out_of_range&) {
+        }
+
+        SmallInts v3(Reserve(10));
+        assert(v3.GetCapacity() == 10 && v3.IsEmpty());
+        v3.Resize(5);
+        assert(v3.GetSize() == 5 && v3[4] == 0);
+        v3.Resize(1);
+        v3.Resize(3);
+        assert(v3[2] == 0);
+    }
+
+    // Сравнение
+    {
+        assert((SmallInts{1, 2, 3} == SmallInts{1, 2, 3}));
+        assert((SmallInts{1, 2, 3} != SmallInts{1, 2, 2}));
+        assert((SmallInts{1, 2, 3} < SmallInts{1, 2, 3, 1}));
+        assert((SmallInts{1, 2, 3} > SmallInts{1, 2, 2, 1}));
+        assert((SmallInts{1, 2, 3} >= SmallInts{1, 2, 3}));
+        assert((SmallInts{1, 2, 3} <= SmallInts{1, 2, 4}));
+    }
+
+    // Перемещение встроенного и размещённого в куче вектора
+    {
+        using SmallStrings = SmallSimpleVector<std::string, 2>;
+        SmallStrings inline_v{"a"s, "b"s};
+        SmallStrings heap_v{"c"s, "d"s, "e"s};
+        assert(inline_v.IsInline() && !heap_v.IsInline());
+
+        const std::string* heap_data = &heap_v[0];
+        SmallStrings moved_heap(std::move(heap_v));
+        assert(&moved_heap[0] == heap_data);
+        assert(heap_v.IsEmpty() && heap_v.IsInline());
+
+        SmallStrings moved_inline(std::move(inline_v));
+        assert(moved_inline.IsInline() && moved_inline[1] == "b"s);
+        assert(inline_v.IsEmpty());
+
+        moved_inline.swap(moved_heap);
+        assert((moved_inline == SmallStrings{"c"s, "d"s, "e"s}));
+        assert((moved_heap == SmallStrings{"a"s, "b"s}));
+        assert(!moved_inline.IsInline() && moved_heap.IsInline());
+
+        SmallStrings other_heap{"x"s, "y"s, "z"s, "w"s};
+        other_heap.swap(moved_inline);
+        assert(&other_heap[0] == heap_data);
+
+        SmallStrings copy(other_heap);
+        copy = moved_heap;
+        assert((copy == SmallStrings{"a"s, "b"s}));
+        copy = std::move(other_heap);
+        assert(copy.GetSize() == 3 && &copy[0] == heap_data);
+    }
+
+    // С неравными аллокаторами перемещающее присваивание выделяет память и может бросить
+    {
+        using PmrSmall = SmallSimpleVector<int, 2, std::pmr::polymorphic_allocator<int>>;
+        static_assert(std::is_nothrow_move_assignable_v<SmallInts>);
+        static_assert(!std::is_nothrow_move_assignable_v<PmrSmall>);
+        std::pmr::monotonic_buffer_resource arena1;
+        std::pmr::monotonic_buffer_resource arena2;
+        PmrSmall a({1, 2, 3}, &arena1);
+        PmrSmall b(&arena2);
+        b = std::move(a);
+        assert((b == PmrSmall{1, 2, 3}) && b.GetAllocator().resource() == &arena2);
+
+        // Обмен встроенного вектора с вектором в куче тоже переносит элементы присваиванием
+        static_assert(noexcept(std::declval<SmallInts&>().swap(std::declval<SmallInts&>())));
+        static_assert(!noexcept(std::declval<PmrSmall&>().swap(std::declval<PmrSmall&>())));
+        PmrSmall c({4}, &arena1);
+        c.swap(b);
+        assert((c == PmrSmall{1, 2, 3}) && (b == PmrSmall{4}));
+        assert(c.GetAllocator().resource() == &arena1 && b.GetAllocator().resource() == &arena2);
+    }
+
+    // Элементы во встроенном буфере корректно разрушаются
+    {
+        {
+            SmallSimpleVector<CountedItem, 3> v;
+            v.EmplaceBack(1);
+            v.EmplaceBack(2);
+            SmallSimpleVector<CountedItem, 3> w(std::move(v));
+            w.EmplaceBack(3);
+            w.EmplaceBack(4);
+            assert(CountedItem::alive == 4);
+        }
+        assert(CountedItem::alive == 0);
+    }
+}
+
+// Проверяет вставку диапазона во все позиции с запасом ёмкости и без него
+template <typename T, typename MakeValue>
+void CheckRangeInsert(MakeValue make_value) {
+    for (size_t size : {0, 1, 5, 9}) {
+        for (size_t count : {0, 1, 3, 7, 20}) {
+            for (size_t index = 0; index <= size; ++index) {
+                for (bool reserve : {false, true}) {
+                    SimpleVector<T> v;
+                    std::vector<T> expected;
+                    if (reserve) {
+                        v.Reserve(size + count);
+                    }
+                    for (size_t i = 0; i < size; ++i) {
+                        v.PushBack(make_value(i));
+                        expected.push_back(make_value(i));
+                    }
+                    std::list<T> source;
+                    for (size_t i = 0; i < count; ++i) {
+                        source.push_back(make_value(100 + i));
+                    }
+                    const T* old_data = v.Data();
+                    auto it = v.Insert(v.begin() + index, source.begin(), source.end());
+                    expected.insert(expected.begin() + index, source.begin(), source.end());
+                    assert(it == v.begin() + index);
+                    assert(v.GetSize() == expected.size());
+                    assert(std::equal(v.begin(), v.end(), expected.begin()));
+                    if (reserve) {
+                        assert(v.Data() == old_data);
+                    }
+                }
+            }
+        }
+    }
+}
+
+inline void Test10() {
+    using namespace std::literals;
+
+    CheckRangeInsert<int>([](size_t i) { return static_cast<int>(i); });
+    CheckRangeInsert<std::string>([](size_t i) { return "string number "s + std::to_string(i); });
+
+    // Конструктор из диапазона и Append
+    {
+        std::list<int> source{1, 2, 3};
+        SimpleVector<int> v(source.begin(), source.end());
+        assert((v == SimpleVector<int>{1, 2, 3}));
+        assert(v.GetCapacity() == 3);
+        v.Append(source);
+        v.Append({7, 8});
+        assert((v == SimpleVector<int>{1, 2, 3, 1, 2, 3, 7, 8}));
+        v.Append(v);
+        assert(v.GetSize() == 16 && v[8] == 1 && v[15] == 8);
+
+        SimpleVector<int> sized(3, 42);
+        assert((sized == SimpleVector<int>{42, 42, 42}));
+    }
+
+    // Однопроходные итераторы
+    {
+        std::istringstream input("4 5 6");
+        SimpleVector<int> v{1, 2, 3};
+        auto it = v.Insert(v.begin() + 1, std::istream_iterator<int>(input), std::istream_iterator<int>());
+        assert(it == v.begin() + 1);
+        assert((v == SimpleVector<int>{1, 4, 5, 6, 2, 3}));
+
+        std::istringstream input2("7 8");
+        SimpleVector<int> w(std::istream_iterator<int>(input2), std::istream_iterator<int>{});
+        assert((w == SimpleVector<int>{7, 8}));
+    }
+
+    // Вставка count копий значения, в том числе ссылающегося на сам вектор
+    {
+        SimpleVector<std::string> v{"a"s, "b"s, "c"s};
+        v.Reserve(10);
+        v.Insert(v.begin(), 2, v[2]);
+        assert((v == SimpleVector<std::string>{"c"s, "c"s, "a"s, "b"s, "c"s}));
+        v.Insert(v.end() - 1, 6, "x"s);
+        assert(v.GetSize() == 11 && v[4] == "x"s && v[9] == "x"s && v[10] == "c"s);
+    }
+
+    // Удаление диапазона
+    {
+        SimpleVector<int> v{0, 1, 2, 3, 4, 5, 6};
+        auto it = v.Erase(v.begin() + 1, v.begin() + 4);
+        assert(*it == 4);
+        assert((v == SimpleVector<int>{0, 4, 5, 6}));
+        v.Erase(v.begin() + 2, v.end());
+        assert((v == SimpleVector<int>{0, 4}));
+        v.Erase(v.begin(), v.begin());
+        assert(v.GetSize() == 2);
+
+        SimpleVector<CountedItem> items;
+        for (int i = 0; i < 10; ++i) {
+            items.EmplaceBack(i);
+        }
+        items.Erase(items.begin() + 2, items.begin() + 8);
+        assert(items.GetSize() == 4 && CountedItem::alive == 4);
+        assert(items[2].value == 8);
+        std::vector<CountedItem> more;
+        more.emplace_back(100);
+        more.emplace_back(101);
+        items.Insert(items.begin() + 1, more.begin(), more.end());
+        assert(items.GetSize() == 6 && CountedItem::alive == 8);
+        assert(items[1].value == 100 && items[3].value == 1);
+    }
+    assert(CountedItem::alive == 0);
+}
+
+inline void Test11() {
+    // Адреса элементов не меняются при росте
+    {
+        ConcurrentSimpleVector<int> v;
+        v.PushBack(1);
+        const int* first = &v[0];
+        for (int i = 0; i < 10000; ++i) {
+            v.PushBack(i);
+        }
+        assert(&v[0] == first);
+        assert(v.GetSize() == 10001);
+        assert(v.GetCapacity() >= v.GetSize());
+        assert(std::accumulate(v.begin(), v.end(), 0LL) == 1 + 9999LL * 10000 / 2);
+        ConcurrentSimpleVector<int>::ConstIterator it = v.begin();
+        assert(*it == 1 && it + 10001 == std::as_const(v).end());
+        static_assert(!std::is_move_constructible_v<ConcurrentSimpleVector<int>>);
+        try {
+            v.At(10001);
+            assert(false);
+        } catch (const std::out_of_range&) {
+        }
+    }
+
+    // Одновременная запись из нескольких потоков и перенос в SimpleVector
+    {
+        constexpr int kThreads = 4;
+        constexpr int kPerThread = 20000;
+        ConcurrentSimpleVector<int> v;
+        std::vector<std::thread> writers;
+        for (int t = 0; t < kThreads; ++t) {
+            writers.emplace_back([&v, t] {
+                for (int i = 0; i < kPerThread; ++i) {
+                    v.PushBack(t * kPerThread + i);
+                }
+            });
+        }
+        for (auto& writer : writers) {
+            writer.join();
+        }
+        assert(v.GetSize() == static_cast<size_t>(kThreads * kPerThread));
+
+        SimpleVector<int> frozen = v.Freeze();
+        assert(v.IsEmpty());
+        assert(frozen.GetSize() == static_cast<size_t>(kThreads * kPerThread));
+        std::sort(frozen.begin(), frozen.end());
+        for (int i = 0; i < kThreads * kPerThread; ++i) {
+            assert(frozen[i] == i);
+        }
+    }
+
+    // Элементы разрушаются ровно один раз, в том числе после Freeze
+    {
+        ConcurrentSimpleVector<std::string> v;
+        v.Reserve(100);
+        assert(v.GetCapacity() >= 100);
+        for (int i = 0; i < 300; ++i) {
+            v.EmplaceBack(std::to_string(i));
+        }
+        SimpleVector<std::string> frozen = v.Freeze();
+        assert(frozen.GetSize() == 300 && frozen[299] == "299");
+        v.EmplaceBack("again");
+        assert(v.GetSize() == 1 && v[0] == "again");
+
+        ConcurrentSimpleVector<CountedItem> items;
+        for (int i = 0; i < 200; ++i) {
+            items.EmplaceBack(i);
+        }
+        assert(CountedItem::alive == 200);
+        items.Clear();
+        assert(CountedItem::alive == 0);
+    }
+}
+
+// Бросает исключение на copies_before_throw-м копировании. Счётчики атомарные,
+// потому что копии создаются из разных потоков
+struct ParallelItem {
+    explicit ParallelItem(int v)
+    : value(v)
+    {
+        ++alive;
+    }
+    ParallelItem(const ParallelItem& other)
+    : value(other.value)
+    {
+        if (copies_before_throw.load() >= 0 && copies_before_throw.fetch_sub(1) == 0) {
+            throw std::runtime_error("copy failed");
+        }
+        ++alive;
+    }
+    ParallelItem& operator=(const ParallelItem&) = default;
+    ~ParallelItem()
+    {
+        --alive;
+    }
+
+    int value = 0;
+    inline static std::atomic<int> alive = 0;
+    inline static std::atomic<int> copies_before_throw = -1;
+};
+
+inline void Test12() {
+    // Маленькие пороги заставляют алгоритмы делиться на задачи даже на коротких векторах
+    ThreadPool pool(3);
+    ParallelOptions options;
+    options.sequential_threshold = 16;
+    options.grain_size = 100;
+    options.pool = &pool;
+
+    // Заполнение и копирование
+    {
+        SimpleVector<int> v;
+        ParallelAssign(v, 10000, 7, options);
+        assert(v.GetSize() == 10000 && v.GetCapacity() >= 10000);
+        assert(std::count(v.begin(), v.end(), 7) == 10000);
+
+        ParallelFill(v, v[5000], options);
+        ParallelTransform(v, [](int x) { return x + 1; }, options);
+        assert(std::count(v.begin(), v.end(), 8) == 10000);
+
+        std::iota(v.begin(), v.end(), 0);
+        SimpleVector<int> copy = ParallelCopy(v, options);
+        assert(copy == v);
+        assert(copy.GetCapacity() == copy.GetSize());
+
+        SimpleVector<std::string> strings;
+        ParallelTransform(v, strings, [](int x) { return std::to_string(x); }, options);
+        assert(strings.GetSize() == 10000 && strings[1234] == "1234");
+
+        // Короткий вектор обрабатывается без пула
+        SimpleVector<int> small{1, 2, 3};
+        assert(ParallelCopy(small, options) == small);
+        assert(ParallelReduce(small, 0) == 6);
+    }
+
+    // Свёртка не требует коммутативности операции
+    {
+        SimpleVector<std::string> letters;
+        for (int i = 0; i < 5000; ++i) {
+            letters.PushBack(std::string(1, static_cast<char>('a' + i % 26)));
+        }
+        const std::string expected = std::accumulate(letters.begin(), letters.end(), std::string(">"));
+        assert(ParallelReduce(letters, std::string(">"), std::plus<>{}, options) == expected);
+
+        SimpleVector<int> numbers(100000);
+        std::iota(numbers.begin(), numbers.end(), 1);
+        assert(ParallelReduce(numbers, 0LL, std::plus<>{}, options) == 100000LL * 100001 / 2);
+    }
+
+    // Сортировка и устойчивая сортировка
+    {
+        SimpleVector<int> v(20000);
+        unsigned state = 12345;
+        for (int& x : v) {
+            state = state * 1103515245 + 12345;
+            x = static_cast<int>(state >> 8) % 1000;
+        }
+        SimpleVector<int> expected(v);
+        std::sort(expected.begin(), expected.end());
+        ParallelSort(v, std::less<>{}, options);
+        assert(v == expected);
+        ParallelSort(v, std::greater<>{}, options);
+        assert(std::is_sorted(v.begin(), v.end(), std::greater<>{}));
+
+        SimpleVector<std::pair<int, int>> pairs;
+        for (int i = 0; i < 20000; ++i) {
+            pairs.PushBack({v[i] % 10, i});
+        }
+        ParallelStableSort(pairs, [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; }, options);
+        for (size_t i = 1; i < pairs.GetSize(); ++i) {
+            assert(pairs[i - 1].first < pairs[i].first
+                   || (pairs[i - 1].first == pairs[i].first && pairs[i - 1].second < pairs[i].second));
+        }
+
+        // Строки не тривиально перемещаемы: слияние идёт через буфер, и содержимое
+        // должно пережить перенос туда и обратно
+        ParallelOptions word_options = options;
+        word_options.sequential_threshold = 1000;
+        word_options.grain_size = 250;
+        SimpleVector<std::string> words;
+        for (int i = 0; i < 3000; ++i) {
+            words.PushBack(std::to_string((i * 7919) % 3000));
+        }
+        SimpleVector<std::string> sorted_words(words);
+        std::sort(sorted_words.begin(), sorted_words.end());
+        SimpleVector<std::string> stable_words(words);
+        ParallelSort(words, std::less<>{}, word_options);
+        assert(words == sorted_words);
+        ParallelStableSort(stable_words, std::less<>{}, word_options);
+        assert(stable_words == sorted_words);
+    }
+
+    // Исключение при копировании разрушает все уже созданные элементы
+    {
+        SimpleVector<ParallelItem> v;
+        for (int i = 0; i < 5000; ++i) {
+            v.EmplaceBack(i);
+        }
+        ParallelItem::copies_before_throw = 4321;
+        try {
+            SimpleVector<ParallelItem> copy = ParallelCopy(v, options);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(ParallelItem::alive == 5000);
+
+        SimpleVector<ParallelItem> filled;
+        filled.EmplaceBack(1);
+        ParallelItem::copies_before_throw = 2500;
+        try {
+            ParallelAssign(filled, 5000, ParallelItem(2), options);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(filled.IsEmpty());
+        assert(ParallelItem::alive == 5000);
+    }
+    assert(ParallelItem::alive == 0);
+}
+
+// Сверяет векторные ядра с алгоритмами стандартной библиотеки на массивах разной длины,
+// чтобы задеть и основной цикл, и хвост
+template <typename T>
+void CheckSimdKernels() {
+    for (size_t size : {0, 1, 7, 15, 16, 31, 32, 33, 64, 100, 1000}) {
+        SimpleVector<T> v(size);
+        unsigned state = static_cast<unsigned>(size) * 2654435761u + 1;
+        for (T& x : v) {
+            state = state * 1103515245 + 12345;
+            x = static_cast<T>(state >> 13);
+        }
+        const std::vector<T> expected(v.begin(), v.end());
+
+        for (size_t i = 0; i < size; i += 1 + size / 5) {
+            const T value = v[i];
+            assert(v.Find(value) == v.begin() + (std::find(expected.begin(), expected.end(), value) - expected.begin()));
+            assert(v.Count(value) == static_cast<size_t>(std::count(expected.begin(), expected.end(), value)));
+        }
+        assert(v.MinElement() - v.cbegin() == std::min_element(expected.begin(), expected.end()) - expected.begin());
+        assert(v.MaxElement() - v.cbegin() == std::max_element(expected.begin(), expected.end()) - expected.begin());
+
+        // Различие в каждой позиции, в том числе в старшем байте элемента
+        for (size_t i = 0; i < size; i += 1 + size / 7) {
+            SimpleVector<T> other(v);
+            assert(other == v && !(other < v) && other <= v && other >= v);
+            other[i] = static_cast<T>(other[i] + 1);
+            const std::vector<T> changed(other.begin(), other.end());
+            assert(other != v);
+            assert((v < other) == (expected < changed));
+            assert((v > other) == (expected > changed));
+            assert((v <= other) == (expected <= changed));
+            assert((v >= other) == (expected >= changed));
+#if defined(__cpp_lib_three_way_comparison)
+            assert((v <=> other) == (expected <=> changed));
+#endif
+        }
+        SimpleVector<T> longer(v);
+        longer.PushBack(T{});
+        assert(v < longer && longer > v && v != longer);
+    }
+}
+
+// Тип, у которого есть только operator< и operator==
+struct OnlyLess {
+    int value = 0;
+};
+
+inline bool operator<(const OnlyLess& lhs, const OnlyLess& rhs) {
+    return lhs.value < rhs.value;
+}
+
+inline bool operator==(const OnlyLess& lhs, const OnlyLess& rhs) {
+    return lhs.value == rhs.value;
+}
+
+inline void Test13() {
+    const SimdLevel best = GetSimdLevel();
+    for (SimdLevel level : {SimdLevel::kScalar, SimdLevel::kSse42, SimdLevel::kAvx2}) {
+        SetSimdLevel(level);
+        assert(GetSimdLevel() <= level);
+        CheckSimdKernels<signed char>();
+        CheckSimdKernels<unsigned char>();
+        CheckSimdKernels<short>();
+        CheckSimdKernels<unsigned short>();
+        CheckSimdKernels<int>();
+        CheckSimdKernels<unsigned>();
+        CheckSimdKernels<long long>();
+        CheckSimdKernels<unsigned long long>();
+    }
+    SetSimdLevel(best);
+    assert(GetSimdLevel() == best);
+
+    // Остальные типы сравниваются и ищутся обычными алгоритмами
+    {
+        SimpleVector<std::string> a{"a", "b", "c"};
+        SimpleVector<std::string> b{"a", "b", "d"};
+        assert(a < b && b > a && a <= b && !(a >= b));
+        assert(a.Find("b") == a.begin() + 1 && a.Find("z") == a.end());
+        assert(a.Count("c") == 1);
+        assert(*b.MaxElement() == "d" && *b.MinElement() == "a");
+
+        SimpleVector<double> d{1.5, -0.0, 3.0};
+        SimpleVector<double> e{1.5, 0.0, 3.0};
+        assert(d == e);
+        assert(*d.MaxElement() == 3.0);
+
+        SimpleVector<int> empty;
+        assert(empty.Find(1) == empty.end() && empty.Count(1) == 0);
+        assert(empty.MinElement() == empty.end() && empty.MaxElement() == empty.end());
+    }
+#if defined(__cpp_lib_three_way_comparison)
+    {
+        SimpleVector<int> a{1, 2, 3};
+        SimpleVector<int> b{1, 2, 4};
+        assert((a <=> b) == std::strong_ordering::less);
+        assert((b <=> a) == std::strong_ordering::greater);
+        assert((a <=> a) == std::strong_ordering::equal);
+
+        SimpleVector<OnlyLess> c{{1}, {2}};
+        SimpleVector<OnlyLess> e{{1}, {3}};
+        assert((c <=> e) == std::weak_ordering::less);
+
+        SimpleVector<double> f{1.0, std::nan("")};
+        assert((f <=> f) == std::partial_ordering::unordered);
+
+        SmallSimpleVector<int, 4> small_a{1, 2};
+        SmallSimpleVector<int, 4> small_b{1, 2, 0};
+        assert((small_a <=> small_b) == std::strong_ordering::less);
+    }
+#endif
+}
+
+// Временный файл, который удаляется вместе с объектом
+struct TempFile {
+    TempFile()
+    : path((std::filesystem::temp_directory_path() / ("simple_vector_test_" + std::to_string(::getpid()))).string())
+    {
+        std::filesystem::remove(path);
+    }
+    ~TempFile() {
+        std::filesystem::remove(path);
+    }
+
+    std::string path;
+};
+
+struct Record {
+    std::int64_t id;
+    double value;
+};
+
+inline void Test14() {
+    TempFile file;
+
+    // Новый файл растёт вместе с вектором и обрезается до его размера при закрытии
+    {
+        MappedSimpleVector<Record> v(file.path);
+        assert(v.IsEmpty() && v.GetCapacity() == 0);
+        for (int i = 0; i < 1000; ++i) {
+            v.PushBack({i, i * 0.5});
+        }
+        assert(v.GetSize() == 1000 && v.GetCapacity() >= 1000);
+        assert(v[999].id == 999 && v.At(10).value == 5.0);
+        assert(std::filesystem::file_size(file.path) == v.GetCapacity() * sizeof(Record));
+        v.PopBack();
+        v.Sync();
+    }
+    assert(std::filesystem::file_size(file.path) == 999 * sizeof(Record));
+
+    // Повторное открытие видит записанное и дописывает в конец
+    {
+        MappedSimpleVector<Record> v(file.path);
+        assert(v.GetSize() == 999 && v[500].id == 500);
+        v.EmplaceBack(v[0]);
+        v.Resize(1005);
+        assert(v[999].id == 0 && v[1004].id == 0 && v[1004].value == 0.0);
+        v[1004].id = 42;
+    }
+
+    // Только чтение: изменяющие методы выбрасывают исключение
+    {
+        const MappedSimpleVector<Record> v(file.path, MapMode::kReadOnly);
+        assert(v.GetSize() == 1005 && v[1004].id == 42);
+        assert(std::count_if(v.begin(), v.end(), [](const Record& r) { return r.id == 0; }) == 6);
+        MappedSimpleVector<Record> writable_handle(file.path, MapMode::kReadOnly);
+        try {
+            writable_handle.PushBack({1, 1.0});
+            assert(false);
+        } catch (const std::logic_error&) {
+        }
+        // Чтение через неконстантный вектор не бросает, а запись через ссылку
+        // остаётся в памяти процесса
+        int zeros = 0;
+        for (auto& record : writable_handle) {
+            zeros += record.id == 0;
+        }
+        assert(zeros == 6 && writable_handle[1004].id == 42 && writable_handle.At(1004).id == 42);
+        writable_handle[0].id = 1;
+        assert(writable_handle[0].id == 1 && v[0].id == 0);
+        try {
+            v.At(1005);
+            assert(false);
+        } catch (const std::out_of_range&) {
+        }
+    }
+
+    // Копирование при записи: изменения и рост не попадают в файл
+    {
+        MappedSimpleVector<Record> v(file.path, MapMode::kCopyOnWrite);
+        v[0].id = -1;
+        for (int i = 0; i < 2000; ++i) {
+            v.PushBack({i, 0.0});
+        }
+        assert(v.GetSize() == 3005 && v[0].id == -1 && v[1004].id == 42 && v[3004].id == 1999);
+
+        MappedSimpleVector<Record> moved(std::move(v));
+        assert(moved.GetSize() == 3005 && v.GetSize() == 0);
+    }
+    {
+        const MappedSimpleVector<Record> v(file.path, MapMode::kReadOnly);
+        assert(v.GetSize() == 1005 && v[0].id == 0);
+    }
+
+    // Размер файла должен быть кратен размеру записи
+    {
+        std::filesystem::resize_file(file.path, 1005 * sizeof(Record) + 1);
+        try {
+            MappedSimpleVector<Record> v(file.path, MapMode::kReadOnly);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        try {
+            MappedSimpleVector<Record> v(file.path + ".missing", MapMode::kReadOnly);
+            assert(false);
+        } catch (const std::system_error&) {
+        }
+    }
+}
+
+inline void Test15() {
+    TempFile file;
+
+    // Сохранение и загрузка целиком
+    {
+        SimpleVector<Record> records;
+        for (int i = 0; i < 1000; ++i) {
+            records.PushBack({i, i * 0.25});
+        }
+        SaveSimpleVector(file.path, records);
+        assert(std::filesystem::file_size(file.path) == sizeof(SimpleVectorFileHeader) + 1000 * sizeof(Record));
+
+        SimpleVector<Record> loaded{{-1, -1.0}};
+        LoadSimpleVector(file.path, loaded);
+        assert(loaded.GetSize() == 1000);
+        assert(std::memcmp(loaded.Data(), records.Data(), 1000 * sizeof(Record)) == 0);
+
+        SimpleVector<int> empty;
+        SaveSimpleVector(file.path, empty);
+        SimpleVector<int> loaded_empty{1, 2};
+        LoadSimpleVector(file.path, loaded_empty);
+        assert(loaded_empty.IsEmpty());
+
+        // Элементы другого размера читать нельзя
+        try {
+            SimpleVector<Record> wrong;
+            LoadSimpleVector(file.path, wrong);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+    }
+
+    // Несколько векторов одним writev и чтение по частям в один и тот же буфер
+    {
+        SimpleVector<SimpleVector<std::uint32_t>> batch;
+        for (std::uint32_t n : {0u, 1u, 999u, 5000u}) {
+            SimpleVector<std::uint32_t> v(n);
+            std::iota(v.begin(), v.end(), n);
+            batch.PushBack(std::move(v));
+        }
+        {
+            const int fd = ::open(file.path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            WriteSimpleVectors(fd, batch);
+            ::close(fd);
+        }
+
+        const int fd = ::open(file.path.c_str(), O_RDONLY);
+        SimpleVector<std::uint32_t> whole;
+        ReadSimpleVector(fd, whole);
+        assert(whole == batch[0]);
+        ReadSimpleVector(fd, whole);
+        assert(whole == batch[1]);
+        ReadSimpleVector(fd, whole);
+        assert(whole == batch[2]);
+
+        SimpleVectorReader<std::uint32_t> reader(fd);
+        assert(reader.GetHeader().count == 5000 && reader.GetRemaining() == 5000);
+        SimpleVector<std::uint32_t> chunk;
+        chunk.Reserve(1024);
+        const std::uint32_t* buffer = chunk.Data();
+        std::uint32_t expected = 5000;
+        size_t chunks = 0;
+        while (reader.ReadChunk(chunk, 1024)) {
+            assert(chunk.Data() == buffer && chunk.GetCapacity() == 1024);
+            for (std::uint32_t x : chunk) {
+                assert(x == expected++);
+            }
+            ++chunks;
+        }
+        assert(chunks == 5 && expected == 10000 && chunk.IsEmpty());
+        ::close(fd);
+    }
+
+    // Повреждённые элементы обнаруживаются по контрольной сумме
+    {
+        SimpleVector<std::uint64_t> v(100, 7);
+        SaveSimpleVector(file.path, v);
+        const int fd = ::open(file.path.c_str(), O_WRONLY);
+        const unsigned char garbage = 0xFF;
+        assert(::pwrite(fd, &garbage, 1, sizeof(SimpleVectorFileHeader) + 500) == 1);
+        ::close(fd);
+        try {
+            LoadSimpleVector(file.path, v);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+    }
+
+    // Счётчик в заголовке, которому не хватает байтов: обычный файл отвергается сразу,
+    // а из канала вектор читается кусками, не выделяя память под весь счётчик
+    {
+        SimpleVectorFileHeader header;
+        header.element_size = sizeof(std::uint32_t);
+        header.count = std::uint64_t{1} << 40;
+        const std::uint32_t values[3] = {1, 2, 3};
+        {
+            const int fd = ::open(file.path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            assert(::write(fd, &header, sizeof(header)) == sizeof(header));
+            assert(::write(fd, values, sizeof(values)) == sizeof(values));
+            ::close(fd);
+        }
+        SimpleVector<std::uint32_t> v;
+        try {
+            LoadSimpleVector(file.path, v);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+
+        int pipe_fds[2];
+        assert(::pipe(pipe_fds) == 0);
+        assert(::write(pipe_fds[1], &header, sizeof(header)) == sizeof(header));
+        assert(::write(pipe_fds[1], values, sizeof(values)) == sizeof(values));
+        ::close(pipe_fds[1]);
+        try {
+            ReadSimpleVector(pipe_fds[0], v);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.GetCapacity() <= io_detail::kReadChunkBytes / sizeof(std::uint32_t));
+        ::close(pipe_fds[0]);
+    }
+
+    // Файл с другим порядком байтов: числа переворачиваются при чтении
+    {
+        SimpleVector<std::uint32_t> v{1, 2, 0x01020304};
+        SimpleVectorFileHeader header;
+        header.byte_order = io_detail::ByteSwap(header.byte_order);
+        header.version = io_detail::ByteSwap(header.version);
+        header.element_size = io_detail::ByteSwap<std::uint32_t>(sizeof(std::uint32_t));
+        header.count = io_detail::ByteSwap<std::uint64_t>(v.GetSize());
+        for (auto& x : v) {
+            x = io_detail::ByteSwap(x);
+        }
+        Checksum64 checksum;
+        checksum.Update(v.Data(), v.GetSize() * sizeof(std::uint32_t));
+        header.checksum = io_detail::ByteSwap(checksum.Finish());
+
+        const int fd = ::open(file.path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        assert(::write(fd, &header, sizeof(header)) == sizeof(header));
+        assert(::write(fd, v.Data(), v.GetSize() * sizeof(std::uint32_t)) == 12);
+        ::close(fd);
+
+        SimpleVector<std::uint32_t> loaded;
+        LoadSimpleVector(file.path, loaded);
+        assert((loaded == SimpleVector<std::uint32_t>{1, 2, 0x01020304}));
+    }
+
+    // Контрольная сумма не зависит от того, какими кусками подаются байты
+    {
+        unsigned char bytes[100];
+        std::iota(std::begin(bytes), std::end(bytes), 0);
+        Checksum64 whole;
+        whole.Update(bytes, sizeof(bytes));
+        Checksum64 pieces;
+        pieces.Update(bytes, 3);
+        pieces.Update(bytes + 3, 10);
+        pieces.Update(bytes + 13, 87);
+        assert(whole.Finish() == pieces.Finish());
+        Checksum64 shorter;
+        shorter.Update(bytes, 99);
+        assert(shorter.Finish() != whole.Finish());
+    }
+}
+
+inline void Test16() {
+    // Буфер выровнен по кеш-линии при любом размере и после роста
+    {
+        AlignedSimpleVector<float> v;
+        for (int i = 0; i < 1000; ++i) {
+            v.PushBack(static_cast<float>(i));
+            assert(reinterpret_cast<std::uintptr_t>(v.Data()) % 64 == 0);
+        }
+        SimpleVector<char, AlignedAllocator<char, 256>> bytes(3, 'x');
+        assert(reinterpret_cast<std::uintptr_t>(bytes.Data()) % 256 == 0);
+        AlignedSimpleVector<float> copy(v);
+        assert(copy == v && reinterpret_cast<std::uintptr_t>(copy.Data()) % 64 == 0);
+    }
+
+    // Большой буфер выровнен по большой странице; его страницы впервые касаются потоки пула
+    {
+        ThreadPool pool(2);
+        ParallelOptions options;
+        options.pool = &pool;
+        AlignedSimpleVector<double> v;
+        ParallelResize(v, (kHugePageSize * 4) / sizeof(double) + 1, options);
+        assert(reinterpret_cast<std::uintptr_t>(v.Data()) % kHugePageSize == 0);
+        assert(std::all_of(v.begin(), v.end(), [](double x) { return x == 0.0; }));
+        ParallelResize(v, 10, options);
+        assert(v.GetSize() == 10);
+
+        // Дописывание по одному элементу растит буфер с запасом, а не ровно под размер
+        SimpleVector<int> grown;
+        int reallocations = 0;
+        for (size_t size = 1; size <= 1000; ++size) {
+            const size_t capacity = grown.GetCapacity();
+            ParallelResize(grown, size, options);
+            reallocations += grown.GetCapacity() != capacity;
+        }
+        assert(grown.GetSize() == 1000 && reallocations < 20);
+    }
+
+    // Перепривязка сохраняет выравнивание, так что обратная даёт исходный аллокатор
+    {
+        using Rebound = std::allocator_traits<AlignedAllocator<char, 16>>::rebind_alloc<std::max_align_t>;
+        static_assert(Rebound::kAlignment == 16 && Rebound::kAlignment >= alignof(std::max_align_t));
+        static_assert(std::is_same_v<std::allocator_traits<Rebound>::rebind_alloc<char>, AlignedAllocator<char, 16>>);
+        assert((AlignedAllocator<char, 16>() == Rebound()));
+        assert((AlignedAllocator<char, 16>() != AlignedAllocator<char, 64>()));
+    }
+}
+
+// Тип, для которого включена статистика SimpleVector
+struct StatsItem {
+    int value = 0;
+};
+
+template <>
+struct EnableSimpleVectorStats<StatsItem> : std::true_type {};
+
+// Перемещение может бросить исключение, поэтому при росте элементы копируются
+struct ThrowingMoveItem {
+    ThrowingMoveItem() = default;
+    ThrowingMoveItem(const ThrowingMoveItem&) = default;
+    ThrowingMoveItem(ThrowingMoveItem&&) noexcept(false) {}
+    ThrowingMoveItem& operator=(const ThrowingMoveItem&) = default;
+};
+
+template <>
+struct EnableSimpleVectorStats<ThrowingMoveItem> : std::true_type {};
+
+inline void Test17() {
+    // Копия разделяет буфер, а константный доступ его не отделяет
+    {
+        SharedSimpleVector<int> v{1, 2, 3};
+        SharedSimpleVector<int> snapshot = v;
+        assert(v.UseCount() == 2 && snapshot.cbegin() == v.cbegin());
+        assert(std::as_const(v)[1] == 2 && std::as_const(snapshot).At(2) == 3);
+        assert(std::accumulate(std::as_const(v).begin(), std::as_const(v).end(), 0) == 6);
+        assert(v == snapshot && !(v < snapshot));
+        assert(v.UseCount() == 2);
+    }
+
+    // Каждый изменяющий метод отделяет копию и не трогает снимок
+    {
+        const SharedSimpleVector<int> original{1, 2, 3};
+        auto check = [&original](auto mutate) {
+            SharedSimpleVector<int> copy = original;
+            mutate(copy);
+            assert(copy.UseCount() == 1 && original.UseCount() == 1);
+            assert(copy.cbegin() != original.cbegin());
+            assert((original == SharedSimpleVector<int>{1, 2, 3}));
+        };
+        check([](SharedSimpleVector<int>& v) { v[0] = 10; assert(v[0] == 10); });
+        check([](SharedSimpleVector<int>& v) { v.At(2) = 30; });
+        check([](SharedSimpleVector<int>& v) { *v.begin() = 5; });
+        check([](SharedSimpleVector<int>& v) { v.PushBack(4); assert(v.GetSize() == 4); });
+        check([](SharedSimpleVector<int>& v) { v.PopBack(); assert(v.GetSize() == 2); });
+        check([](SharedSimpleVector<int>& v) { v.Resize(10); assert(v[9] == 0); });
+        check([](SharedSimpleVector<int>& v) { v.Reserve(100); assert(v.GetCapacity() >= 100); });
+        check([](SharedSimpleVector<int>& v) {
+            // Позиция в общем буфере пересчитывается в собственный
+            auto it = v.Insert(v.cbegin() + 1, 7);
+            assert(*it == 7 && it == v.cbegin() + 1);
+        });
+        check([](SharedSimpleVector<int>& v) {
+            auto it = v.Erase(v.cbegin());
+            assert(*it == 2 && v.GetSize() == 2);
+        });
+        check([](SharedSimpleVector<int>& v) {
+            v.Erase(v.cbegin(), v.cend());
+            assert(v.IsEmpty());
+        });
+    }
+
+    // Собственный буфер изменяется на месте; Clear не копирует общий буфер
+    {
+        SharedSimpleVector<int> v{1, 2, 3};
+        const int* data = v.cbegin();
+        v[0] = 4;
+        assert(v.cbegin() == data && v.UseCount() == 1);
+        v.PushBack(5);
+        SharedSimpleVector<int> snapshot = v;
+        v.Clear();
+        assert(v.IsEmpty() && v.UseCount() == 0 && snapshot.GetSize() == 4);
+        v.PushBack(1);
+        assert(v.GetSize() == 1 && snapshot[0] == 4);
+    }
+
+    // Аргумент может ссылаться на элемент общего буфера, который отпускается при отделении
+    {
+        CountedItem::alive = 0;
+        {
+            SharedSimpleVector<CountedItem> v(SimpleVector<CountedItem>(3, CountedItem(1)));
+            auto snapshot = std::make_unique<SharedSimpleVector<CountedItem>>(v);
+            const CountedItem& shared_item = (*snapshot).Get()[0];
+            snapshot.reset();
+            SharedSimpleVector<CountedItem> other = v;
+            other.PushBack(std::as_const(v)[2]);
+            v.PushBack(shared_item);
+            assert(v.GetSize() == 4 && other.GetSize() == 4);
+        }
+        assert(CountedItem::alive == 0);
+    }
+
+    // Снимок можно брать из SimpleVector без копирования и читать как SimpleVector
+    {
+        SimpleVector<int> source(1000, 7);
+        const int* data = source.Data();
+        SharedSimpleVector<int> v(std::move(source));
+        assert(v.cbegin() == data && v.Get().Count(7) == 1000);
+        SharedSimpleVector<int> empty;
+        assert(empty.IsEmpty() && empty.UseCount() == 0 && empty.Get().GetSize() == 0);
+        assert(empty < v && empty != v);
+    }
+
+    // Читатели в разных потоках берут снимки, пока владелец продолжает писать
+    {
+        SharedSimpleVector<int> v(SimpleVector<int>(1000, 1));
+        std::vector<SharedSimpleVector<int>> snapshots(8, v);
+        std::vector<std::thread> readers;
+        std::atomic<bool> ok = true;
+        for (auto& snapshot : snapshots) {
+            readers.emplace_back([&snapshot, &ok] {
+                for (int round = 0; round < 100; ++round) {
+                    const SharedSimpleVector<int> copy = snapshot;
+                    if (std::accumulate(copy.cbegin(), copy.cend(), 0) != 1000) {
+                        ok = false;
+                    }
+                }
+            });
+        }
+        for (int i = 0; i < 1000; ++i) {
+            v[static_cast<size_t>(i)] = 2;
+        }
+        for (auto& reader : readers) {
+            reader.join();
+        }
+        assert(ok);
+        assert(std::accumulate(v.cbegin(), v.cend(), 0) == 2000);
+        assert(snapshots[0].UseCount() == 8);
+    }
+}
+
+inline void Test18() {
+    // Без включённой статистики вектор не становится больше
+    static_assert(!kEnableSimpleVectorStats<int>);
+    static_assert(sizeof(SimpleVector<int>) == sizeof(ArrayPtr<int>) + 2 * sizeof(size_t)
+                                                + (SIMPLE_VECTOR_HAS_CHECKED_ITERATORS ? sizeof(std::uint64_t) : 0));
+
+    // Рост, вставки и удаления попадают в общие счётчики типа
+    {
+        SimpleVectorStats& stats = SimpleVectorStats::ForType<StatsItem>();
+        stats.Reset();
+        SimpleVector<StatsItem> v;
+        for (int i = 0; i < 5; ++i) {
+            v.PushBack(StatsItem{i});
+        }
+        // Вместимость 1, 2, 4, 8: первое выделение и три перевыделения
+        auto snapshot = stats.GetSnapshot();
+        assert(snapshot.allocations == 4 && snapshot.reallocations == 3);
+        assert(snapshot.bytes_allocated == (1 + 2 + 4 + 8) * sizeof(StatsItem));
+        assert(snapshot.peak_capacity == 8);
+        assert(snapshot.elements_relocated == 1 + 2 + 4 && snapshot.elements_copied == 0);
+
+        v.Insert(v.cbegin() + 1, StatsItem{10});
+        v.Erase(v.cbegin(), v.cbegin() + 2);
+        v.Erase(v.cend() - 1);
+        snapshot = stats.GetSnapshot();
+        assert(snapshot.shift_distance == 4 + 4 + 0);
+
+        v.Reserve(100);
+        SimpleVector<StatsItem> copy(v);
+        snapshot = stats.GetSnapshot();
+        assert(snapshot.allocations == 6 && snapshot.reallocations == 4 && snapshot.peak_capacity == 100);
+    }
+
+    // Вектор может писать в свой объект; он переходит к вектору, созданному перемещением
+    {
+        SimpleVectorStats own;
+        SimpleVector<StatsItem> v;
+        v.SetStats(own);
+        v.Resize(3);
+        SimpleVector<StatsItem> moved(std::move(v));
+        assert(&moved.GetStats() == &own);
+        moved.PushBack(StatsItem{});
+        assert(own.GetSnapshot().allocations == 2 && own.GetSnapshot().elements_relocated == 3);
+    }
+
+    // Перенос копированием считается отдельно
+    {
+        SimpleVectorStats& stats = SimpleVectorStats::ForType<ThrowingMoveItem>();
+        stats.Reset();
+        SimpleVector<ThrowingMoveItem> v(2);
+        v.PushBack(ThrowingMoveItem());
+        assert(stats.GetSnapshot().elements_copied == 2 && stats.GetSnapshot().elements_relocated == 2);
+    }
+
+    // Обратный вызов получает события, а печать даёт одну строку
+    {
+        struct Events {
+            size_t reallocations = 0;
+            std::uint64_t shifted = 0;
+        } events;
+        SimpleVectorStats stats;
+        stats.SetCallback([](StatsEvent event, std::uint64_t amount, void* context) {
+            auto& e = *static_cast<Events*>(context);
+            if (event == StatsEvent::kReallocation) {
+                ++e.reallocations;
+            } else if (event == StatsEvent::kShift) {
+                e.shifted += amount;
+            }
+        }, &events);
+        SimpleVector<StatsItem> v;
+        v.SetStats(stats);
+        v.Resize(4);
+        v.Reserve(8);
+        v.Erase(v.cbegin());
+        assert(events.reallocations == 1 && events.shifted == 3);
+
+        std::ostringstream out;
+        DumpStats(out, "items", stats);
+        assert(out.str().rfind("items: allocations=2 reallocations=1 ", 0) == 0);
+        assert(out.str().back() == '\n');
+        stats.Reset();
+        assert(stats.GetSnapshot().allocations == 0);
+    }
+}
+
+inline void Test19() {
+    // ShrinkToFit отдаёт запас, сохраняя элементы
+    {
+        SimpleVector<std::string> v;
+        for (int i = 0; i < 100; ++i) {
+            v.PushBack(std::to_string(i));
+        }
+        v.Resize(10);
+        assert(v.GetCapacity() >= 100);
+        v.ShrinkToFit();
+        assert(v.GetCapacity() == 10 && v.GetSize() == 10 && v[9] == "9");
+        v.ShrinkToFit();
+        assert(v.GetCapacity() == 10);
+        v.Clear();
+        v.ShrinkToFit();
+        assert(v.GetCapacity() == 0 && v.Data() == nullptr);
+        v.PushBack("again");
+        assert(v.GetSize() == 1 && v[0] == "again");
+    }
+
+    // Рост в полтора раза остаётся геометрическим
+    {
+        SimpleVector<int, std::allocator<int>, OneAndHalfGrowth> v;
+        size_t capacity = 0;
+        size_t reallocations = 0;
+        for (int i = 0; i < 100000; ++i) {
+            v.PushBack(i);
+            if (v.GetCapacity() != capacity) {
+                assert(v.GetCapacity() == std::max(capacity * 3 / 2, capacity + 1));
+                capacity = v.GetCapacity();
+                ++reallocations;
+            }
+        }
+        assert(reallocations < 32);
+        assert(v[99999] == 99999);
+        ParallelSort(v, std::greater<>{});
+        assert(v[0] == 99999 && ParallelReduce(v, std::int64_t{0}) == std::int64_t{99999} * 100000 / 2);
+    }
+
+    // Буфер занимает целый класс размера: степень двойки меньше страницы или целые страницы
+    {
+        struct Triple {
+            std::uint64_t a, b, c;
+        };
+        SimpleVector<Triple, std::allocator<Triple>, PageRoundedGrowth<>> v;
+        size_t capacity = 0;
+        for (std::uint64_t i = 0; i < 2000; ++i) {
+            v.PushBack(Triple{i, i, i});
+            if (v.GetCapacity() != capacity) {
+                capacity = v.GetCapacity();
+                const size_t bytes = capacity * sizeof(Triple);
+                size_t size_class = (bytes + 4095) / 4096 * 4096;
+                if (bytes < 4096) {
+                    size_class = 16;
+                    while (size_class < bytes) {
+                        size_class *= 2;
+                    }
+                }
+                assert(size_class - bytes < sizeof(Triple));
+            }
+        }
+        assert(v.GetSize() == 2000 && v[1999].c == 1999);
+        SimpleVector<char, std::allocator<char>, PageRoundedGrowth<>> bytes;
+        bytes.PushBack('x');
+        assert(bytes.GetCapacity() == 16);
+        bytes.Resize(5000);
+        assert(bytes.GetCapacity() == 8192);
+    }
+
+    // Автоуменьшение с гистерезисом
+    {
+        using ShrinkingVector = SimpleVector<int, std::allocator<int>, AutoShrinkGrowth<>>;
+        ShrinkingVector v;
+        for (int i = 0; i < 1000; ++i) {
+            v.PushBack(i);
+        }
+        assert(v.GetCapacity() == 1024);
+        while (v.GetSize() > 256) {
+            v.PopBack();
+        }
+        assert(v.GetCapacity() == 1024);
+        v.PopBack();
+        assert(v.GetCapacity() == 510 && v[254] == 254);
+
+        // Колебания около порога не перевыделяют буфер
+        const int* data = v.Data();
+        for (int i = 0; i < 100; ++i) {
+            v.PushBack(i);
+            v.PopBack();
+        }
+        assert(v.Data() == data);
+
+        // Erase возвращает итератор в новый буфер
+        auto it = v.Erase(v.cbegin() + 10, v.cbegin() + 200);
+        assert(v.GetCapacity() == 130 && *it == 200 && it == v.begin() + 10);
+        v.Resize(40);
+        assert(v.GetCapacity() == 130);
+        v.Resize(16);
+        assert(v.GetCapacity() == 32 && v[9] == 9 && v[15] == 205);
+        v.Clear();
+        assert(v.GetCapacity() == 0);
+
+        // Маленькие буферы не уменьшаются
+        ShrinkingVector small(16);
+        small.Clear();
+        assert(small.GetCapacity() == 16);
+    }
+
+    // Перемещающее присваивание не сжимает буфер, который всё равно отдаёт
+    {
+        struct CountingResource : std::pmr::memory_resource {
+            int allocations = 0;
+            void* do_allocate(size_t bytes, size_t alignment) override {
+                ++allocations;
+                return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+            }
+            void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+                std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+            }
+            bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+                return this == &other;
+            }
+        };
+        // Даже пустому вектору политика оставляет восемь ячеек
+        struct FloorShrinkGrowth {
+            static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t element_size) noexcept {
+                return DoublingGrowth::NextCapacity(capacity, required, element_size);
+            }
+            static constexpr size_t ShrinkCapacity(size_t capacity, size_t size, size_t) noexcept {
+                return capacity > 8 && size < capacity / 4 ? std::max<size_t>(size * 2, 8) : capacity;
+            }
+        };
+        using FloorVector = SimpleVector<int, std::pmr::polymorphic_allocator<int>, FloorShrinkGrowth>;
+        CountingResource resource;
+        FloorVector target(100, 1, &resource);
+        FloorVector source(50, 2, &resource);
+        const int* data = source.Data();
+        const int allocations = resource.allocations;
+        target = std::move(source);
+        assert(resource.allocations == allocations);
+        assert(target.Data() == data && target.GetSize() == 50 && target[49] == 2);
+    }
+}
+
+// Копирование бросает исключение, когда счётчик копий доходит до нуля
+struct FlakyCopyItem {
+    explicit FlakyCopyItem(int v)
+    : value(v)
+    {
+        ++alive;
+    }
+    FlakyCopyItem(const FlakyCopyItem& other)
+    : value(other.value)
+    {
+        if (--copies_left == 0) {
+            throw std::runtime_error("copy failed");
+        }
+        ++alive;
+    }
+    FlakyCopyItem& operator=(const FlakyCopyItem&) = default;
+    ~FlakyCopyItem()
+    {
+        --alive;
+    }
+
+    int value = 0;
+    inline static int alive = 0;
+    inline static int copies_left = -1;
+};
+
+inline void Test20() {
+    using Segmented = SegmentedSimpleVector<int, 4>;
+    static_assert(Segmented::kBlockSize == 16);
+    static_assert(SegmentedSimpleVector<char>::kBlockSize == 16384);
+    static_assert(SegmentedSimpleVector<std::uint64_t>::kBlockSize == 2048);
+
+    // Рост не переносит элементы: ссылки и итераторы остаются действительными
+    {
+        Segmented v;
+        assert(v.IsEmpty() && v.GetCapacity() == 0 && v.begin() == v.end());
+        int& first = v.EmplaceBack(0);
+        const int* seventeenth = nullptr;
+        auto it = v.begin();
+        for (int i = 1; i < 1000; ++i) {
+            v.PushBack(i);
+            if (i == 16) {
+                seventeenth = &v[16];
+            }
+        }
+        assert(&first == &v[0] && seventeenth == &v[16] && *it == 0);
+        assert(v.GetSize() == 1000 && v.GetCapacity() == 1008);
+        assert(v[999] == 999 && v.At(500) == 500);
+        try {
+            v.At(1000);
+            assert(false);
+        } catch (const std::out_of_range&) {
+        }
+
+        // Аргумент может ссылаться на элемент самого вектора
+        v.PushBack(v[3]);
+        assert(v[1000] == 3);
+
+        assert(std::accumulate(v.begin(), v.end(), 0) == 999 * 1000 / 2 + 3);
+        assert(v.end() - v.begin() == 1001 && *(v.end() - 1) == 3 && v.begin()[17] == 17);
+        Segmented::ConstIterator cit = v.begin();
+        assert(cit == v.cbegin() && cit < v.cend());
+        assert(std::is_sorted(v.begin(), v.end() - 1));
+        std::sort(v.begin(), v.end(), std::greater<>{});
+        assert(v[0] == 999 && v[1000] == 0);
+
+        size_t seen = 0;
+        v.ForEachBlock([&seen](const int* data, size_t count) {
+            assert(count <= 16 && data != nullptr);
+            seen += count;
+        });
+        assert(seen == 1001);
+    }
+
+    // PopBack и Clear оставляют блоки, ShrinkToFit освобождает лишние
+    {
+        Segmented v(40, 7);
+        assert(v.GetSize() == 40 && v.GetCapacity() == 48 && v[39] == 7);
+        v.PopBack();
+        v.Resize(10);
+        assert(v.GetSize() == 10 && v.GetCapacity() == 48);
+        v.ShrinkToFit();
+        assert(v.GetCapacity() == 16 && v[9] == 7);
+        v.Resize(20);
+        assert(v[9] == 7 && v[10] == 0 && v[19] == 0);
+        v.Clear();
+        assert(v.IsEmpty() && v.GetCapacity() == 32);
+        v.ShrinkToFit();
+        assert(v.GetCapacity() == 0);
+        v.Reserve(33);
+        assert(v.GetCapacity() == 48 && v.IsEmpty());
+    }
+
+    // Копирование, перемещение и сравнение
+    {
+        Segmented a;
+        for (int i = 0; i < 50; ++i) {
+            a.PushBack(i);
+        }
+        Segmented b = a;
+        assert(a == b && !(a != b) && a <= b && a >= b);
+        b[40] = 100;
+        assert(a != b && a < b && b > a);
+        b[40] = 40;
+        b.PushBack(0);
+        assert(a < b && !(b < a));
+        b.PopBack();
+        b[3] = -1;
+        assert(b < a);
+#if defined(__cpp_impl_three_way_comparison) && defined(__cpp_lib_three_way_comparison)
+        assert((b <=> a) < 0 && (a <=> a) == 0);
+#endif
+        const int* data = &a[20];
+        Segmented moved(std::move(a));
+        assert(a.IsEmpty() && a.GetCapacity() == 0 && &moved[20] == data);
+        a = moved;
+        assert(a == moved);
+        b = std::move(moved);
+        assert(a == b && &b[20] == data);
+        Segmented c = {1, 2, 3};
+        c.swap(b);
+        assert(c == a && b.GetSize() == 3 && b[2] == 3);
+    }
+
+    // Элементы без конструктора по умолчанию и без утечек
+    {
+        {
+            SegmentedSimpleVector<CountedItem, 3> v;
+            for (int i = 0; i < 20; ++i) {
+                v.EmplaceBack(i);
+            }
+            assert(CountedItem::alive == 20);
+            SegmentedSimpleVector<CountedItem, 3> copy(v);
+            assert(CountedItem::alive == 40 && copy[19].value == 19);
+            while (v.GetSize() > 5) {
+                v.PopBack();
+            }
+            assert(CountedItem::alive == 25);
+        }
+        assert(CountedItem::alive == 0);
+    }
+
+    // Исключение при копировании откатывает вектор и не оставляет живых элементов
+    {
+        {
+            SegmentedSimpleVector<FlakyCopyItem, 2> v;
+            for (int i = 0; i < 10; ++i) {
+                v.EmplaceBack(i);
+            }
+            FlakyCopyItem::copies_left = 7;
+            try {
+                SegmentedSimpleVector<FlakyCopyItem, 2> copy(v);
+                assert(false);
+            } catch (const std::runtime_error&) {
+            }
+            assert(FlakyCopyItem::alive == 10);
+            FlakyCopyItem::copies_left = 1;
+            try {
+                v.PushBack(v[0]);
+                assert(false);
+            } catch (const std::runtime_error&) {
+            }
+            assert(v.GetSize() == 10 && FlakyCopyItem::alive == 10);
+            FlakyCopyItem::copies_left = -1;
+        }
+        assert(FlakyCopyItem::alive == 0);
+    }
+
+    // Присваивание между разными ресурсами переносит элементы, а не аллокатор
+    {
+        using PmrSegmented = SegmentedSimpleVector<std::pmr::string, 2, std::pmr::polymorphic_allocator<std::pmr::string>>;
+        std::pmr::monotonic_buffer_resource arena1;
+        std::pmr::monotonic_buffer_resource arena2;
+        PmrSegmented source({"one", "two", "a rather long string that does not fit into SSO", "four", "five"}, &arena1);
+        PmrSegmented target({"old"}, &arena2);
+        target = source;
+        assert(target == source && target.GetAllocator().resource() == &arena2);
+        assert(target[2].get_allocator().resource() == &arena2);
+
+        PmrSegmented moved(&arena2);
+        moved = std::move(source);
+        assert(moved == target && moved.GetAllocator().resource() == &arena2);
+        assert(moved[4].get_allocator().resource() == &arena2);
+
+        // При равных ресурсах блоки забираются целиком
+        const std::pmr::string* element = &moved[4];
+        target = std::move(moved);
+        assert(&target[4] == element && moved.IsEmpty());
+        static_assert(!std::is_nothrow_move_assignable_v<PmrSegmented>);
+        static_assert(std::is_nothrow_move_assignable_v<SegmentedSimpleVector<int>>);
+    }
+}
+
+inline void Test21() {
+    using Particles = SoASimpleVector<float, double, std::string>;
+
+    // Строки раскладываются по выровненным столбцам одного размера
+    {
+        Particles v;
+        assert(v.IsEmpty() && v.GetCapacity() == 0);
+        for (int i = 0; i < 100; ++i) {
+            v.PushBack({static_cast<float>(i), i * 0.5, std::to_string(i)});
+        }
+        assert(v.GetSize() == 100 && v.GetCapacity() >= 100);
+        assert(v.Column<0>().GetCapacity() == v.Column<2>().GetCapacity());
+        assert(reinterpret_cast<std::uintptr_t>(v.ColumnData<0>()) % 64 == 0);
+        assert(reinterpret_cast<std::uintptr_t>(v.ColumnData<1>()) % 64 == 0);
+
+        auto [x, weight, name] = v[42];
+        assert(x == 42.0f && weight == 21.0 && name == "42");
+        x = -1.0f;
+        assert(v.ColumnData<0>()[42] == -1.0f);
+        v[43] = std::make_tuple(7.0f, 7.0, std::string("seven"));
+        assert(std::get<2>(v.At(43)) == "seven" && v.Column<1>()[43] == 7.0);
+        try {
+            v.At(100);
+            assert(false);
+        } catch (const std::out_of_range&) {
+        }
+
+        const double total = std::accumulate(v.Column<1>().begin(), v.Column<1>().end(), 0.0);
+        assert(total == 99 * 100 / 4.0 - 21.5 + 7.0);
+#if defined(__cpp_lib_span)
+        std::span<float> xs = v.ColumnSpan<0>();
+        assert(xs.size() == 100 && xs[1] == 1.0f);
+#endif
+
+        // Аргумент может ссылаться на строку самого вектора, даже когда столбцы растут
+        while (v.GetSize() != v.GetCapacity()) {
+            v.EmplaceBack(0.0f, 0.0, "");
+        }
+        const auto& first = std::get<2>(std::as_const(v)[0]);
+        v.EmplaceBack(std::get<0>(v[1]), 1.5, first);
+        assert(std::get<2>(v[v.GetSize() - 1]) == "0" && std::get<0>(v[v.GetSize() - 1]) == 1.0f);
+    }
+
+    // Insert и Erase сдвигают все столбцы согласованно
+    {
+        Particles v = {{1.0f, 1.0, "a"}, {2.0f, 2.0, "b"}, {3.0f, 3.0, "c"}};
+        v.Insert(1, {9.0f, 9.0, "z"});
+        v.Insert(4, {4.0f, 4.0, "d"});
+        assert(v.GetSize() == 5);
+        assert(v[1] == std::make_tuple(9.0f, 9.0, std::string("z")));
+        assert(std::get<2>(v[4]) == "d" && v.Column<0>()[2] == 2.0f);
+        v.Erase(1);
+        assert(v.Column<2>()[1] == "b" && v.Column<1>()[1] == 2.0);
+        v.Erase(0, 2);
+        assert(v.GetSize() == 2 && v[0] == std::make_tuple(3.0f, 3.0, std::string("c")));
+
+        Particles copy = v;
+        assert(copy == v);
+        std::get<1>(copy[1]) = 0.0;
+        assert(copy != v);
+        v.PopBack();
+        v.Resize(3);
+        assert(v.GetSize() == 3 && std::get<2>(v[2]).empty() && std::get<0>(v[1]) == 0.0f);
+        v.Clear();
+        assert(v.IsEmpty() && v.Column<2>().IsEmpty());
+        v.ShrinkToFit();
+        assert(v.GetCapacity() == 0);
+    }
+
+    // Исключение в одном поле откатывает остальные столбцы
+    {
+        {
+            SoASimpleVector<int, FlakyCopyItem> v;
+            v.Reserve(4);
+            v.EmplaceBack(1, FlakyCopyItem(1));
+            const FlakyCopyItem item(2);
+            FlakyCopyItem::copies_left = 1;
+            try {
+                v.EmplaceBack(2, item);
+                assert(false);
+            } catch (const std::runtime_error&) {
+            }
+            assert(v.GetSize() == 1 && v.Column<0>().GetSize() == 1);
+            FlakyCopyItem::copies_left = 1;
+            try {
+                v.Insert(0, {0, item});
+                assert(false);
+            } catch (const std::runtime_error&) {
+            }
+            assert(v.GetSize() == 1 && v.Column<0>().GetSize() == 1 && std::get<1>(v[0]).value == 1);
+            FlakyCopyItem::copies_left = -1;
+        }
+        assert(FlakyCopyItem::alive == 0);
+    }
+}
+
+#if SIMPLE_VECTOR_HAS_CONSTEXPR
+// Вектор целиком живёт при вычислении константы: рост, вставки, удаления и сравнения
+constexpr int ConstexprSimpleVectorChecksum() {
+    SimpleVector<int> v;
+    for (int i = 0; i < 100; ++i) {
+        v.PushBack(i * i);
+    }
+    v.Insert(v.begin(), -1);
+    v.Insert(v.begin() + 50, 3, 7);
+    const int tail[] = {1, 2, 3};
+    v.Insert(v.end(), std::begin(tail), std::end(tail));
+    v.Erase(v.begin() + 10, v.begin() + 20);
+    v.Erase(v.begin());
+    v.PopBack();
+    SimpleVector<int> copy(v);
+    copy.Resize(200);
+    if (!(v < copy) || v == copy || *v.MaxElement() != 99 * 99 || v.Count(7) != 3) {
+        return -1;
+    }
+    SimpleVector<std::string> names = {"b", "a"};
+    names.Insert(names.begin() + 1, "c");
+    if (names[1] != "c" || names.Find("a") != names.begin() + 2) {
+        return -1;
+    }
+    int sum = 0;
+    for (int x : v) {
+        sum += x;
+    }
+    return sum + static_cast<int>(v.GetSize());
+}
+
+constexpr int ExpectedChecksum() {
+    int sum = 0;
+    for (int i = 0; i < 100; ++i) {
+        if (i < 9 || i > 18) {
+            sum += i * i;
+        }
+    }
+    return sum + 3 * 7 + 1 + 2 + 95;
+}
+
+static_assert(ConstexprSimpleVectorChecksum() == ExpectedChecksum());
+
+// Таблица простых чисел строится при компиляции в SimpleVector и переносится
+// в StaticSimpleVector, который остаётся в данных программы
+constexpr auto kSmallPrimes = [] {
+    SimpleVector<int> primes;
+    for (int n = 2; primes.GetSize() < 20; ++n) {
+        bool prime = true;
+        for (int p : primes) {
+            prime = prime && n % p != 0;
+        }
+        if (prime) {
+            primes.PushBack(n);
+        }
+    }
+    return StaticSimpleVector<int, 32>(primes.begin(), primes.end());
+}();
+
+static_assert(kSmallPrimes.GetSize() == 20 && kSmallPrimes[0] == 2 && kSmallPrimes[19] == 71);
+static_assert(kSmallPrimes.Find(37) != kSmallPrimes.end() && kSmallPrimes.Count(9) == 0);
+
+constexpr auto kEdited = [] {
+    StaticSimpleVector<int, 8> v = {1, 2, 3, 4};
+    v.Insert(v.begin() + 1, 9);
+    v.Insert(v.end(), 2, 5);
+    v.Erase(v.begin() + 3);
+    v.PopBack();
+    return v;
+}();
+
+static_assert(kEdited == StaticSimpleVector<int, 8>{1, 9, 2, 4, 5});
+static_assert(kEdited > StaticSimpleVector<int, 8>{1, 9, 2} && (kEdited <=> kEdited) == 0);
+#endif
+
+inline void Test22() {
+#if SIMPLE_VECTOR_HAS_CONSTEXPR
+    // Постоянные таблицы доступны без кода инициализации
+    {
+        const StaticSimpleVector<int, 32>& primes = kSmallPrimes;
+        assert(std::accumulate(primes.begin(), primes.end(), 0) == 639);
+        assert(primes.GetCapacity() == 32);
+    }
+#endif
+
+    // Те же операции во время выполнения, включая типы с кучей
+    {
+        StaticSimpleVector<std::string, 6> v(2, "x");
+        v.PushBack("tail");
+        v.Insert(v.begin(), "head");
+        v.Insert(v.begin() + 2, v[0]);
+        assert(v.GetSize() == 5 && v[0] == "head" && v[2] == "head" && v[4] == "tail");
+        const std::string more[] = {"m1", "m2"};
+        try {
+            v.Insert(v.begin(), std::begin(more), std::end(more));
+            assert(false);
+        } catch (const std::length_error&) {
+        }
+        assert(v.GetSize() == 5 && v[0] == "head" && v[4] == "tail");
+        v.Erase(v.begin() + 1, v.begin() + 3);
+        assert(v.GetSize() == 3 && v[1] == "x");
+        try {
+            v.At(3);
+            assert(false);
+        } catch (const std::out_of_range&) {
+        }
+
+        StaticSimpleVector<std::string, 6> copy = v;
+        assert(copy == v);
+        copy.Resize(6);
+        assert(copy > v && copy[5].empty());
+        try {
+            copy.PushBack("overflow");
+            assert(false);
+        } catch (const std::length_error&) {
+        }
+        StaticSimpleVector<std::string, 6> moved = std::move(copy);
+        assert(moved.GetSize() == 6 && moved[0] == "head");
+        moved = v;
+        v.Clear();
+        v.swap(moved);
+        assert(v.GetSize() == 3 && moved.IsEmpty());
+    }
+
+    // Элементы без конструктора по умолчанию не утекают
+    {
+        {
+            StaticSimpleVector<CountedItem, 4> v;
+            v.EmplaceBack(1);
+            v.EmplaceBack(2);
+            v.Insert(v.begin(), CountedItem(0));
+            auto copy = v;
+            assert(CountedItem::alive == 6 && copy[0].value == 0 && copy[2].value == 2);
+            v.Erase(v.begin());
+            assert(CountedItem::alive == 5 && v[0].value == 1);
+        }
+        assert(CountedItem::alive == 0);
+    }
+}
+
+// Сумма элементов вида: функции принимают участок любого непрерывного контейнера
+inline int SumView(SimpleVectorView<const int> view) {
+    return std::accumulate(view.begin(), view.end(), 0);
+}
+
+inline void Test23() {
+    // Slice отдаёт участок без копирования
+    {
+        SimpleVector<int> v(10);
+        std::iota(v.begin(), v.end(), 0);
+        SimpleVectorView<int> middle = v.Slice(2, 5);
+        assert(middle.GetSize() == 5 && middle.Data() == v.Data() + 2 && middle[0] == 2);
+        middle[1] = 30;
+        assert(v[3] == 30);
+        assert(middle.Slice(1, 2)[1] == 4 && middle.Slice(4).GetSize() == 1 && middle.Slice(5).IsEmpty());
+        try {
+            (void)v.Slice(8, 3);
+            assert(false);
+        } catch (const std::out_of_range&) {
+        }
+        try {
+            (void)middle.Slice(6);
+            assert(false);
+        } catch (const std::out_of_range&) {
+        }
+        try {
+            middle.At(5);
+            assert(false);
+        } catch (const std::out_of_range&) {
+        }
+
+        // Алгоритмы работают над видом как над массивом
+        std::sort(middle.begin(), middle.end(), std::greater<>{});
+        assert(v[2] == 30 && v[3] == 6 && v[6] == 2 && v[7] == 7);
+        assert(*middle.MaxElement() == 30 && middle.Find(5) == v.Data() + 4 && middle.Count(7) == 0);
+        assert(SumView(v) == 45 - 3 + 30 && SumView(middle) == 30 + 6 + 5 + 4 + 2);
+
+        const SimpleVector<int>& cv = v;
+        SimpleVectorView<const int> whole = cv.Slice(0, cv.GetSize());
+        SimpleVectorView deduced(cv);
+        static_assert(std::is_same_v<decltype(deduced), SimpleVectorView<const int>>);
+        assert(whole == deduced && whole.GetSize() == 10);
+    }
+
+    // Сравнения между видами и с контейнерами
+    {
+        SimpleVector<int> a = {1, 2, 3, 4};
+        SimpleVector<int> b = {1, 2, 4};
+        assert(a.Slice(0, 2) == b.Slice(0, 2));
+        assert(a.Slice(0, 3) < b && b > a.Slice(0, 3) && a.Slice(0, 2) <= b);
+        assert(SimpleVectorView<int>(a) != b && SimpleVectorView<int>(a) >= a.Slice(0, 4));
+#if defined(__cpp_impl_three_way_comparison) && defined(__cpp_lib_three_way_comparison)
+        assert((a.Slice(1, 2) <=> b.Slice(1, 2)) < 0);
+#endif
+        StaticSimpleVector<int, 4> fixed = {2, 3};
+        assert(SimpleVectorView<int>(fixed) == a.Slice(1, 2));
+
+        SimpleVector<std::string> words = {"b", "a", "c"};
+        auto view = words.Slice(0, 2);
+        std::sort(view.begin(), view.end());
+        assert(words[0] == "a" && view.Find("b") == words.Data() + 1);
+    }
+
+#if defined(__cpp_lib_span)
+    // Вид переходит в std::span и обратно
+    {
+        SimpleVector<double> v(4, 1.5);
+        std::span<double> span = v.Slice(1, 2);
+        assert(span.size() == 2 && span.data() == v.Data() + 1);
+        SimpleVectorView<double> back = span;
+        assert(back.Data() == v.Data() + 1 && back.GetSize() == 2);
+        std::span<const double> read_only = SimpleVectorView<const double>(back);
+        assert(read_only[0] == 1.5);
+    }
+#endif
+
+    // Release и Adopt передают буфер без копирования
+    {
+        SimpleVector<std::string> v = {"one", "two", "three"};
+        v.Reserve(8);
+        const std::string* data = v.Data();
+        SimpleVectorBuffer<std::string> buffer = v.Release();
+        assert(v.IsEmpty() && v.GetCapacity() == 0 && v.Data() == nullptr);
+        assert(buffer.data == data && buffer.size == 3 && buffer.capacity == 8);
+
+        SimpleVector<std::string> other = {"old"};
+        other.Adopt(buffer);
+        assert(other.Data() == data && other.GetSize() == 3 && other.GetCapacity() == 8 && other[2] == "three");
+        other.PushBack("four");
+        assert(other.Data() == data && other[3] == "four");
+
+        // Буфер из внешнего кода, выделенный тем же аллокатором
+        std::allocator<int> alloc;
+        int* raw = alloc.allocate(4);
+        raw[0] = 7;
+        raw[1] = 8;
+        SimpleVector<int> adopted;
+        adopted.Adopt(raw, 2, 4);
+        adopted.PushBack(9);
+        assert(adopted.GetSize() == 3 && adopted.Data() == raw && adopted[2] == 9);
+
+        // Отданный буфер освобождает новый владелец
+        SimpleVectorBuffer<std::string> released = other.Release();
+        std::destroy(released.data, released.data + released.size);
+        std::allocator<std::string>().deallocate(released.data, released.capacity);
+    }
+
+    // Забранный буфер учитывается в статистике как выделенный вектором
+    {
+        SimpleVectorStats own;
+        SimpleVector<StatsItem, std::allocator<StatsItem>, AutoShrinkGrowth<>> v(100);
+        v.SetStats(own);
+        StatsItem* raw = std::allocator<StatsItem>().allocate(40);
+        std::uninitialized_value_construct_n(raw, 3);
+        v.Adopt(raw, 3, 40);
+        const auto snapshot = own.GetSnapshot();
+        assert(snapshot.allocations == 1 && snapshot.reallocations == 1 && snapshot.peak_capacity == 40);
+        assert(v.Data() == raw && v.GetSize() == 3 && v.GetCapacity() == 40);
+    }
+}
+
+#if SIMPLE_VECTOR_HAS_CONSTEXPR
+static_assert([] {
+    SimpleVector<int> v = {5, 6, 7, 8};
+    auto view = v.Slice(1, 2);
+    return view[0] == 6 && view.GetSize() == 2 && view == SimpleVector<int>{6, 7}.Slice(0, 2);
+}());
+#endif
+
+inline void Test24() {
+    // Множество строится сортировкой с удалением повторов
+    {
+        FlatSet<int> set = {5, 1, 4, 1, 5, 9, 2, 6};
+        assert(set.GetSize() == 6 && std::is_sorted(set.begin(), set.end()));
+        assert(set.Contains(9) && !set.Contains(3) && set.Count(4) == 1 && set.Find(7) == set.end());
+        assert(*set.LowerBound(3) == 4 && *set.UpperBound(5) == 6 && set.LowerBound(10) == set.end());
+        assert(set.Insert(3).second && !set.Insert(3).second && *set.Insert(0).first == 0);
+        set.InsertMany({8, 3, 7, 7, 100, -5});
+        const std::vector<int> expected = {-5, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 100};
+        assert(std::equal(set.begin(), set.end(), expected.begin(), expected.end()));
+        assert(set.Erase(100) == 1 && set.Erase(100) == 0);
+        assert(*set.Erase(set.Find(0)) == 1 && set.GetSize() == 10);
+
+        FlatSet<int, std::greater<int>> descending = {1, 3, 2};
+        assert(descending.Keys()[0] == 3 && *descending.LowerBound(2) == 2);
+
+        SimpleVector<std::string> words = {"pear", "apple", "pear", "fig"};
+        FlatSet<std::string> from_vector(std::move(words));
+        assert(from_vector.GetSize() == 3 && *from_vector.begin() == "apple");
+        assert(from_vector == FlatSet<std::string>({"fig", "apple", "pear"}));
+    }
+
+    // Поиск без ветвлений совпадает со std::lower_bound на всех позициях
+    {
+        for (size_t size = 0; size < 70; ++size) {
+            SimpleVector<int> keys(size);
+            for (size_t i = 0; i < size; ++i) {
+                keys[i] = static_cast<int>(i) * 2;
+            }
+            for (int key = -1; key <= static_cast<int>(size) * 2 + 1; ++key) {
+                const int* expected = std::lower_bound(keys.Data(), keys.Data() + keys.GetSize(), key);
+                assert(flat_detail::LowerBound(keys.Data(), size, key, std::less<>{}) == expected);
+            }
+        }
+    }
+
+    // Отображение хранит ключи и значения в отдельных массивах
+    {
+        FlatMap<std::string, int> map = {{"b", 2}, {"a", 1}, {"c", 3}, {"a", 100}};
+        assert(map.GetSize() == 3 && map.At("a") == 1 && map.Keys()[2] == "c" && map.Values()[1] == 2);
+        try {
+            map.At("z");
+            assert(false);
+        } catch (const std::out_of_range&) {
+        }
+        map["d"] = 4;
+        ++map["a"];
+        assert(map.At("a") == 2 && map.At("d") == 4 && map.GetSize() == 4);
+        auto [it, inserted] = map.Insert("b", 20);
+        assert(!inserted && it.GetValue() == 2 && (*it).first == "b");
+
+        map.InsertMany({{"e", 5}, {"b", 200}, {"0", 0}, {"e", 50}});
+        std::string keys;
+        int sum = 0;
+        for (auto [key, value] : map) {
+            keys += key;
+            sum += value;
+        }
+        assert(keys == "0abcde" && sum == 0 + 2 + 2 + 3 + 4 + 5);
+
+        for (auto [key, value] : map) {
+            value *= 10;
+        }
+        assert(map.At("e") == 50);
+        const auto& cmap = map;
+        assert(cmap.Find("c").GetValue() == 30 && cmap.Find("x") == cmap.end() && cmap.Contains("0"));
+        assert(map.Erase("0") == 1 && map.Erase("0") == 0);
+        auto next = map.Erase(map.Find("b"));
+        assert(next.GetKey() == "c" && map.GetSize() == 4);
+        assert(std::is_sorted(map.Keys().begin(), map.Keys().end()));
+
+        FlatMap<std::string, int> copy = map;
+        assert(copy == map);
+        copy["a"] = -1;
+        assert(copy != map);
+    }
+
+    // Большая таблица совпадает со std::map
+    {
+        std::map<int, int> reference;
+        FlatMap<int, int> flat;
+        SimpleVector<std::pair<int, int>> batch;
+        std::uint32_t seed = 7;
+        for (int round = 0; round < 20; ++round) {
+            batch.Clear();
+            for (int i = 0; i < 500; ++i) {
+                seed = seed * 1664525u + 1013904223u;
+                const int key = static_cast<int>(seed >> 20);
+                batch.PushBack({key, round});
+                reference.emplace(key, round);
+            }
+            flat.InsertMany(batch.begin(), batch.end());
+        }
+        assert(flat.GetSize() == reference.size());
+        assert(std::equal(reference.begin(), reference.end(), flat.begin(), flat.end(),
+            [](const auto& lhs, const auto& rhs) { return lhs.first == rhs.first && lhs.second == rhs.second; }));
+    }
+}
+
+inline void Test25() {
+    // Флаги упакованы по 64 в слово, элемент - прокси-ссылка на бит
+    {
+        BitSimpleVector<> bits = {true, false, true, true};
+        assert(bits.GetSize() == 4 && bits.GetWordCount() == 1 && bits.WordData()[0] == 0b1101);
+        bits[1] = true;
+        bits[0] = bits[2] = false;
+        bits.Flip(3);
+        assert(!bits[0] && bits[1] && !bits[2] && !bits[3] && bits.Count() == 1);
+        try {
+            bits.At(4);
+            assert(false);
+        } catch (const std::out_of_range&) {
+        }
+
+        for (auto bit : bits) {
+            bit = !bit;
+        }
+        assert(bits.Count() == 3 && !bits[1]);
+        assert(std::count(bits.cbegin(), bits.cend(), true) == 3);
+
+        for (int i = 0; i < 200; ++i) {
+            bits.PushBack(i % 3 == 0);
+        }
+        assert(bits.GetSize() == 204 && bits.GetWordCount() == 4 && bits.GetCapacity() >= 204);
+        while (bits.GetSize() > 64) {
+            bits.PopBack();
+        }
+        assert(bits.GetWordCount() == 1 && bits.Count() == 3 + 20);
+
+        // Resize заполняет новые флаги, а хвост последнего слова остаётся нулевым
+        bits.Resize(130, true);
+        assert(bits.Count() == 23 + 66 && bits.WordData()[2] == 0b11);
+        bits.Resize(65);
+        assert(bits.Count() == 23 + 1 && bits.WordData()[1] == 1);
+        bits.Fill(true);
+        assert(bits.Count() == 65);
+        bits.Clear();
+        assert(bits.IsEmpty() && bits.FindFirst() == 0);
+
+        BitSimpleVector<> filled(100, true);
+        assert(filled.Count() == 100 && filled == BitSimpleVector<>(100, true) && filled != BitSimpleVector<>(100));
+    }
+
+    // Поиск установленных флагов
+    {
+        BitSimpleVector<> bits(1000);
+        const std::vector<size_t> positions = {0, 63, 64, 65, 127, 500, 999};
+        for (size_t pos : positions) {
+            bits.Set(pos);
+        }
+        std::vector<size_t> found;
+        for (size_t i = bits.FindFirst(); i < bits.GetSize(); i = bits.FindNext(i + 1)) {
+            found.push_back(i);
+        }
+        assert(found == positions);
+        assert(bits.FindNext(128) == 500 && bits.FindNext(1000) == 1000);
+        bits.Reset(999);
+        assert(bits.FindNext(501) == 1000);
+    }
+
+    // Поразрядные операции на всех наборах инструкций совпадают с std::vector<bool>
+    {
+        const SimdLevel best = GetSimdLevel();
+        for (SimdLevel level : {SimdLevel::kScalar, SimdLevel::kSse42, SimdLevel::kAvx2}) {
+            SetSimdLevel(level);
+            std::uint32_t seed = 11;
+            for (size_t size : {0, 1, 63, 64, 65, 200, 1000, 4099}) {
+                std::vector<bool> ref_a(size), ref_b(size);
+                BitSimpleVector<> a(size), b(size);
+                for (size_t i = 0; i < size; ++i) {
+                    seed = seed * 1664525u + 1013904223u;
+                    ref_a[i] = (seed >> 28) & 1;
+                    ref_b[i] = (seed >> 29) & 1;
+                    a[i] = ref_a[i];
+                    b[i] = ref_b[i];
+                }
+                auto expect = [&](const BitSimpleVector<>& bits, auto op) {
+                    size_t count = 0;
+                    for (size_t i = 0; i < size; ++i) {
+                        const bool value = op(ref_a[i], ref_b[i]);
+                        assert(bits[i] == value);
+                        count += value;
+                    }
+                    assert(bits.Count() == count);
+                };
+                expect(a, [](bool x, bool) { return x; });
+                expect(a & b, [](bool x, bool y) { return x && y; });
+                expect(a | b, [](bool x, bool y) { return x || y; });
+                expect(a ^ b, [](bool x, bool y) { return x != y; });
+                BitSimpleVector<> rest = a;
+                rest.AndNot(b);
+                expect(rest, [](bool x, bool y) { return x && !y; });
+            }
+        }
+        SetSimdLevel(best);
+
+        BitSimpleVector<> small(10), large(11);
+        try {
+            small |= large;
+            assert(false);
+        } catch (const std::invalid_argument&) {
+        }
+    }
+}
+
+inline void Test26() {
+    // Правки у разрыва не переносят элементы, а разрыв переезжает к месту правки
+    {
+        GapSimpleVector<int> gap = {1, 2, 3};
+        assert(gap.GetSize() == 3 && gap.GetGapPosition() == 3);
+        gap.Insert(1, 10);
+        assert(gap.GetGapPosition() == 2 && gap.GetCapacity() >= 4);
+        gap.Insert(2, 20);
+        gap.PushFront(0);
+        gap.PushBack(4);
+        const std::vector<int> expected = {0, 1, 10, 20, 2, 3, 4};
+        assert(std::equal(gap.begin(), gap.end(), expected.begin(), expected.end()));
+        assert(gap.At(6) == 4 && gap[2] == 10);
+        try {
+            gap.At(7);
+            assert(false);
+        } catch (const std::out_of_range&) {
+        }
+
+        gap.Erase(2, 4);
+        gap.PopFront();
+        gap.PopBack();
+        assert((gap == GapSimpleVector<int>{1, 2, 3}) && gap.GetGapPosition() == 3);
+
+        // Вставка своего же элемента копирует его до переноса разрыва
+        gap.MoveGap(0);
+        gap.Insert(0, gap[2]);
+        gap.Insert(2, gap[0]);
+        assert((gap == GapSimpleVector<int>{3, 1, 3, 2, 3}));
+
+        size_t chunks = 0;
+        int sum = 0;
+        gap.ForEachBlock([&](const int* data, size_t count) {
+            ++chunks;
+            sum = std::accumulate(data, data + count, sum);
+        });
+        assert(chunks == 2 && sum == 12);
+
+        std::sort(gap.begin(), gap.end());
+        assert((gap == GapSimpleVector<int>{1, 2, 3, 3, 3}));
+        assert((GapSimpleVector<int>{1, 2} < gap) && (gap < GapSimpleVector<int>{1, 3}) && (gap <= gap));
+#if defined(__cpp_impl_three_way_comparison) && defined(__cpp_lib_three_way_comparison)
+        assert((gap <=> GapSimpleVector<int>{1, 2, 3, 3, 3}) == 0);
+#endif
+
+        GapSimpleVector<int> copy = gap;
+        copy.MoveGap(1);
+        assert(copy == gap && copy.GetCapacity() >= copy.GetSize());
+        gap.Clear();
+        assert(gap.IsEmpty() && gap.GetCapacity() != 0 && copy.GetSize() == 5);
+    }
+
+    // Случайные правки вокруг блуждающего курсора совпадают со std::vector
+    {
+        std::vector<std::string> reference;
+        GapSimpleVector<std::string> gap;
+        std::uint32_t seed = 3;
+        size_t cursor = 0;
+        for (int step = 0; step < 3000; ++step) {
+            seed = seed * 1664525u + 1013904223u;
+            const size_t jump = (seed >> 8) % 7;
+            cursor = (seed >> 20) % 2 == 0 ? std::min(cursor + jump, reference.size()) : cursor - std::min(cursor, jump);
+            if ((seed >> 24) % 3 != 0 || reference.empty()) {
+                const std::string text(1 + (seed >> 16) % 40, static_cast<char>('a' + step % 26));
+                reference.insert(reference.begin() + static_cast<std::ptrdiff_t>(cursor), text);
+                gap.Insert(cursor, text);
+            } else {
+                cursor = std::min(cursor, reference.size() - 1);
+                reference.erase(reference.begin() + static_cast<std::ptrdiff_t>(cursor));
+                gap.Erase(cursor);
+            }
+        }
+        assert(std::equal(reference.begin(), reference.end(), gap.begin(), gap.end()));
+        GapSimpleVector<std::string> moved = std::move(gap);
+        assert(gap.IsEmpty() && moved.GetSize() == reference.size());
+    }
+
+    // Присваивание между разными ресурсами переносит элементы, а не аллокатор
+    {
+        using PmrGap = GapSimpleVector<std::pmr::string, std::pmr::polymorphic_allocator<std::pmr::string>>;
+        std::pmr::monotonic_buffer_resource arena1;
+        std::pmr::monotonic_buffer_resource arena2;
+        PmrGap source({"one", "two", "a rather long string that does not fit into SSO", "four"}, &arena1);
+        source.MoveGap(1);
+        source.Insert(1, "inserted");
+        PmrGap target({"old"}, &arena2);
+        target = source;
+        assert(target == source && target.GetAllocator().resource() == &arena2);
+        assert(target[3].get_allocator().resource() == &arena2);
+
+        PmrGap moved(&arena2);
+        moved = std::move(source);
+        assert(moved == target && moved.GetAllocator().resource() == &arena2);
+        assert(moved[1] == "inserted" && moved[1].get_allocator().resource() == &arena2);
+
+        // При равных ресурсах буфер забирается целиком, а опустевший остаётся разрывом
+        const std::pmr::string* element = &moved[4];
+        target = std::move(moved);
+        assert(&target[4] == element && moved.IsEmpty());
+        moved.Insert(0, "again");
+        assert(moved.GetSize() == 1 && moved[0] == "again");
+        static_assert(!std::is_nothrow_move_assignable_v<PmrGap>);
+        static_assert(std::is_nothrow_move_assignable_v<GapSimpleVector<int>>);
+    }
+}
+
+inline void Test27() {
+    // Возрастающие идентификаторы, произвольные значения и ширины от 0 до 64 битов
+    {
+        std::vector<std::uint64_t> values;
+        std::uint64_t id = 1'000'000;
+        for (int i = 0; i < 1000; ++i) {
+            values.push_back(id += 1 + i % 5);
+        }
+        for (int i = 0; i < 128; ++i) {
+            values.push_back(42);
+        }
+        std::uint64_t seed = 5;
+        for (unsigned width = 0; width <= 64; ++width) {
+            for (int i = 0; i < 128; ++i) {
+                seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+                values.push_back(width == 64 ? seed : seed & ((std::uint64_t{1} << width) - 1));
+            }
+        }
+        for (int i = 0; i < 300; ++i) {
+            values.push_back(~std::uint64_t{0} - 300 + i);
+        }
+        values.push_back(7);
+
+        PackedIntVector packed(values.begin(), values.end());
+        assert(packed.GetSize() == values.size());
+        for (size_t i = 0; i < values.size(); ++i) {
+            assert(packed[i] == values[i]);
+        }
+        assert(std::equal(packed.begin(), packed.end(), values.begin(), values.end()));
+
+        const SimdLevel best = GetSimdLevel();
+        for (SimdLevel level : {SimdLevel::kScalar, SimdLevel::kAvx2}) {
+            SetSimdLevel(level);
+            std::vector<std::uint64_t> decoded;
+            packed.ForEachBlock([&](const std::uint64_t* data, size_t count) {
+                decoded.insert(decoded.end(), data, data + count);
+            });
+            assert(decoded == values);
+        }
+        SetSimdLevel(best);
+
+        try {
+            packed.At(values.size());
+            assert(false);
+        } catch (const std::out_of_range&) {
+        }
+
+        PackedIntVector copy = packed;
+        assert(copy == packed);
+        copy.PushBack(8);
+        assert(copy != packed && copy[values.size()] == 8);
+        packed.Clear();
+        assert(packed.IsEmpty() && (packed == PackedIntVector{}));
+    }
+
+    // Плотные отсортированные идентификаторы занимают несколько битов на значение
+    {
+        PackedIntVector ids;
+        std::uint64_t id = 0;
+        std::uint32_t seed = 9;
+        for (int i = 0; i < 100'000; ++i) {
+            seed = seed * 1664525u + 1013904223u;
+            ids.PushBack(id += 1 + (seed >> 28));
+        }
+        ids.ShrinkToFit();
+        assert(ids.GetMemoryUsage() * 8 < ids.GetSize() * sizeof(std::uint64_t));
+        assert(ids[99'999] == id && (PackedIntVector{1, 2, 3}[1] == 2));
+
+        // Чтение по индексу в любом порядке и итераторы, прыгающие между блоками
+        std::vector<std::uint64_t> expected(ids.begin(), ids.end());
+        assert(expected.size() == ids.GetSize() && expected.back() == id);
+        for (size_t i = expected.size(); i-- > 0;) {
+            assert(ids[i] == expected[i]);
+        }
+        auto it = ids.begin() + 1000;
+        assert(*it == expected[1000] && it[-1] == expected[999]);
+        it -= 900;
+        assert(*it == expected[100]);
+        auto copy = it;
+        copy += 50'000;
+        assert(*copy == expected[50'100] && *it == expected[100] && copy - it == 50'000);
+        it = copy;
+        assert(*--it == expected[50'099] && *(ids.end() - 1) == id);
+    }
+}
+
+inline void Test28() {
+    // Data() - всегда сырой указатель, а итераторы становятся классом только в режиме CHECKED
+    static_assert(std::is_pointer_v<SimpleVector<int>::Iterator> == !SIMPLE_VECTOR_HAS_CHECKED_ITERATORS);
+    static_assert(std::is_convertible_v<SimpleVector<int>::Iterator, SimpleVector<int>::ConstIterator>);
+    {
+        SimpleVector<int> v{5, 3, 1};
+        v.Reserve(8);
+        const int* data = v.Data();
+        assert(&*v.begin() == data && &*(v.cend() - 1) == data + 2);
+        std::sort(v.begin(), v.end());
+        assert((v == SimpleVector<int>{1, 3, 5}));
+        SimpleVector<int>::ConstIterator it = v.Insert(v.begin() + 1, 2);
+        assert(*it == 2 && v.Data() == data);
+        it = v.Erase(it, it + 2);
+        assert(*it == 5 && v.GetSize() == 2 && std::as_const(v).Find(5) == it);
+    }
+
+#if SIMPLE_VECTOR_HAS_CHECKED_ITERATORS
+    // Рост в пределах вместимости не трогает итераторы, смена буфера делает их недействительными
+    {
+        SimpleVector<int> v(Reserve(4));
+        v.PushBack(1);
+        const auto first = v.begin();
+        const std::uint64_t generation = v.GetGeneration();
+        v.PushBack(2);
+        v.PopBack();
+        assert(v.GetGeneration() == generation && *first == 1);
+        v.Reserve(100);
+        assert(v.GetGeneration() != generation && *v.begin() == 1);
+
+        SimpleVector<int> other{7};
+        const std::uint64_t before = other.GetGeneration();
+        v.swap(other);
+        assert(other.GetGeneration() != before && *v.begin() == 7);
+        SimpleVector<int> moved(std::move(v));
+        assert(*moved.begin() == 7 && moved.end() - moved.begin() == 1);
+        v = std::move(other);
+        assert(v.GetSize() == 1 && v[0] == 1);
+    }
+
+#if SIMPLE_VECTOR_ANNOTATE_ASAN
+    // Под ASan доступна ровно живая часть буфера
+    {
+        SimpleVector<std::string> v(Reserve(16));
+        const auto verify = [&v] {
+            return __sanitizer_verify_contiguous_container(v.Data(), v.Data() + v.GetSize(), v.Data() + v.GetCapacity()) != 0;
+        };
+        assert(verify());
+        v.Append({"a", "b", "c", "d"});
+        v.Insert(v.begin() + 1, 3, "x");
+        assert(verify());
+        v.Erase(v.begin(), v.begin() + 2);
+        v.PopBack();
+        v.Resize(9);
+        assert(verify() && v.GetSize() == 9);
+        v.ShrinkToFit();
+        v.Clear();
+        assert(verify());
+    }
+#else
+    // Освобождённые ячейки заполняются kPoisonByte
+    {
+        SimpleVector<std::uint32_t> v{1, 2, 3, 4};
+        v.PopBack();
+        v.Erase(v.begin());
+        std::uint32_t poison = 0;
+        std::memset(&poison, hardening_detail::kPoisonByte, sizeof(poison));
+        std::uint32_t freed[2];
+        std::memcpy(freed, v.Data() + v.GetSize(), sizeof(freed));
+        assert(v.GetSize() == 2 && freed[0] == poison && freed[1] == poison);
+    }
+#endif
+#endif
+}